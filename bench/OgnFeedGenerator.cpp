@@ -0,0 +1,435 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+// Generator of synthetic APRS-IS feeds for benchmarks and fuzzing.
+//
+// Writes sentences in the formats seen on the OGN servers: traffic reports
+// of FLARM devices, ICAO transponders (ADS-B) and OGN trackers, weather
+// reports, receiver beacons with position and status, and server comments.
+// Aircraft and receivers are simulated, so that positions, timestamps and
+// addresses repeat as they do in a real feed. The output depends on the
+// seed only.
+//
+// Usage: OgnFeedGenerator [-n lines] [-s seed] [-o file] [--flarm W] [--icao W]
+//                         [--tracker W] [--weather W] [--status W] [--comment W]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// Kinds of sentences, and their default weights
+enum Kind
+{
+    Flarm,
+    Icao,
+    Tracker,
+    Weather,
+    Status,
+    Comment,
+    KindCount
+};
+
+constexpr const char* KindNames[KindCount] = {"flarm", "icao", "tracker", "weather", "status", "comment"};
+constexpr double DefaultWeights[KindCount] = {55.0, 20.0, 5.0, 5.0, 10.0, 5.0};
+
+// Sentences per second of simulated time, about what aprs.glidernet.org sends in summer
+constexpr double SentencesPerSecond = 2000.0;
+
+constexpr double Pi = 3.14159265358979323846;
+
+struct Aircraft
+{
+    Kind kind = Flarm;
+    uint32_t id = 0;       // id word, as in "id0ADDE626"
+    double latitude = 0.0;
+    double longitude = 0.0;
+    double altitude = 0.0; // meters
+    double course = 0.0;   // degrees
+    double speed = 0.0;    // knots
+    double climb = 0.0;    // m/s
+    double last = 0.0;     // seconds of simulated time
+    std::string flightNumber;
+};
+
+struct Station
+{
+    std::string name;
+    double latitude = 0.0;
+    double longitude = 0.0;
+};
+
+class Generator
+{
+public:
+    Generator(uint64_t seed, const double* weights)
+        : m_random(seed)
+        , m_kinds(weights, weights + KindCount)
+    {
+        for (int i = 0; i < 300; ++i) {
+            m_receivers.push_back(makeStation(receiverName()));
+        }
+        for (int i = 0; i < 40; ++i) {
+            char name[16];
+            std::snprintf(name, sizeof(name), "FNT%06X", static_cast<unsigned int>(m_random() & 0xFFFFFF));
+            m_weatherStations.push_back(makeStation(name));
+        }
+        for (Kind const kind : {Flarm, Icao, Tracker}) {
+            auto const count = (kind == Flarm) ? 2000 : (kind == Icao ? 800 : 200);
+            for (int i = 0; i < count; ++i) {
+                m_aircraft[kind].push_back(makeAircraft(kind));
+            }
+        }
+    }
+
+    // Append one sentence, without newline
+    void sentence(double time, std::string& out)
+    {
+        auto const kind = static_cast<Kind>(m_kinds(m_random));
+        switch (kind) {
+        case Flarm:
+        case Icao:
+        case Tracker:
+            traffic(m_aircraft[kind], time, out);
+            break;
+        case Weather:
+            weather(time, out);
+            break;
+        case Status:
+            status(time, out);
+            break;
+        default:
+            comment(time, out);
+            break;
+        }
+    }
+
+private:
+    double uniform(double low, double high) { return std::uniform_real_distribution<double>(low, high)(m_random); }
+    std::size_t index(std::size_t count) { return std::uniform_int_distribution<std::size_t>(0, count - 1)(m_random); }
+
+    std::string receiverName()
+    {
+        static constexpr std::string_view Letters = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+        std::string name;
+        auto const length = 4 + index(6);
+        for (std::size_t i = 0; i < length; ++i) {
+            name += Letters[i == 0 ? index(26) : index(Letters.size())];
+        }
+        return name;
+    }
+
+    // Somewhere in central Europe, where most receivers are
+    Station makeStation(std::string name)
+    {
+        Station station;
+        station.name = std::move(name);
+        station.latitude = uniform(43.0, 55.0);
+        station.longitude = uniform(-2.0, 20.0);
+        return station;
+    }
+
+    Aircraft makeAircraft(Kind kind)
+    {
+        static constexpr uint32_t FlarmCategories[] = {0x1, 0x1, 0x1, 0x2, 0x3, 0x6, 0x7, 0x8};
+        Aircraft aircraft;
+        aircraft.kind = kind;
+        const Station& home = m_receivers[index(m_receivers.size())];
+        aircraft.latitude = home.latitude + uniform(-0.3, 0.3);
+        aircraft.longitude = home.longitude + uniform(-0.5, 0.5);
+        aircraft.course = uniform(0.0, 360.0);
+        uint32_t category = 0;
+        uint32_t addressType = 0;
+        switch (kind) {
+        case Icao:
+            category = 0x9;
+            addressType = 1;
+            aircraft.altitude = uniform(3000.0, 12000.0);
+            aircraft.speed = uniform(250.0, 480.0);
+            if (index(3) != 0) {
+                static constexpr std::string_view Airlines[] = {"DLH", "RYR", "EZY", "AFR", "SWR", "KLM", "BAW", "AUA"};
+                aircraft.flightNumber = std::string(Airlines[index(8)]) + std::to_string(1 + index(9999));
+            }
+            break;
+        case Tracker:
+            category = FlarmCategories[index(8)];
+            addressType = 3;
+            aircraft.altitude = uniform(500.0, 3000.0);
+            aircraft.speed = uniform(15.0, 60.0);
+            break;
+        default:
+            category = FlarmCategories[index(8)];
+            addressType = 2;
+            aircraft.altitude = uniform(400.0, 3500.0);
+            aircraft.speed = uniform(0.0, 120.0);
+            break;
+        }
+        uint32_t flags = (category << 2) | addressType;
+        if (index(200) == 0) {
+            flags |= 0x40; // no tracking
+        }
+        aircraft.id = (flags << 24) | static_cast<uint32_t>(m_random() & 0xFFFFFF);
+        return aircraft;
+    }
+
+    // "hhmmss" of the simulated time, which starts at 08:00:00
+    static void appendTime(double time, std::string& out)
+    {
+        // Unsigned, so that the compiler sees the ranges of the fields
+        auto const seconds = static_cast<unsigned int>((static_cast<unsigned long>(std::max(time, 0.0)) + 8 * 3600) % 86400);
+        char text[8];
+        std::snprintf(text, sizeof(text), "%02u%02u%02u", seconds / 3600, (seconds / 60) % 60, seconds % 60);
+        out += text;
+    }
+
+    // "DDMM.MMN/DDDMM.MME" with symbol table, and the digits of the precision enhancement
+    static void appendPosition(double latitude, double longitude, char symbolTable, std::string& out, char enhancement[2])
+    {
+        // Thousandths of minutes, at most 180 degrees
+        auto const split = [](double value, unsigned int& degrees, unsigned int& thousandths) {
+            auto const total = static_cast<unsigned int>(std::lround(std::min(std::abs(value), 180.0) * 60000.0)) % (181 * 60000);
+            degrees = total / 60000;
+            thousandths = total % 60000;
+        };
+        unsigned int latDegrees = 0;
+        unsigned int latThousandths = 0;
+        unsigned int lonDegrees = 0;
+        unsigned int lonThousandths = 0;
+        split(latitude, latDegrees, latThousandths);
+        split(longitude, lonDegrees, lonThousandths);
+        char text[32];
+        std::snprintf(text, sizeof(text), "%02u%02u.%02u%c%c%03u%02u.%02u%c",
+                      latDegrees, latThousandths / 1000, (latThousandths / 10) % 100, latitude < 0 ? 'S' : 'N',
+                      symbolTable,
+                      lonDegrees, lonThousandths / 1000, (lonThousandths / 10) % 100, longitude < 0 ? 'W' : 'E');
+        out += text;
+        enhancement[0] = static_cast<char>('0' + latThousandths % 10);
+        enhancement[1] = static_cast<char>('0' + lonThousandths % 10);
+    }
+
+    void traffic(std::vector<Aircraft>& fleet, double time, std::string& out)
+    {
+        Aircraft& aircraft = fleet[index(fleet.size())];
+
+        // Move since the last report
+        double const elapsed = std::clamp(time - aircraft.last, 0.0, 60.0);
+        aircraft.last = time;
+        double const meters = aircraft.speed * 1852.0 / 3600.0 * elapsed;
+        double const course = aircraft.course * Pi / 180.0;
+        aircraft.latitude = std::clamp(aircraft.latitude + meters * std::cos(course) / 111195.0, -89.0, 89.0);
+        aircraft.longitude += meters * std::sin(course) / (111195.0 * std::cos(aircraft.latitude * Pi / 180.0));
+        aircraft.longitude = std::remainder(aircraft.longitude, 360.0);
+        aircraft.course = std::fmod(aircraft.course + uniform(-20.0, 20.0) + 360.0, 360.0);
+        aircraft.climb = std::clamp(aircraft.climb + uniform(-1.0, 1.0), -5.0, 5.0);
+        aircraft.altitude = std::max(0.0, aircraft.altitude + aircraft.climb * elapsed);
+
+        char text[256];
+        auto const address = aircraft.id & 0xFFFFFF;
+        switch (aircraft.kind) {
+        case Icao:
+            std::snprintf(text, sizeof(text), "ICA%06X>OGADSB,qAS,", address);
+            break;
+        case Tracker:
+            std::snprintf(text, sizeof(text), "OGN%06X>OGNTRK,qAS,", address);
+            break;
+        default:
+            std::snprintf(text, sizeof(text), "FLR%06X>OGFLR,qAS,", address);
+            break;
+        }
+        out += text;
+        out += m_receivers[index(m_receivers.size())].name;
+        out += ":/";
+        appendTime(time, out);
+        out += 'h';
+        char enhancement[2];
+        appendPosition(aircraft.latitude, aircraft.longitude, '/', out, enhancement);
+        out += aircraft.kind == Icao ? '^' : '\'';
+        std::snprintf(text, sizeof(text), "%03ld/%03ld/A=%06ld !W%c%c! id%08X %+04ldfpm",
+                      std::lround(aircraft.course) % 360, std::lround(aircraft.speed),
+                      std::lround(aircraft.altitude / 0.3048), enhancement[0], enhancement[1],
+                      aircraft.id, std::lround(aircraft.climb * 196.85));
+        out += text;
+        if (aircraft.kind == Icao) {
+            std::snprintf(text, sizeof(text), " FL%06.2f", aircraft.altitude / 0.3048 / 100.0);
+            out += text;
+            if (!aircraft.flightNumber.empty()) {
+                out += " A3:";
+                out += aircraft.flightNumber;
+            }
+            std::snprintf(text, sizeof(text), " Sq%04ld", 1000 + static_cast<long>(address % 6777));
+            out += text;
+        } else {
+            std::snprintf(text, sizeof(text), " %+.1frot %.1fdB %de %+.1fkHz",
+                          std::round(uniform(-3.0, 3.0) * 10.0) / 10.0, uniform(0.5, 30.0),
+                          static_cast<int>(index(6)), uniform(-10.0, 10.0));
+            out += text;
+            if (index(3) == 0) {
+                std::snprintf(text, sizeof(text), " gps:%dx%d", 1 + static_cast<int>(index(4)), 1 + static_cast<int>(index(5)));
+                out += text;
+            }
+        }
+    }
+
+    void weather(double time, std::string& out)
+    {
+        const Station& station = m_weatherStations[index(m_weatherStations.size())];
+        out += station.name;
+        out += ">OGNFNT,qAS,";
+        out += m_receivers[index(m_receivers.size())].name;
+        out += ":/";
+        appendTime(time, out);
+        out += 'h';
+        char enhancement[2];
+        appendPosition(station.latitude, station.longitude, '/', out, enhancement);
+        char text[96];
+        auto const wind = static_cast<long>(index(20));
+        std::snprintf(text, sizeof(text), "_%03ld/%03ldg%03ldt%03ldh%02ldb%05ld %.1fdB",
+                      static_cast<long>(index(360)), wind, wind + static_cast<long>(index(10)),
+                      static_cast<long>(35 + index(60)), static_cast<long>(index(100)),
+                      static_cast<long>(9900 + index(400)), uniform(0.5, 20.0));
+        out += text;
+    }
+
+    // Every receiver alternates between position beacon and status
+    void status(double time, std::string& out)
+    {
+        const Station& receiver = m_receivers[index(m_receivers.size())];
+        out += receiver.name;
+        out += ">OGNSDR,TCPIP*,qAC,GLIDERN";
+        out += static_cast<char>('1' + index(5));
+        out += ':';
+        char text[128];
+        if (index(2) == 0) {
+            out += '/';
+            appendTime(time, out);
+            out += 'h';
+            char enhancement[2];
+            appendPosition(receiver.latitude, receiver.longitude, 'I', out, enhancement);
+            std::snprintf(text, sizeof(text), "&/A=%06ld", static_cast<long>(index(6000)));
+            out += text;
+            return;
+        }
+        out += '>';
+        appendTime(time, out);
+        double const ramTotal = index(2) == 0 ? 889.7 : 3794.0;
+        std::snprintf(text, sizeof(text), "h v0.3.%d.arm64 CPU:%.1f RAM:%.1f/%.1fMB NTP:%.1fms/%+.1fppm %+.1fC",
+                      static_cast<int>(index(3)), uniform(0.1, 4.0), uniform(100.0, ramTotal), ramTotal,
+                      uniform(0.1, 5.0), uniform(-30.0, 30.0), uniform(30.0, 70.0));
+        out += text;
+    }
+
+    static void comment(double time, std::string& out)
+    {
+        auto const seconds = (static_cast<long>(time) + 8 * 3600) % 86400;
+        char text[128];
+        std::snprintf(text, sizeof(text), "# aprsc 2.1.14-g5e22b00 14 Oct 2026 %02ld:%02ld:%02ld GMT GLIDERN1 37.187.40.234:14580",
+                      seconds / 3600, (seconds / 60) % 60, seconds % 60);
+        out += text;
+    }
+
+    std::mt19937_64 m_random;
+    std::discrete_distribution<int> m_kinds;
+    std::vector<Station> m_receivers;
+    std::vector<Station> m_weatherStations;
+    std::vector<Aircraft> m_aircraft[Tracker + 1]; // by kind
+};
+
+void printUsage(const char* programName)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [-n lines] [-s seed] [-o file] [--flarm W] [--icao W] [--tracker W]\n"
+                 "       [--weather W] [--status W] [--comment W]\n"
+                 "\nWrites a synthetic APRS-IS feed of the given number of lines (default: 1000000)\n"
+                 "to the file, or to stdout. The weights W give the mix of sentence kinds\n"
+                 "(default: flarm 55, icao 20, tracker 5, weather 5, status 10, comment 5).\n",
+                 programName);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    long long lines = 1000000;
+    uint64_t seed = 1;
+    std::string fileName;
+    double weights[KindCount];
+    std::copy(DefaultWeights, DefaultWeights + KindCount, weights);
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view const argument(argv[i]);
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        char const* const value = argv[++i];
+        if (argument == "-n") {
+            lines = std::atoll(value);
+        } else if (argument == "-s") {
+            seed = std::strtoull(value, nullptr, 10);
+        } else if (argument == "-o") {
+            fileName = value;
+        } else {
+            auto const kind = std::find_if(std::begin(KindNames), std::end(KindNames), [argument](const char* name) {
+                return argument.size() > 2 && argument.substr(0, 2) == "--" && argument.substr(2) == name;
+            });
+            if (kind == std::end(KindNames)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            weights[kind - std::begin(KindNames)] = std::max(0.0, std::atof(value));
+        }
+    }
+    if (lines < 0 || std::all_of(weights, weights + KindCount, [](double weight) { return weight <= 0.0; })) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::FILE* const file = fileName.empty() ? stdout : std::fopen(fileName.c_str(), "wb");
+    if (file == nullptr) {
+        std::fprintf(stderr, "Cannot open %s\n", fileName.c_str());
+        return 1;
+    }
+
+    Generator generator(seed, weights);
+    std::string buffer;
+    buffer.reserve(1 << 20);
+    bool ok = true;
+    for (long long line = 0; line < lines && ok; ++line) {
+        generator.sentence(static_cast<double>(line) / SentencesPerSecond, buffer);
+        buffer += '\n';
+        if (buffer.size() >= (1 << 20) - 512 || line + 1 == lines) {
+            ok = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+            buffer.clear();
+        }
+    }
+    ok = (fileName.empty() ? std::fflush(file) : std::fclose(file)) == 0 && ok;
+    if (!ok) {
+        std::fprintf(stderr, "Error writing the feed\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,359 @@
+/***************************************************************************
+ *   Copyright (C) 2021-2025 by Stefan Kebekus                             *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+// Throughput benchmark of the OGN parser and the dumpOGN output formatters.
+//
+// Replays tests/received_data.txt, and optionally further capture files
+// given on the command line, through OgnParser::parseAprsisMessage, both
+// output formatters of dumpOGN, both of them fanned out from one message
+// range as in the dumpOGN pipeline, and OgnParser::formatPositionReport. For
+// every message type, the benchmark reports messages per second,
+// nanoseconds per message and heap allocations per message.
+//
+// Every stage runs for the given number of iterations, and with --min-time
+// for at least the given time. With --baseline, the messages per second in
+// the fastest iteration of every stage are compared to a file written
+// earlier with --write-baseline. The benchmark fails if any stage is slower
+// by more than the tolerance (default: 20 percent). If the baseline file
+// does not exist, the benchmark returns 77, which CTest reports as skipped.
+//
+// Usage: OgnParserBench [-n iterations] [--baseline FILE] [--write-baseline FILE]
+//                       [--tolerance PERCENT] [--min-time SECONDS] [capture file ...]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "OgnFormatter.h"
+#include "OgnParser.h"
+#include "OgnPreFilter.h"
+#include "OutputFormatter.h"
+#include "SBS1Formatter.h"
+
+using namespace Ogn;
+
+namespace {
+
+struct MessageType
+{
+    OgnMessageType type;
+    const char* name;
+};
+
+constexpr MessageType MessageTypes[] = {
+    {OgnMessageType::TRAFFIC_REPORT, "traffic"},
+    {OgnMessageType::WEATHER, "weather"},
+    {OgnMessageType::STATUS, "status"},
+    {OgnMessageType::COMMENT, "comment"},
+    {OgnMessageType::UNKNOWN, "unknown"},
+};
+
+// Messages per second of a stage, by type and stage name
+using Results = std::map<std::pair<std::string, std::string>, double>;
+
+// Results of all stages run so far
+Results results;
+
+// Returned if the baseline is missing
+constexpr int SkipReturnCode = 77;
+
+// Run every stage for at least this long
+double minimumSeconds = 0.0;
+
+// Lines "type<TAB>stage<TAB>messages per second", lines starting with '#' are comments
+bool readBaseline(const std::string& fileName, Results& baseline)
+{
+    std::ifstream file(fileName);
+    if (!file) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        auto const first = line.find('\t');
+        auto const second = line.find('\t', first + 1);
+        if (line.empty() || line[0] == '#' || second == std::string::npos) {
+            continue;
+        }
+        baseline[{line.substr(0, first), line.substr(first + 1, second - first - 1)}] = std::atof(line.c_str() + second + 1);
+    }
+    return true;
+}
+
+bool writeBaseline(const std::string& fileName)
+{
+    std::ofstream file(fileName);
+    file << "# Messages per second of OgnParserBench, see README.md\n";
+    for (auto const& [key, rate] : results) {
+        file << key.first << '\t' << key.second << '\t' << static_cast<long long>(rate) << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+bool readLines(const std::string& fileName, std::vector<std::string>& lines)
+{
+    std::ifstream file(fileName);
+    if (!file) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty()) {
+            lines.push_back(line);
+        }
+    }
+    return true;
+}
+
+// Run function once for every message, iterations times, and print one line of results
+template<typename Function>
+void run(const char* typeName, const char* stageName, std::size_t messageCount, int iterations, Function function)
+{
+    if (messageCount == 0) {
+        return;
+    }
+
+    // Warm up caches and buffers that are reused between messages
+    std::size_t checksum = 0;
+    for (std::size_t i = 0; i < messageCount; ++i) {
+        checksum += function(i);
+    }
+
+    // At least the given number of iterations, and at least minimumSeconds
+    std::size_t const allocationsBefore = AllocationCounter::allocations();
+    auto const start = std::chrono::steady_clock::now();
+    auto end = start;
+    double fastest = 0.0;
+    int iteration = 0;
+    while (iteration < iterations || std::chrono::duration<double>(end - start).count() < minimumSeconds) {
+        auto const iterationStart = end;
+        for (std::size_t i = 0; i < messageCount; ++i) {
+            checksum += function(i);
+        }
+        iteration++;
+        end = std::chrono::steady_clock::now();
+        double const seconds = std::chrono::duration<double>(end - iterationStart).count();
+        fastest = (iteration == 1) ? seconds : std::min(fastest, seconds);
+    }
+    iterations = iteration;
+    std::size_t const allocations = AllocationCounter::allocations() - allocationsBefore;
+
+    double const total = static_cast<double>(messageCount) * iterations;
+    double const seconds = std::chrono::duration<double>(end - start).count();
+    // The fastest iteration is least disturbed by other processes
+    results[{typeName, stageName}] = static_cast<double>(messageCount) / fastest;
+    std::printf("%-8s %-29s %8zu %14.0f %10.1f %12.2f   (checksum %zu)\n",
+                typeName,
+                stageName,
+                messageCount,
+                total / seconds,
+                seconds * 1e9 / total,
+                static_cast<double>(allocations) / total,
+                checksum);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int iterations = 200;
+    std::string baselineFileName;
+    std::string newBaselineFileName;
+    double tolerance = 20.0;
+    std::vector<std::string> fileNames;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view const argument(argv[i]);
+        if (argument == "-n" && i + 1 < argc) {
+            iterations = std::atoi(argv[++i]);
+        } else if (argument == "--baseline" && i + 1 < argc) {
+            baselineFileName = argv[++i];
+        } else if (argument == "--write-baseline" && i + 1 < argc) {
+            newBaselineFileName = argv[++i];
+        } else if (argument == "--tolerance" && i + 1 < argc) {
+            tolerance = std::atof(argv[++i]);
+        } else if (argument == "--min-time" && i + 1 < argc) {
+            minimumSeconds = std::atof(argv[++i]);
+        } else {
+            fileNames.emplace_back(argument);
+        }
+    }
+    if (iterations <= 0) {
+        std::fprintf(stderr, "Usage: %s [-n iterations] [--baseline FILE] [--write-baseline FILE] [--tolerance PERCENT] [--min-time SECONDS] [capture file ...]\n", argv[0]);
+        return 1;
+    }
+    Results baseline;
+    if (!baselineFileName.empty() && !readBaseline(baselineFileName, baseline)) {
+        std::fprintf(stderr, "Cannot open %s, measure it with --write-baseline\n", baselineFileName.c_str());
+        return SkipReturnCode;
+    }
+    fileNames.insert(fileNames.begin(), OGN_TEST_DATA_DIR "/received_data.txt");
+
+    std::vector<std::string> lines;
+    for (auto const& fileName : fileNames) {
+        if (!readLines(fileName, lines)) {
+            std::fprintf(stderr, "Cannot open %s\n", fileName.c_str());
+            return 1;
+        }
+    }
+    std::printf("%zu sentences from %zu file(s), %d iterations\n\n", lines.size(), fileNames.size(), iterations);
+    std::printf("%-8s %-29s %8s %14s %10s %12s\n", "type", "stage", "messages", "messages/s", "ns/message", "allocs/msg");
+
+    OgnFormatter ognFormatter;
+    SBS1Formatter sbs1Formatter;
+    OutputFormatter fanOut[] = {OgnFormatter(), SBS1Formatter()};
+
+    for (auto const& messageType : MessageTypes) {
+        // Sentences of this type
+        std::vector<std::string_view> sentences;
+        for (auto const& line : lines) {
+            OgnMessage message;
+            message.sentence = line;
+            OgnParser::parseAprsisMessage(message);
+            if (message.type == messageType.type) {
+                sentences.emplace_back(line);
+            }
+        }
+        if (sentences.empty()) {
+            continue;
+        }
+
+        if (messageType.type == OgnMessageType::TRAFFIC_REPORT) {
+            // What a consumer of positions only needs
+            uint32_t const positionFields = OgnField::TrafficReports | OgnField::Timestamp | OgnField::Position |
+                                            OgnField::Altitude | OgnField::AircraftID;
+            run(messageType.name, "parse (position mask)", sentences.size(), iterations, [&](std::size_t i) {
+                OgnMessageView view;
+                view.sentence = sentences[i];
+                OgnParser::parseAprsisMessage(view, positionFields);
+                return static_cast<std::size_t>(view.type);
+            });
+            // Rejected by the bounding box of a pre-filter, as when subsetting a wide server filter
+            OgnPreFilter preFilter;
+            preFilter.setBoundingBox(-90.0, -180.0, -89.0, 180.0);
+            run(messageType.name, "parse (pre-filter, rejected)", sentences.size(), iterations, [&](std::size_t i) {
+                OgnMessageView view;
+                view.sentence = sentences[i];
+                OgnParser::parseAprsisMessage(view, preFilter);
+                return static_cast<std::size_t>(view.type);
+            });
+        }
+
+        // Parsed messages, for the formatters
+        std::vector<OgnMessageView> messages(sentences.size());
+        for (std::size_t i = 0; i < sentences.size(); ++i) {
+            messages[i].sentence = sentences[i];
+            OgnParser::parseAprsisMessage(messages[i]);
+        }
+
+        // The message is reused, as a client would, and needs a reset before every parse
+        OgnMessage message;
+        run(messageType.name, "parseAprsisMessage", sentences.size(), iterations, [&](std::size_t i) {
+            message.reset();
+            message.sentence = sentences[i];
+            OgnParser::parseAprsisMessage(message);
+            return static_cast<std::size_t>(message.type);
+        });
+        // The formatters append to a reused buffer, as dumpOGN does
+        std::string output;
+        run(messageType.name, "OgnFormatter", messages.size(), iterations, [&](std::size_t i) {
+            output.clear();
+            ognFormatter.formatInto(output, messages[i]);
+            return output.size();
+        });
+        run(messageType.name, "SBS1Formatter", messages.size(), iterations, [&](std::size_t i) {
+            output.clear();
+            sbs1Formatter.formatInto(output, messages[i]);
+            return output.size();
+        });
+        // Blocks of messages, as the pipeline formats a chunk, to both formats
+        constexpr std::size_t fanOutBlock = 64;
+        std::string fanOutOutputs[2];
+        run(messageType.name, "fan-out (ogn, sbs1)", messages.size(), iterations, [&](std::size_t i) -> std::size_t {
+            if (i % fanOutBlock != 0) {
+                return 0;
+            }
+            std::size_t const count = std::min(fanOutBlock, messages.size() - i);
+            std::size_t size = 0;
+            for (std::size_t j = 0; j < 2; ++j) {
+                fanOutOutputs[j].clear();
+                formatMessages(fanOut[j], fanOutOutputs[j], &messages[i], count);
+                size += fanOutOutputs[j].size();
+            }
+            return size;
+        });
+        if (messageType.type == OgnMessageType::TRAFFIC_REPORT) {
+            run(messageType.name, "formatPositionReport", messages.size(), iterations, [&](std::size_t i) {
+                auto const& traffic = messages[i];
+                return OgnParser::formatPositionReport(traffic.sourceId,
+                                                       traffic.latitude,
+                                                       traffic.longitude,
+                                                       traffic.altitude,
+                                                       traffic.course,
+                                                       traffic.speed,
+                                                       traffic.aircraftType)
+                    .size();
+            });
+            char buffer[256];
+            run(messageType.name, "formatPositionReport (buffer)", messages.size(), iterations, [&](std::size_t i) {
+                auto const& traffic = messages[i];
+                return OgnParser::formatPositionReport(buffer,
+                                                       sizeof(buffer),
+                                                       traffic.sourceId,
+                                                       traffic.latitude,
+                                                       traffic.longitude,
+                                                       traffic.altitude,
+                                                       traffic.course,
+                                                       traffic.speed,
+                                                       traffic.aircraftType);
+            });
+        }
+    }
+
+    if (!newBaselineFileName.empty() && !writeBaseline(newBaselineFileName)) {
+        std::fprintf(stderr, "Cannot write %s\n", newBaselineFileName.c_str());
+        return 1;
+    }
+    if (baselineFileName.empty()) {
+        return 0;
+    }
+    int regressions = 0;
+    for (auto const& [key, rate] : results) {
+        auto const expected = baseline.find(key);
+        if (expected == baseline.end() || rate >= expected->second * (1.0 - tolerance / 100.0)) {
+            continue;
+        }
+        std::printf("Regression: %s %s, %.0f messages/s, baseline %.0f (%+.1f%%)\n", key.first.c_str(), key.second.c_str(),
+                    rate, expected->second, (rate / expected->second - 1.0) * 100.0);
+        regressions++;
+    }
+    std::printf("\n%d of %zu stages slower than the baseline by more than %.0f%%\n", regressions, results.size(), tolerance);
+    return regressions == 0 ? 0 : 1;
+}
@@ -0,0 +1,210 @@
+/***************************************************************************
+ *   Copyright (C) 2021-2025 by Stefan Kebekus                             *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+// Microbenchmark: tokenizing the OGN part of the sentences in
+// tests/received_data.txt with the tokenizer of the library, compared to
+// the item-by-item scan that OgnParser used before.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "OgnTokenizer.h"
+
+using namespace Ogn;
+
+namespace {
+
+bool starts_with(std::string_view str, std::string_view prefix)
+{
+    return str.size() >= prefix.size() && str.substr(0, prefix.size()) == prefix;
+}
+
+bool ends_with(std::string_view str, std::string_view suffix)
+{
+    return str.size() >= suffix.size() && str.substr(str.size() - suffix.size()) == suffix;
+}
+
+// Previous implementation: find the first blank, search for "!W", then walk
+// the items and test each against a chain of prefixes and suffixes
+Tokenizer::TokenKind legacyClassify(std::string_view item)
+{
+    using Tokenizer::TokenKind;
+    if (starts_with(item, "id")) {
+        return TokenKind::AircraftID;
+    }
+    if (starts_with(item, "t")) {
+        return TokenKind::Temperature;
+    }
+    if (starts_with(item, "h")) {
+        return TokenKind::Humidity;
+    }
+    if (starts_with(item, "b")) {
+        return TokenKind::Pressure;
+    }
+    if (ends_with(item, "fpm")) {
+        return TokenKind::VerticalSpeed;
+    }
+    if (ends_with(item, "rot")) {
+        return TokenKind::RotationRate;
+    }
+    if (ends_with(item, "dB")) {
+        return TokenKind::SignalStrength;
+    }
+    if (ends_with(item, "e")) {
+        return TokenKind::ErrorCount;
+    }
+    if (ends_with(item, "kHz")) {
+        return TokenKind::FrequencyOffset;
+    }
+    if (starts_with(item, "FL")) {
+        return TokenKind::FlightLevel;
+    }
+    if (starts_with(item, "A") && item.size() > 2 && item[2] == ':') {
+        return TokenKind::FlightNumber;
+    }
+    if (starts_with(item, "Sq")) {
+        return TokenKind::Squawk;
+    }
+    if (starts_with(item, "gps:")) {
+        return TokenKind::GpsInfo;
+    }
+    return TokenKind::Other;
+}
+
+uint64_t legacyTokenize(std::string_view body)
+{
+    uint64_t checksum = 0;
+    auto const precisionIndex = body.find("!W");
+    if (precisionIndex != std::string_view::npos) {
+        checksum += precisionIndex;
+    }
+    auto const blankIndex = body.find(' ');
+    if (blankIndex == std::string_view::npos) {
+        return checksum;
+    }
+    std::string_view const ognPart = body.substr(blankIndex + 1);
+    auto it = ognPart.begin();
+    while (it != ognPart.end()) {
+        while (it != ognPart.end() && *it == ' ') {
+            ++it;
+        }
+        if (it == ognPart.end()) {
+            break;
+        }
+        auto end = std::find(it, ognPart.end(), ' ');
+        std::string_view const item(it, end - it);
+        checksum += static_cast<uint64_t>(legacyClassify(item)) + item.size();
+        it = (end != ognPart.end()) ? end + 1 : ognPart.end();
+    }
+    return checksum;
+}
+
+uint64_t singlePassTokenize(std::string_view body)
+{
+    uint64_t checksum = 0;
+    bool first = true;
+    Tokenizer::forEachToken(body, [&](std::string_view token) {
+        if (first) {
+            first = false;
+            return;
+        }
+        auto const kind = Tokenizer::classifyToken(token);
+        if (kind == Tokenizer::TokenKind::Enhancement) {
+            checksum += static_cast<uint64_t>(token.data() - body.data());
+        } else {
+            checksum += static_cast<uint64_t>(kind) + token.size();
+        }
+    });
+    return checksum;
+}
+
+uint64_t scalarBlanks(std::string_view body)
+{
+    uint32_t positions[64];
+    return Tokenizer::findBlanksScalar(body, positions, 64);
+}
+
+uint64_t vectorBlanks(std::string_view body)
+{
+    uint32_t positions[64];
+    return Tokenizer::findBlanks(body, positions, 64);
+}
+
+template<typename Function>
+void run(const char* name, const std::vector<std::string_view>& bodies, int iterations, Function function)
+{
+    uint64_t checksum = 0;
+    auto const start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        for (auto const body : bodies) {
+            checksum += function(body);
+        }
+    }
+    auto const end = std::chrono::steady_clock::now();
+    double const nanoseconds = std::chrono::duration<double, std::nano>(end - start).count();
+    double const perSentence = nanoseconds / (static_cast<double>(bodies.size()) * iterations);
+    std::printf("%-24s %8.1f ns/sentence  (checksum %llu)\n", name, perSentence, static_cast<unsigned long long>(checksum));
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string const fileName = (argc > 1) ? argv[1] : OGN_TEST_DATA_DIR "/received_data.txt";
+    int const iterations = (argc > 2) ? std::stoi(argv[2]) : 2000;
+
+    std::ifstream file(fileName);
+    if (!file) {
+        std::fprintf(stderr, "Cannot open %s\n", fileName.c_str());
+        return 1;
+    }
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+
+    // Body of the sentence: everything after the first colon
+    std::vector<std::string_view> bodies;
+    for (auto const& sentence : lines) {
+        auto const colon = sentence.find(':');
+        if (colon != std::string::npos && colon + 1 < sentence.size() && sentence[colon + 1] == '/') {
+            bodies.emplace_back(std::string_view(sentence).substr(colon + 1));
+        }
+    }
+    if (bodies.empty()) {
+        std::fprintf(stderr, "No position reports in %s\n", fileName.c_str());
+        return 1;
+    }
+
+    std::printf("%zu position reports, %d iterations\n", bodies.size(), iterations);
+    run("legacy tokenizer", bodies, iterations, legacyTokenize);
+    run("single-pass tokenizer", bodies, iterations, singlePassTokenize);
+    run("scalar blank search", bodies, iterations, scalarBlanks);
+    run("vector blank search", bodies, iterations, vectorBlanks);
+    return 0;
+}
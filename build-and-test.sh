@@ -26,7 +26,7 @@ cd build
 
 # Configure with CMake (no Qt required)
 echo -e "${YELLOW}Configuring with CMake...${NC}"
-cmake .. -DCMAKE_BUILD_TYPE=Debug -DCMAKE_EXPORT_COMPILE_COMMANDS=ON -DCMAKE_CXX_FLAGS="-Werror"
+cmake .. -DCMAKE_BUILD_TYPE=Debug -DCMAKE_EXPORT_COMPILE_COMMANDS=ON -DCMAKE_CXX_FLAGS="-Werror" -DENROUTE_OGN_ALLOC_CHECK=ON
 
 # Build
 echo -e "${YELLOW}Building library and tests...${NC}"
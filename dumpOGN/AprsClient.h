@@ -0,0 +1,571 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+#include "LineReader.h"
+#include "OgnParser.h"
+
+/*! \brief Readiness notification for a small number of sockets
+ *
+ *  Uses epoll on Linux and poll() elsewhere.
+ */
+class EventPoller
+{
+public:
+    struct Event
+    {
+        std::size_t token = 0;
+        bool readable = false;
+        bool writable = false;
+    };
+
+    EventPoller()
+    {
+#if defined(__linux__)
+        m_epoll = epoll_create1(EPOLL_CLOEXEC);
+#endif
+    }
+
+    EventPoller(const EventPoller&) = delete;
+    EventPoller& operator=(const EventPoller&) = delete;
+
+    ~EventPoller()
+    {
+#if defined(__linux__)
+        if (m_epoll >= 0) {
+            ::close(m_epoll);
+        }
+#endif
+    }
+
+    //! Watch fd for readability, and for writability if wantWrite is set
+    bool add(int fd, std::size_t token, bool wantWrite)
+    {
+#if defined(__linux__)
+        epoll_event event = makeEvent(token, wantWrite);
+        return epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event) == 0;
+#else
+        pollfd entry{};
+        entry.fd = fd;
+        entry.events = static_cast<short>(POLLIN | (wantWrite ? POLLOUT : 0));
+        m_fds.push_back(entry);
+        m_tokens.push_back(token);
+        return true;
+#endif
+    }
+
+    bool modify(int fd, std::size_t token, bool wantWrite)
+    {
+#if defined(__linux__)
+        epoll_event event = makeEvent(token, wantWrite);
+        return epoll_ctl(m_epoll, EPOLL_CTL_MOD, fd, &event) == 0;
+#else
+        for (std::size_t i = 0; i < m_fds.size(); ++i) {
+            if (m_fds[i].fd == fd) {
+                m_fds[i].events = static_cast<short>(POLLIN | (wantWrite ? POLLOUT : 0));
+                m_tokens[i] = token;
+                return true;
+            }
+        }
+        return false;
+#endif
+    }
+
+    void remove(int fd)
+    {
+#if defined(__linux__)
+        epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+#else
+        for (std::size_t i = 0; i < m_fds.size(); ++i) {
+            if (m_fds[i].fd == fd) {
+                m_fds.erase(m_fds.begin() + static_cast<std::ptrdiff_t>(i));
+                m_tokens.erase(m_tokens.begin() + static_cast<std::ptrdiff_t>(i));
+                return;
+            }
+        }
+#endif
+    }
+
+    /*! \brief Wait for events
+     *
+     *  Errors and hang-ups are reported as readable, so that the next
+     *  read reports them.
+     *
+     *  \return Number of events, 0 on timeout or when interrupted by a signal
+     */
+    std::size_t wait(int timeoutMs, std::vector<Event>& events)
+    {
+        events.clear();
+#if defined(__linux__)
+        epoll_event ready[16];
+        int const count = epoll_wait(m_epoll, ready, 16, timeoutMs);
+        for (int i = 0; i < count; ++i) {
+            Event event;
+            event.token = static_cast<std::size_t>(ready[i].data.u64);
+            event.readable = (ready[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0;
+            event.writable = (ready[i].events & EPOLLOUT) != 0;
+            events.push_back(event);
+        }
+#else
+        int const count = poll(m_fds.data(), static_cast<nfds_t>(m_fds.size()), timeoutMs);
+        for (std::size_t i = 0; count > 0 && i < m_fds.size(); ++i) {
+            if (m_fds[i].revents == 0) {
+                continue;
+            }
+            Event event;
+            event.token = m_tokens[i];
+            event.readable = (m_fds[i].revents & (POLLIN | POLLERR | POLLHUP)) != 0;
+            event.writable = (m_fds[i].revents & POLLOUT) != 0;
+            events.push_back(event);
+        }
+#endif
+        return events.size();
+    }
+
+private:
+#if defined(__linux__)
+    static epoll_event makeEvent(std::size_t token, bool wantWrite)
+    {
+        epoll_event event{};
+        event.events = EPOLLIN | (wantWrite ? EPOLLOUT : 0U);
+        event.data.u64 = token;
+        return event;
+    }
+
+    int m_epoll = -1;
+#else
+    std::vector<pollfd> m_fds;
+    std::vector<std::size_t> m_tokens;
+#endif
+};
+
+/*! \brief APRS-IS client for several logins on one thread
+ *
+ *  Every connection has its own call sign and range filter. All sockets are
+ *  non-blocking and served by one event loop in run(), which hands complete
+ *  lines of all connections to a single callback. Connections that fail
+ *  or go silent are reopened with exponential backoff. Keepalive comments
+ *  are sent when nothing else was sent for a while.
+ *
+ *  Host names are resolved with getaddrinfo(), which blocks briefly.
+ */
+class AprsClient
+{
+public:
+    //! Receives complete lines, including their newlines, and the time they were received
+    using LinesCallback = std::function<void(std::string_view lines, std::chrono::steady_clock::time_point received)>;
+
+    AprsClient(std::string host, int port, std::string appName, std::string appVersion)
+        : m_host(std::move(host))
+        , m_port(std::to_string(port))
+        , m_appName(std::move(appName))
+        , m_appVersion(std::move(appVersion))
+        , m_random(std::random_device{}())
+    {
+    }
+
+    AprsClient(const AprsClient&) = delete;
+    AprsClient& operator=(const AprsClient&) = delete;
+
+    ~AprsClient()
+    {
+        for (auto& connection : m_connections) {
+            closeSocket(*connection);
+        }
+    }
+
+    /*! \brief Add a login, connected once run() is called
+     *
+     *  \return Index of the connection
+     */
+    std::size_t addConnection(std::string callSign, double latitude, double longitude, unsigned int radiusKm)
+    {
+        auto connection = std::make_unique<Connection>();
+        connection->callSign = std::move(callSign);
+        connection->latitude = latitude;
+        connection->longitude = longitude;
+        connection->radiusKm = radiusKm;
+        connection->index = m_connections.size();
+        m_connections.push_back(std::move(connection));
+        return m_connections.size() - 1;
+    }
+
+    /*! \brief Change the range filter of a connection
+     *
+     *  A logged-in connection is sent a filter command. Otherwise, the
+     *  filter is used with the next login.
+     */
+    void setFilter(std::size_t index, double latitude, double longitude, unsigned int radiusKm)
+    {
+        Connection& connection = *m_connections.at(index);
+        connection.latitude = latitude;
+        connection.longitude = longitude;
+        connection.radiusKm = radiusKm;
+        if (connection.state == State::Connected) {
+            send(connection, Ogn::OgnParser::formatFilterCommand(latitude, longitude, radiusKm));
+        }
+    }
+
+    //! Reopen connections that were closed (default: true)
+    void setReconnect(bool reconnect) { m_reconnect = reconnect; }
+
+    //! Make run() return; may be called from a signal handler
+    void stop() { m_stop.store(true, std::memory_order_relaxed); }
+
+    /*! \brief Serve all connections
+     *
+     *  \return When stop() was called, or when all connections are closed
+     *  and reconnecting is disabled
+     */
+    void run(const LinesCallback& callback)
+    {
+        auto const now = std::chrono::steady_clock::now();
+        for (auto& connection : m_connections) {
+            connection->nextAttempt = now;
+        }
+
+        std::vector<EventPoller::Event> events;
+        while (!m_stop.load(std::memory_order_relaxed)) {
+            if (!handleTimers()) {
+                return;
+            }
+            m_poller.wait(nextTimeout(), events);
+            for (const auto& event : events) {
+                Connection& connection = *m_connections[event.token];
+                if (connection.state == State::Connecting && (event.writable || event.readable)) {
+                    finishConnect(connection);
+                    continue;
+                }
+                if (event.writable) {
+                    flushPending(connection);
+                }
+                if (event.readable && connection.state == State::Connected) {
+                    receive(connection, callback);
+                }
+            }
+        }
+    }
+
+private:
+    enum class State
+    {
+        Waiting,    // for the next connection attempt
+        Connecting, // non-blocking connect in progress
+        Connected,  // logged in
+        Closed,     // not reconnecting
+    };
+
+    struct Connection
+    {
+        std::string callSign;
+        double latitude = 0.0;
+        double longitude = 0.0;
+        unsigned int radiusKm = 0;
+        std::size_t index = 0; // token for the poller
+
+        State state = State::Waiting;
+        int fd = -1;
+        LineReader reader;
+        std::string pending; // not yet sent
+        std::chrono::steady_clock::time_point nextAttempt;
+        std::chrono::steady_clock::time_point attemptStarted;
+        std::chrono::steady_clock::time_point connected;
+        std::chrono::steady_clock::time_point lastReceive;
+        std::chrono::steady_clock::time_point lastSend;
+        std::chrono::seconds backoff = MinimumBackoff;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::chrono::seconds MinimumBackoff{1};
+    static constexpr std::chrono::seconds MaximumBackoff{60};
+    // Reset the backoff after connections that stayed up this long
+    static constexpr std::chrono::seconds StableConnection{60};
+    static constexpr std::chrono::seconds ConnectTimeout{15};
+    // APRS-IS servers send a keepalive comment every 20 seconds
+    static constexpr std::chrono::seconds ReceiveTimeout{90};
+    static constexpr std::chrono::seconds KeepaliveInterval{120};
+
+    std::ostream& log(const Connection& connection) const
+    {
+        return std::cerr << "[" << connection.callSign << "] ";
+    }
+
+    // Start connection attempts, detect silent connections, send keepalives.
+    // Returns false if all connections are closed for good.
+    bool handleTimers()
+    {
+        auto const now = Clock::now();
+        bool active = false;
+        for (auto& pointer : m_connections) {
+            Connection& connection = *pointer;
+            switch (connection.state) {
+            case State::Waiting:
+                if (now >= connection.nextAttempt) {
+                    startConnect(connection);
+                }
+                break;
+            case State::Connecting:
+                if (now - connection.attemptStarted >= ConnectTimeout) {
+                    log(connection) << "Error: Connection timed out" << std::endl;
+                    fail(connection);
+                }
+                break;
+            case State::Connected:
+                if (now - connection.lastReceive >= ReceiveTimeout) {
+                    log(connection) << "Error: No data received for " << ReceiveTimeout.count() << " s" << std::endl;
+                    fail(connection);
+                } else if (now - connection.lastSend >= KeepaliveInterval) {
+                    send(connection, "# keepalive\n");
+                }
+                break;
+            case State::Closed:
+                break;
+            }
+            active = active || (connection.state != State::Closed);
+        }
+        return active;
+    }
+
+    // Milliseconds until handleTimers() has something to do, at most one second
+    [[nodiscard]] int nextTimeout() const
+    {
+        auto const now = Clock::now();
+        auto next = now + std::chrono::seconds(1);
+        for (const auto& connection : m_connections) {
+            switch (connection->state) {
+            case State::Waiting:
+                next = std::min(next, connection->nextAttempt);
+                break;
+            case State::Connecting:
+                next = std::min(next, connection->attemptStarted + ConnectTimeout);
+                break;
+            case State::Connected:
+                next = std::min({next, connection->lastReceive + ReceiveTimeout, connection->lastSend + KeepaliveInterval});
+                break;
+            case State::Closed:
+                break;
+            }
+        }
+        auto const milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count();
+        return static_cast<int>(std::max<long long>(0, milliseconds));
+    }
+
+    void startConnect(Connection& connection)
+    {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* addresses = nullptr;
+        int const error = getaddrinfo(m_host.c_str(), m_port.c_str(), &hints, &addresses);
+        if (error != 0) {
+            log(connection) << "Error: Could not resolve hostname " << m_host << ": " << gai_strerror(error) << std::endl;
+            fail(connection);
+            return;
+        }
+
+        log(connection) << "Connecting to " << m_host << ":" << m_port << "..." << std::endl;
+        int savedErrno = 0;
+        for (const addrinfo* address = addresses; address != nullptr; address = address->ai_next) {
+            int const fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+            if (fd < 0) {
+                savedErrno = errno;
+                continue;
+            }
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            if (connect(fd, address->ai_addr, address->ai_addrlen) == 0 || errno == EINPROGRESS) {
+                connection.fd = fd;
+                break;
+            }
+            savedErrno = errno;
+            ::close(fd);
+        }
+        freeaddrinfo(addresses);
+
+        if (connection.fd < 0) {
+            log(connection) << "Error: Could not connect: " << std::strerror(savedErrno) << std::endl;
+            fail(connection);
+            return;
+        }
+        connection.state = State::Connecting;
+        connection.attemptStarted = Clock::now();
+        m_poller.add(connection.fd, connection.index, true);
+    }
+
+    // Connect completed, successfully or not: log in
+    void finishConnect(Connection& connection)
+    {
+        int error = 0;
+        socklen_t length = sizeof(error);
+        if (getsockopt(connection.fd, SOL_SOCKET, SO_ERROR, &error, &length) < 0) {
+            error = errno;
+        }
+        if (error != 0) {
+            log(connection) << "Error: Could not connect: " << std::strerror(error) << std::endl;
+            fail(connection);
+            return;
+        }
+
+        auto const now = Clock::now();
+        connection.state = State::Connected;
+        connection.connected = now;
+        connection.lastReceive = now;
+        connection.reader.clear();
+        connection.pending.clear();
+        log(connection) << "Connected, filter " << connection.latitude << "," << connection.longitude
+                        << " radius " << connection.radiusKm << "km" << std::endl;
+        send(connection, Ogn::OgnParser::formatLoginString(connection.callSign, connection.latitude, connection.longitude,
+                                                             connection.radiusKm, m_appName, m_appVersion));
+    }
+
+    // Queue data and send as much as possible
+    void send(Connection& connection, std::string_view data)
+    {
+        bool const wasPending = !connection.pending.empty();
+        connection.pending += data;
+        connection.lastSend = Clock::now();
+        if (!wasPending) {
+            flushPending(connection);
+        }
+    }
+
+    void flushPending(Connection& connection)
+    {
+        if (connection.state != State::Connected) {
+            return;
+        }
+#if defined(MSG_NOSIGNAL)
+        constexpr int flags = MSG_NOSIGNAL;
+#else
+        constexpr int flags = 0;
+#endif
+        std::size_t sent = 0;
+        while (sent < connection.pending.size()) {
+            ssize_t const bytes = ::send(connection.fd, connection.pending.data() + sent, connection.pending.size() - sent, flags);
+            if (bytes < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    break;
+                }
+                log(connection) << "Error: Could not send: " << std::strerror(errno) << std::endl;
+                fail(connection);
+                return;
+            }
+            sent += static_cast<std::size_t>(bytes);
+        }
+        connection.pending.erase(0, sent);
+        m_poller.modify(connection.fd, connection.index, !connection.pending.empty());
+    }
+
+    void receive(Connection& connection, const LinesCallback& callback)
+    {
+        while (connection.state == State::Connected) {
+            ssize_t const bytes = connection.reader.fill(connection.fd);
+            if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return;
+            }
+            if (bytes <= 0) {
+                if (bytes == 0) {
+                    log(connection) << "Disconnected from server" << std::endl;
+                } else {
+                    log(connection) << "Error: Could not receive: " << std::strerror(errno) << std::endl;
+                }
+                fail(connection);
+                return;
+            }
+            connection.lastReceive = connection.reader.receiveTime();
+            const std::string_view lines = connection.reader.completeLines();
+            if (!lines.empty()) {
+                callback(lines, connection.lastReceive);
+            }
+            connection.reader.consume(lines.size());
+        }
+    }
+
+    void closeSocket(Connection& connection)
+    {
+        if (connection.fd >= 0) {
+            m_poller.remove(connection.fd);
+            ::close(connection.fd);
+            connection.fd = -1;
+        }
+    }
+
+    // Close the socket and schedule the next attempt
+    void fail(Connection& connection)
+    {
+        auto const now = Clock::now();
+        if (connection.state == State::Connected && now - connection.connected >= StableConnection) {
+            connection.backoff = MinimumBackoff;
+        }
+        closeSocket(connection);
+        connection.pending.clear();
+        if (!m_reconnect) {
+            connection.state = State::Closed;
+            return;
+        }
+
+        // Random jitter, so that connections do not retry in lockstep
+        std::uniform_int_distribution<long long> jitter(0, std::chrono::milliseconds(connection.backoff).count() / 2);
+        auto const delay = std::chrono::milliseconds(connection.backoff) + std::chrono::milliseconds(jitter(m_random));
+        log(connection) << "Reconnecting in " << std::chrono::duration<double>(delay).count() << " s" << std::endl;
+        connection.state = State::Waiting;
+        connection.nextAttempt = now + delay;
+        connection.backoff = std::min(connection.backoff * 2, MaximumBackoff);
+    }
+
+    std::string m_host;
+    std::string m_port;
+    std::string m_appName;
+    std::string m_appVersion;
+    bool m_reconnect = true;
+    std::atomic<bool> m_stop{false};
+
+    std::vector<std::unique_ptr<Connection>> m_connections;
+    EventPoller m_poller;
+    std::minstd_rand m_random;
+};
@@ -0,0 +1,165 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+/*! \brief Line reader for a socket that avoids copying
+ *
+ *  Data is received into one large, reusable buffer. Complete lines are
+ *  returned as a std::string_view that points into the buffer and can be
+ *  handed to Ogn::OgnParser::parseAprsisBatch as is. The incomplete last
+ *  line is moved to the front of the buffer only when the free space at
+ *  the end runs low.
+ *
+ *  Typical use:
+ *
+ *  \code
+ *  LineReader reader;
+ *  while (reader.fill(sock) > 0) {
+ *      const std::string_view lines = reader.completeLines();
+ *      // ... process lines ...
+ *      reader.consume(lines.size());
+ *  }
+ *  \endcode
+ */
+class LineReader
+{
+public:
+    /*! \brief Create reader
+     *
+     *  \param capacity Size of the buffer in bytes
+     */
+    explicit LineReader(std::size_t capacity = 256 * 1024)
+        : m_buffer(capacity)
+    {
+    }
+
+    /*! \brief Receive data from the socket
+     *
+     *  Blocks until data is available. A line that does not fit into the
+     *  buffer is discarded.
+     *
+     *  \return Number of bytes received, 0 if the connection was closed, -1 on error
+     */
+    ssize_t fill(int sock)
+    {
+        if (m_buffer.size() - m_end < MinimumReadSize) {
+            compact();
+        }
+        if (m_end == m_buffer.size()) {
+            // Overlong line: drop it, and the remainder up to the next newline
+            m_begin = 0;
+            m_end = 0;
+            m_discarding = true;
+        }
+
+        ssize_t bytes = 0;
+        do {
+            bytes = recv(sock, m_buffer.data() + m_end, m_buffer.size() - m_end, 0);
+        } while (bytes < 0 && errno == EINTR);
+        if (bytes <= 0) {
+            return bytes;
+        }
+
+        m_receiveTime = std::chrono::steady_clock::now();
+        std::size_t const oldEnd = m_end;
+        m_end += static_cast<std::size_t>(bytes);
+        if (m_discarding) {
+            const void* const newline = std::memchr(m_buffer.data() + oldEnd, '\n', m_end - oldEnd);
+            if (newline == nullptr) {
+                m_end = oldEnd;
+            } else {
+                m_begin = static_cast<std::size_t>(static_cast<const char*>(newline) - m_buffer.data()) + 1;
+                m_discarding = false;
+            }
+        }
+        return bytes;
+    }
+
+    /*! \brief All complete lines in the buffer
+     *
+     *  \return Lines including their terminating newline, or an empty view.
+     *  The view stays valid until the next call to fill().
+     */
+    [[nodiscard]] std::string_view completeLines() const
+    {
+        std::string_view const data(m_buffer.data() + m_begin, m_end - m_begin);
+        auto const lastNewline = data.rfind('\n');
+        if (lastNewline == std::string_view::npos) {
+            return {};
+        }
+        return data.substr(0, lastNewline + 1);
+    }
+
+    /*! \brief Time of the last fill() that received data
+     *
+     *  All lines returned by completeLines() were completed by that fill().
+     */
+    [[nodiscard]] std::chrono::steady_clock::time_point receiveTime() const { return m_receiveTime; }
+
+    //! Mark bytes at the beginning of the buffer as processed
+    void consume(std::size_t bytes)
+    {
+        m_begin += std::min(bytes, m_end - m_begin);
+        if (m_begin == m_end) {
+            m_begin = 0;
+            m_end = 0;
+        }
+    }
+
+    //! Drop all data, e.g. before reusing the reader for a new connection
+    void clear()
+    {
+        m_begin = 0;
+        m_end = 0;
+        m_discarding = false;
+    }
+
+private:
+    // Move unprocessed data to the front of the buffer
+    void compact()
+    {
+        if (m_begin == 0) {
+            return;
+        }
+        std::memmove(m_buffer.data(), m_buffer.data() + m_begin, m_end - m_begin);
+        m_end -= m_begin;
+        m_begin = 0;
+    }
+
+    // Compact before reading if less space than this is left
+    static constexpr std::size_t MinimumReadSize = 16 * 1024;
+
+    std::vector<char> m_buffer;
+    std::size_t m_begin = 0; // first unprocessed byte
+    std::size_t m_end = 0;   // end of received data
+    bool m_discarding = false;
+    std::chrono::steady_clock::time_point m_receiveTime;
+};
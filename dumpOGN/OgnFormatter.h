@@ -21,19 +21,21 @@
 #pragma once
 
 #include <string>
-#include "OutputFormatter.h"
+#include "OgnParser.h"
 
 /*! \brief OGN APRS-IS raw format
  *
  *  Outputs raw APRS-IS sentences as received from the OGN network.
  *  This is useful for debugging or for forwarding to other APRS-IS clients.
+ *  See OutputFormatter.h for the interface.
  */
-class OgnFormatter : public OutputFormatter
+class OgnFormatter
 {
 public:
-    std::string format(const Ogn::OgnMessage& message) override
+    bool formatInto(std::string& out, const Ogn::OgnMessageView& message)
     {
-        // Simply return the raw sentence as-is
-        return message.sentence;
+        // Simply pass the raw sentence through as-is
+        out += message.sentence;
+        return true;
     }
 };
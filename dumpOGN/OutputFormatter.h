@@ -20,22 +20,78 @@
 
 #pragma once
 
+#include <cstddef>
 #include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+#include "OgnFormatter.h"
 #include "OgnParser.h"
+#include "SBS1Formatter.h"
 
-/*! \brief Base class for output formatters
+/*! \brief Any of the output formatters
  *
- *  This abstract class defines the interface for converting OGN messages
- *  to different output formats (SBS-1, GDL90, Flarm, etc.)
+ *  Output formatters convert OGN messages to different output formats
+ *  (SBS-1, GDL90, Flarm, etc.). A formatter is a class with a member
+ *
+ *      bool formatInto(std::string& out, const Ogn::OgnMessageView& message);
+ *
+ *  that appends one line, without the terminating newline. It returns false
+ *  if the message should be skipped, and leaves out unchanged in that case.
+ *
+ *  Formatters do not share a base class. formatMessages() resolves the type
+ *  once for a whole range of messages, so that formatInto is inlined into
+ *  the loop over the messages. To add a format, add its class here and its
+ *  name to outputFormatterFromName().
+ */
+using OutputFormatter = std::variant<OgnFormatter, SBS1Formatter>;
+
+/*! \brief Create formatter from its name on the command line
+ *
+ *  \param name "ogn" or "sbs1"
+ *  \param formatter Receives the formatter
+ *  \return False if the name is unknown. In that case, formatter is left unchanged.
+ */
+inline bool outputFormatterFromName(std::string_view name, OutputFormatter& formatter)
+{
+    if (name == "ogn") {
+        formatter = OgnFormatter();
+        return true;
+    }
+    if (name == "sbs1") {
+        formatter = SBS1Formatter();
+        return true;
+    }
+    return false;
+}
+
+/*! \brief Append a range of formatted messages to an output buffer
+ *
+ *  Every message that is not skipped is followed by a newline.
+ *
+ *  \param formatter Formatter
+ *  \param out Buffer the output is appended to
+ *  \param messages The parsed OGN messages
+ *  \param count Number of messages
+ *  \param offsets If not null, the offset in out of every message, and
+ *  the end of the last one, are appended to it
  */
-class OutputFormatter
+inline void formatMessages(OutputFormatter& formatter, std::string& out, const Ogn::OgnMessageView* messages,
+                           std::size_t count, std::vector<std::size_t>* offsets = nullptr)
 {
-public:
-    virtual ~OutputFormatter() = default;
-    
-    /*! \brief Format an OGN message for output
-     *  \param message The parsed OGN message
-     *  \return Formatted string for output, or empty string if message should be skipped
-     */
-    virtual std::string format(const Ogn::OgnMessage& message) = 0;
-};
+    std::visit(
+        [&](auto& concreteFormatter) {
+            for (std::size_t i = 0; i < count; ++i) {
+                if (offsets != nullptr) {
+                    offsets->push_back(out.size());
+                }
+                if (concreteFormatter.formatInto(out, messages[i])) {
+                    out += '\n';
+                }
+            }
+            if (offsets != nullptr) {
+                offsets->push_back(out.size());
+            }
+        },
+        formatter);
+}
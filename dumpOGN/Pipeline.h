@@ -0,0 +1,474 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "OgnDuplicateFilter.h"
+#include "OgnLatencyHistogram.h"
+#include "OgnParser.h"
+#include "OgnTrafficRecord.h"
+#include "OutputFormatter.h"
+#include "SpscQueue.h"
+
+/*! \brief Latency histograms of the pipeline, in microseconds
+ *
+ *  Every message counts once in every histogram. Parse and format
+ *  durations are measured per chunk and averaged over its messages.
+ */
+struct LatencyReport
+{
+    Ogn::OgnLatencyHistogram queue;   // received -> parse started
+    Ogn::OgnLatencyHistogram parse;   // parse duration per message
+    Ogn::OgnLatencyHistogram format;  // format duration per message
+    Ogn::OgnLatencyHistogram output;  // received -> written, messages written only
+    Ogn::OgnLatencyHistogram dataAge; // embedded timestamp -> formatted, traffic reports written only
+
+    void reset()
+    {
+        queue.reset();
+        parse.reset();
+        format.reset();
+        output.reset();
+        dataAge.reset();
+    }
+
+    //! Print one line per histogram, with milliseconds
+    void print(std::ostream& stream) const
+    {
+        auto const print = [&stream](const char* name, const Ogn::OgnLatencyHistogram& histogram) {
+            auto const milliseconds = [](uint64_t microseconds) { return static_cast<double>(microseconds) * 1e-3; };
+            stream << "Latency " << std::left << std::setw(19) << name << std::right << ' ' << histogram.count() << " messages, ms: p50 "
+                   << milliseconds(histogram.valueAtPercentile(50.0)) << ", p90 " << milliseconds(histogram.valueAtPercentile(90.0))
+                   << ", p99 " << milliseconds(histogram.valueAtPercentile(99.0)) << ", max " << milliseconds(histogram.maximum()) << '\n';
+        };
+        print("receive -> parse", queue);
+        print("parse", parse);
+        print("format", format);
+        print("receive -> output", output);
+        print("data age", dataAge);
+        stream.flush();
+    }
+};
+
+/*! \brief Receive, parse/format and output stages on separate threads
+ *
+ *  The receiving thread hands chunks of complete lines to submit(). They
+ *  are distributed round-robin over the parse workers, which parse and
+ *  format them. The output thread collects the results in the same
+ *  round-robin order, so the output has exactly the order of the input.
+ *  Duplicate filtering needs to see all messages and runs on the output
+ *  thread.
+ *
+ *  Every message is parsed once and formatted by all outputs, each with its
+ *  own formatter, output buffer and writer.
+ *
+ *  All stages are connected by SpscQueue. Chunks are recycled through a
+ *  fixed pool: if the output stalls and the pool runs empty, submit()
+ *  drops the chunk instead of blocking, so that the receiving thread keeps
+ *  draining the socket and the server does not drop the connection.
+ */
+class Pipeline
+{
+public:
+    //! Writes the buffer and clears it, returns false on error
+    using Writer = std::function<bool(std::string&)>;
+
+    //! Format and destination of one output
+    struct Output
+    {
+        OutputFormatter formatter;
+        Writer writer;
+    };
+
+    //! Receives the latency histograms of an interval, on the output thread
+    using LatencyCallback = std::function<void(const LatencyReport&)>;
+
+    /*! \brief Create pipeline and start its threads
+     *
+     *  \param workers Number of parse workers
+     *  \param outputs Outputs, at least one. Every worker formats with a copy
+     *  of their formatters.
+     *  \param dedup Drop duplicate traffic reports
+     *  \param flushInterval Write output at least this often
+     *  \param flushSize Write output once that many bytes are buffered
+     *  \param latencyCallback If set, latencies are measured and reported
+     *  every latencyInterval, and once more by finish()
+     *  \param latencyInterval Interval of the latency reports
+     *  \param chunks Number of chunks in the pool
+     */
+    Pipeline(std::size_t workers, std::vector<Output> outputs,
+             bool dedup, std::chrono::milliseconds flushInterval, std::size_t flushSize,
+             LatencyCallback latencyCallback = nullptr,
+             std::chrono::milliseconds latencyInterval = std::chrono::seconds(10),
+             std::size_t chunks = 64)
+        : m_dedup(dedup)
+        , m_flushInterval(flushInterval)
+        , m_flushSize(flushSize)
+        , m_latencyCallback(std::move(latencyCallback))
+        , m_latencyInterval(latencyInterval)
+        , m_free(chunks)
+    {
+        workers = std::max<std::size_t>(workers, 1);
+        std::vector<OutputFormatter> formatters;
+        for (auto& output : outputs) {
+            formatters.push_back(output.formatter);
+            m_writers.push_back(std::move(output.writer));
+        }
+        m_pool.reserve(chunks);
+        for (std::size_t i = 0; i < chunks; ++i) {
+            m_pool.push_back(std::make_unique<Chunk>());
+            m_pool.back()->outputs.resize(formatters.size());
+            m_free.tryPush(m_pool.back().get());
+        }
+        // One extra slot per queue for the end marker
+        for (std::size_t i = 0; i < workers; ++i) {
+            m_workers.push_back(std::make_unique<Worker>(chunks + 1, formatters, m_latencyCallback != nullptr));
+        }
+        for (auto& worker : m_workers) {
+            worker->thread = std::thread(&Pipeline::runWorker, worker.get());
+        }
+        m_outputThread = std::thread(&Pipeline::runOutput, this);
+    }
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+    ~Pipeline() { finish(); }
+
+    /*! \brief Hand complete lines to the parse workers, receiving thread only
+     *
+     *  The lines are copied.
+     *
+     *  \param lines Complete lines
+     *  \param received Time the lines were received, for the latency report
+     *  \return False if the chunk was dropped because the output stalls
+     */
+    bool submit(std::string_view lines, std::chrono::steady_clock::time_point received = std::chrono::steady_clock::now())
+    {
+        if (lines.empty()) {
+            return true;
+        }
+        Chunk* chunk = nullptr;
+        if (!m_free.tryPop(chunk)) {
+            m_droppedChunks++;
+            m_droppedBytes += lines.size();
+            return false;
+        }
+        chunk->text.assign(lines.data(), lines.size());
+        chunk->received = received;
+        push(m_workers[m_next]->input, chunk);
+        m_next = (m_next + 1) % m_workers.size();
+        return true;
+    }
+
+    //! True if writing output failed; the receiving thread should stop
+    [[nodiscard]] bool failed() const { return m_failed.load(std::memory_order_relaxed); }
+
+    //! Process all submitted chunks, write the output and stop the threads
+    void finish()
+    {
+        if (!m_outputThread.joinable()) {
+            return;
+        }
+        for (auto& worker : m_workers) {
+            push(worker->input, nullptr);
+        }
+        for (auto& worker : m_workers) {
+            worker->thread.join();
+        }
+        m_outputThread.join();
+    }
+
+    //! Number of traffic reports dropped as duplicates, valid after finish()
+    [[nodiscard]] std::size_t duplicateCount() const { return m_duplicateFilter.duplicateCount(); }
+
+    //! Print queue depths and drop counts, call after finish()
+    void printStatistics(std::ostream& stream) const
+    {
+        auto const print = [&stream](const char* name, std::size_t index, const QueueStatistics& statistics) {
+            stream << "Queue " << name << " #" << index << ": " << statistics.pushes << " chunks, mean depth "
+                   << statistics.meanDepth() << ", max depth " << statistics.maxDepth << '\n';
+        };
+        for (std::size_t i = 0; i < m_workers.size(); ++i) {
+            print("receive -> parse", i, m_workers[i]->input.statistics());
+        }
+        for (std::size_t i = 0; i < m_workers.size(); ++i) {
+            print("parse -> output", i, m_workers[i]->output.statistics());
+        }
+        stream << "Dropped " << m_droppedChunks << " chunks (" << m_droppedBytes << " bytes) while output stalled" << std::endl;
+    }
+
+private:
+    // Messages formatted for one output
+    struct Formatted
+    {
+        std::string text;                 // formatted messages, with newlines
+        std::vector<std::size_t> offsets; // start of each message in text, and end
+    };
+
+    // Lines, and the parsed and formatted messages
+    struct Chunk
+    {
+        std::string text;
+        std::vector<Ogn::OgnMessageView> messages; // point into text
+        std::vector<Formatted> outputs;            // one per output
+
+        // Set if latencies are measured
+        std::chrono::steady_clock::time_point received;
+        std::chrono::steady_clock::time_point parseStarted;
+        std::chrono::steady_clock::time_point parsed;
+        std::chrono::steady_clock::time_point formatted;
+    };
+
+    struct Worker
+    {
+        Worker(std::size_t capacity, std::vector<OutputFormatter> formatters, bool timed)
+            : input(capacity)
+            , output(capacity)
+            , formatters(std::move(formatters))
+            , timed(timed)
+        {
+        }
+
+        SpscQueue<Chunk*> input;
+        SpscQueue<Chunk*> output;
+        std::vector<OutputFormatter> formatters; // one per output
+        bool timed;
+        std::thread thread;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    static uint64_t microseconds(Clock::duration duration)
+    {
+        auto const count = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        return count < 0 ? 0 : static_cast<uint64_t>(count);
+    }
+
+    // Seconds from the timestamp "hhmmss" of a traffic report to the UTC time now, at least 0
+    static double dataAge(std::string_view timestamp, std::chrono::system_clock::time_point now)
+    {
+        uint32_t const secondsOfDay = Ogn::OgnTrafficRecord::decodeTimestamp(timestamp);
+        if (secondsOfDay == Ogn::OgnTrafficRecord::InvalidTimestamp) {
+            return -1.0;
+        }
+        double const nowSeconds = std::chrono::duration<double>(now.time_since_epoch()).count();
+        double age = std::fmod(nowSeconds, 86400.0) - secondsOfDay;
+        // The timestamp may be from the previous day
+        if (age < -43200.0) {
+            age += 86400.0;
+        } else if (age >= 43200.0) {
+            age -= 86400.0;
+        }
+        return std::max(age, 0.0);
+    }
+
+    // Push into a queue that cannot stay full, as the pool is bounded
+    static void push(SpscQueue<Chunk*>& queue, Chunk* chunk)
+    {
+        Backoff backoff;
+        while (!queue.tryPush(chunk)) {
+            backoff.pause();
+        }
+    }
+
+    static Chunk* pop(SpscQueue<Chunk*>& queue)
+    {
+        Backoff backoff;
+        Chunk* chunk = nullptr;
+        while (!queue.tryPop(chunk)) {
+            backoff.pause();
+        }
+        return chunk;
+    }
+
+    // Parse stage, nullptr ends it and is passed on
+    static void runWorker(Worker* worker)
+    {
+        while (true) {
+            Chunk* const chunk = pop(worker->input);
+            if (chunk != nullptr) {
+                if (worker->timed) {
+                    chunk->parseStarted = Clock::now();
+                }
+                Ogn::OgnParser::parseAprsisBatch(chunk->text, chunk->messages);
+                if (worker->timed) {
+                    chunk->parsed = Clock::now();
+                }
+                for (std::size_t i = 0; i < worker->formatters.size(); ++i) {
+                    auto& formatted = chunk->outputs[i];
+                    formatted.text.clear();
+                    formatted.offsets.clear();
+                    formatMessages(worker->formatters[i], formatted.text, chunk->messages.data(), chunk->messages.size(),
+                                   &formatted.offsets);
+                }
+                if (worker->timed) {
+                    chunk->formatted = Clock::now();
+                }
+            }
+            push(worker->output, chunk);
+            if (chunk == nullptr) {
+                return;
+            }
+        }
+    }
+
+    // Output stage, ends at the first end marker in round-robin order
+    void runOutput()
+    {
+        bool const timed = (m_latencyCallback != nullptr);
+        LatencyReport latency;
+        // Receive time and number of the messages in output
+        std::vector<std::pair<Clock::time_point, std::size_t>> unwritten;
+        unwritten.reserve(m_pool.size());
+        auto lastReport = Clock::now();
+
+        // One buffer per output
+        std::vector<std::string> outputs(m_writers.size());
+        for (auto& output : outputs) {
+            output.reserve(m_flushSize + 4096);
+        }
+        auto const pending = [&]() {
+            return std::any_of(outputs.begin(), outputs.end(), [](const std::string& output) { return !output.empty(); });
+        };
+        auto const full = [&]() {
+            return std::any_of(outputs.begin(), outputs.end(), [this](const std::string& output) { return output.size() >= m_flushSize; });
+        };
+        auto lastFlush = Clock::now();
+        auto const flush = [&]() {
+            for (std::size_t i = 0; i < outputs.size(); ++i) {
+                if (!outputs[i].empty() && !m_failed.load(std::memory_order_relaxed) && !m_writers[i](outputs[i])) {
+                    m_failed.store(true, std::memory_order_relaxed);
+                }
+                outputs[i].clear();
+            }
+            lastFlush = Clock::now();
+            for (auto const& [received, count] : unwritten) {
+                latency.output.record(microseconds(lastFlush - received), count);
+            }
+            unwritten.clear();
+        };
+
+        std::size_t next = 0;
+        Backoff backoff;
+        while (true) {
+            Chunk* chunk = nullptr;
+            if (!m_workers[next]->output.tryPop(chunk)) {
+                // Do not keep output back while waiting
+                if (pending() && Clock::now() - lastFlush >= m_flushInterval) {
+                    flush();
+                }
+                backoff.pause();
+                continue;
+            }
+            backoff.reset();
+            if (chunk == nullptr) {
+                break;
+            }
+            next = (next + 1) % m_workers.size();
+
+            std::size_t const messages = chunk->messages.size();
+            std::size_t written = messages;
+            auto const systemNow = std::chrono::system_clock::now();
+            auto const recordAge = [&](const Ogn::OgnMessageView& message) {
+                if (timed && message.type == Ogn::OgnMessageType::TRAFFIC_REPORT) {
+                    double const age = dataAge(message.timestamp, systemNow);
+                    if (age >= 0.0) {
+                        latency.dataAge.record(static_cast<uint64_t>(age * 1e6));
+                    }
+                }
+            };
+            if (m_dedup) {
+                written = 0;
+                for (std::size_t i = 0; i < messages; ++i) {
+                    if (!m_duplicateFilter.isDuplicate(chunk->messages[i])) {
+                        for (std::size_t j = 0; j < outputs.size(); ++j) {
+                            auto const& formatted = chunk->outputs[j];
+                            outputs[j].append(formatted.text, formatted.offsets[i], formatted.offsets[i + 1] - formatted.offsets[i]);
+                        }
+                        recordAge(chunk->messages[i]);
+                        written++;
+                    }
+                }
+            } else {
+                for (std::size_t j = 0; j < outputs.size(); ++j) {
+                    outputs[j] += chunk->outputs[j].text;
+                }
+                for (const auto& message : chunk->messages) {
+                    recordAge(message);
+                }
+            }
+            if (timed && messages > 0) {
+                latency.queue.record(microseconds(chunk->parseStarted - chunk->received), messages);
+                latency.parse.record(microseconds(chunk->parsed - chunk->parseStarted) / messages, messages);
+                latency.format.record(microseconds(chunk->formatted - chunk->parsed) / messages, messages);
+                unwritten.emplace_back(chunk->received, written);
+            }
+            m_free.tryPush(chunk);
+
+            if (full() || Clock::now() - lastFlush >= m_flushInterval) {
+                flush();
+            }
+            if (timed && Clock::now() - lastReport >= m_latencyInterval) {
+                m_latencyCallback(latency);
+                latency.reset();
+                lastReport = Clock::now();
+            }
+        }
+        flush();
+        if (timed) {
+            m_latencyCallback(latency);
+        }
+    }
+
+    std::vector<Writer> m_writers; // one per output
+    bool m_dedup;
+    std::chrono::milliseconds m_flushInterval;
+    std::size_t m_flushSize;
+    LatencyCallback m_latencyCallback;
+    std::chrono::milliseconds m_latencyInterval;
+
+    std::vector<std::unique_ptr<Chunk>> m_pool;
+    SpscQueue<Chunk*> m_free; // output thread -> receiving thread
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::thread m_outputThread;
+    std::atomic<bool> m_failed{false};
+
+    // Receiving thread
+    std::size_t m_next = 0;
+    std::size_t m_droppedChunks = 0;
+    std::size_t m_droppedBytes = 0;
+
+    // Output thread
+    Ogn::OgnDuplicateFilter m_duplicateFilter;
+};
@@ -0,0 +1,162 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "OgnTrafficRecord.h"
+
+/*! \brief Read-only memory mapping of a whole file
+ *
+ *  Used by the replay mode of dumpOGN, so that captured sentences can be
+ *  parsed in place, without copying them.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    /*! \brief Map file
+     *
+     *  \return False if the file cannot be opened or mapped
+     */
+    bool open(const std::string& fileName)
+    {
+        close();
+        const int fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat status{};
+        if (fstat(fd, &status) != 0) {
+            ::close(fd);
+            return false;
+        }
+        m_size = static_cast<std::size_t>(status.st_size);
+        if (m_size > 0) {
+            m_data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (m_data == MAP_FAILED) {
+                m_data = nullptr;
+                m_size = 0;
+                ::close(fd);
+                return false;
+            }
+            // The file is read front to back, exactly once
+            madvise(m_data, m_size, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+        return true;
+    }
+
+    void close()
+    {
+        if (m_data != nullptr) {
+            munmap(m_data, m_size);
+        }
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    [[nodiscard]] std::string_view data() const
+    {
+        return {static_cast<const char*>(m_data), m_size};
+    }
+
+private:
+    void* m_data = nullptr;
+    std::size_t m_size = 0;
+};
+
+/*! \brief Pace a replay by the timestamps embedded in the sentences
+ *
+ *  The first timestamp is mapped to the moment of the first call. Later
+ *  calls sleep until the wall clock has caught up with the timestamp,
+ *  divided by the speed factor. Timestamps that go backwards (receivers
+ *  report with small delays relative to each other) do not sleep. The day
+ *  change at midnight is taken into account.
+ */
+class ReplayPacer
+{
+public:
+    /*! \brief Create pacer
+     *
+     *  \param speed Replay speed, 1 for real time, 10 for ten times faster
+     */
+    explicit ReplayPacer(double speed)
+        : m_speed(speed)
+    {
+    }
+
+    /*! \brief Compute when the sentence with the given timestamp is due
+     *
+     *  \param timestamp Timestamp as "hhmmss", other values are ignored
+     *  \return True if the caller has to wait() before handling the sentence
+     */
+    bool schedule(std::string_view timestamp)
+    {
+        const uint32_t decoded = Ogn::OgnTrafficRecord::decodeTimestamp(timestamp);
+        if (decoded == Ogn::OgnTrafficRecord::InvalidTimestamp) {
+            return false;
+        }
+        const int secondOfDay = static_cast<int>(decoded);
+        if (m_origin < 0) {
+            m_origin = secondOfDay;
+            m_latest = secondOfDay;
+            m_start = std::chrono::steady_clock::now();
+            return false;
+        }
+
+        // Seconds since the first timestamp, across midnight
+        int elapsed = secondOfDay - m_origin + m_dayOffset;
+        if (elapsed < m_latest - m_origin - 43200) {
+            m_dayOffset += 86400;
+            elapsed += 86400;
+        }
+        if (elapsed <= m_latest - m_origin) {
+            return false;
+        }
+        m_latest = m_origin + elapsed;
+        m_due = m_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(elapsed / m_speed));
+        return m_due > std::chrono::steady_clock::now();
+    }
+
+    //! Sleep until the sentence passed to the last schedule() is due
+    void wait() const { std::this_thread::sleep_until(m_due); }
+
+private:
+    double m_speed;
+    int m_origin = -1;    // second of day of the first timestamp
+    int m_latest = 0;     // latest timestamp, counted from the day of m_origin
+    int m_dayOffset = 0;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::steady_clock::time_point m_due;
+};
@@ -20,12 +20,17 @@
 
 #pragma once
 
-#include <string>
-#include <sstream>
-#include <iomanip>
-#include <ctime>
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <cmath>
-#include "OutputFormatter.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include "OgnParser.h"
 
 /*! \brief SBS-1 BaseStation format (dump1090-compatible)
  *
@@ -55,73 +60,152 @@
  *  20. Emergency flag
  *  21. SPI flag
  *  22. Is on ground
+ *
+ *  The formatter keeps no per-aircraft state. It caches the date and time
+ *  strings for the current second, and assembles each line in a buffer on
+ *  the stack, so that formatting does not allocate memory besides growing
+ *  the output buffer. See OutputFormatter.h for the interface.
  */
-class SBS1Formatter : public OutputFormatter
+class SBS1Formatter
 {
 public:
-    std::string format(const Ogn::OgnMessage& message) override
+    bool formatInto(std::string& out, const Ogn::OgnMessageView& message)
     {
         // SBS-1 is only for traffic reports
         if (message.type != Ogn::OgnMessageType::TRAFFIC_REPORT) {
-            return std::string();
+            return false;
         }
-        
+
         if (std::isnan(message.latitude) || std::isnan(message.longitude)) {
-            return std::string();
+            return false;
+        }
+
+        // Current timestamp, as "YYYY/MM/DD,HH:MM:SS.000"
+        updateTimestamp(std::time(nullptr));
+
+        char line[LineCapacity];
+        char* p = line;
+
+        p = appendText(p, "MSG,8,111,11111,");
+        // ICAO address as 6-character upper-case hex, zeros if unknown
+        char* const icaoHex = p;
+        p = appendAddress(p, message.addressValue == Ogn::OgnMessageData::InvalidAddress ? 0 : message.addressValue);
+        std::string_view const icao(icaoHex, 6);
+        p = appendText(p, ",111111,");
+        p = appendText(p, std::string_view(m_timestamp.data(), TimestampLength));
+        *p++ = ',';
+        p = appendText(p, std::string_view(m_timestamp.data(), TimestampLength));
+        *p++ = ',';
+
+        // Callsign (use flightnumber if available, ICAO as fallback)
+        p = appendText(p, message.flightnumber.empty() ? icao : message.flightnumber);
+        *p++ = ',';
+
+        // Altitude in feet, empty if unknown
+        if (!std::isnan(message.altitude)) {
+            p = appendInteger(p, static_cast<int>(message.altitude * 3.28084));
+        }
+        *p++ = ',';
+        // Speed in knots, track in degrees
+        p = appendInteger(p, static_cast<int>(message.speed));
+        *p++ = ',';
+        p = appendInteger(p, static_cast<int>(message.course));
+        *p++ = ',';
+        p = appendFixed6(p, message.latitude);
+        *p++ = ',';
+        p = appendFixed6(p, message.longitude);
+        *p++ = ',';
+        // Vertical speed from m/s to feet/min
+        p = appendInteger(p, static_cast<int>(message.verticalSpeed * 196.85));
+        p = appendText(p, ",,,,,");
+
+        out.append(line, static_cast<std::size_t>(p - line));
+        return true;
+    }
+
+private:
+    // Length of "YYYY/MM/DD,HH:MM:SS.000"
+    static constexpr std::size_t TimestampLength = 23;
+
+    // Longer callsigns are truncated, so that a line always
+    // fits into LineCapacity bytes
+    static constexpr std::size_t MaxTextLength = 32;
+    static constexpr std::size_t LineCapacity = 256;
+
+    void updateTimestamp(std::time_t now)
+    {
+        if (now == m_timestampSecond) {
+            return;
         }
-        
-        // Get current timestamp
-        std::time_t now = std::time(nullptr);
-        std::tm* utc_tm = std::gmtime(&now);
-        
-        char dateStr[32];
-        char timeStr[32];
-        std::snprintf(dateStr, sizeof(dateStr), "%04d/%02d/%02d", 
-                     utc_tm->tm_year + 1900, utc_tm->tm_mon + 1, utc_tm->tm_mday);
-        std::snprintf(timeStr, sizeof(timeStr), "%02d:%02d:%02d.000",
-                     utc_tm->tm_hour, utc_tm->tm_min, utc_tm->tm_sec);
-        
-        // Convert ICAO address to 6-character hex (pad with zeros if needed)
-        std::string icaoHex(message.address);
-        // Convert to uppercase
-        for (char& c : icaoHex) {
-            c = std::toupper(static_cast<unsigned char>(c));
+        m_timestampSecond = now;
+
+        std::tm utc{};
+        gmtime_r(&now, &utc);
+        char* p = m_timestamp.data();
+        p = appendDigits(p, utc.tm_year + 1900, 4);
+        *p++ = '/';
+        p = appendDigits(p, utc.tm_mon + 1, 2);
+        *p++ = '/';
+        p = appendDigits(p, utc.tm_mday, 2);
+        *p++ = ',';
+        p = appendDigits(p, utc.tm_hour, 2);
+        *p++ = ':';
+        p = appendDigits(p, utc.tm_min, 2);
+        *p++ = ':';
+        p = appendDigits(p, utc.tm_sec, 2);
+        std::memcpy(p, ".000", 4);
+    }
+
+    // Zero-padded decimal number with the given number of digits
+    static char* appendDigits(char* p, int value, int digits)
+    {
+        for (int i = digits - 1; i >= 0; --i) {
+            p[i] = static_cast<char>('0' + value % 10);
+            value /= 10;
         }
-        while (icaoHex.length() < 6) {
-            icaoHex = "0" + icaoHex;
+        return p + digits;
+    }
+
+    // Copy text, truncated to MaxTextLength
+    static char* appendText(char* p, std::string_view text)
+    {
+        std::size_t const length = std::min(text.size(), MaxTextLength);
+        std::memcpy(p, text.data(), length);
+        return p + length;
+    }
+
+    // 24-bit address as six upper-case hex digits
+    static char* appendAddress(char* p, uint32_t address)
+    {
+        constexpr char digits[] = "0123456789ABCDEF";
+        for (int i = 5; i >= 0; --i) {
+            p[i] = digits[address & 0xF];
+            address >>= 4;
         }
-        
-        // Convert altitude from meters to feet
-        const int altitudeFeet = static_cast<int>(message.altitude * 3.28084);
-        
-        // Convert speed from m/s to knots (message.speed is already in knots as double)
-        const int speedKnots = static_cast<int>(message.speed);
-        
-        // Convert course to integer degrees
-        const int trackDegrees = static_cast<int>(message.course);
-        
-        // Convert vertical speed from m/s to feet/min
-        const int verticalRateFpm = static_cast<int>(message.verticalSpeed * 196.85);
-        
-        // Format callsign (use flightnumber if available)
-        std::string callsign(message.flightnumber);
-        if (callsign.empty()) {
-            callsign = icaoHex; // Use ICAO as fallback
+        return p + 6;
+    }
+
+    // At most 11 characters
+    static char* appendInteger(char* p, int value)
+    {
+        return std::to_chars(p, p + 11, value).ptr;
+    }
+
+    // Fixed-point with six decimals, as printf("%.6f") would. Meant for
+    // coordinates: the value is clamped to +/-999.
+    static char* appendFixed6(char* p, double value)
+    {
+        long long micro = std::llround(std::clamp(value, -999.0, 999.0) * 1e6);
+        if (micro < 0) {
+            *p++ = '-';
+            micro = -micro;
         }
-        
-        // Build MSG type 8 (all data) output
-        std::ostringstream oss;
-        oss << "MSG,8,111,11111," << icaoHex << ",111111,"
-            << dateStr << "," << timeStr << ","
-            << dateStr << "," << timeStr << ","
-            << callsign << ","
-            << altitudeFeet << ","
-            << speedKnots << ","
-            << trackDegrees << ","
-            << std::fixed << std::setprecision(6) << message.latitude << ","
-            << std::fixed << std::setprecision(6) << message.longitude << ","
-            << verticalRateFpm << ",,,,,";
-        
-        return oss.str();
+        auto const degrees = static_cast<int>(micro / 1000000);
+        p = appendDigits(p, degrees, degrees >= 100 ? 3 : (degrees >= 10 ? 2 : 1));
+        *p++ = '.';
+        return appendDigits(p, static_cast<int>(micro % 1000000), 6);
     }
+
+    std::time_t m_timestampSecond = -1;
+    std::array<char, TimestampLength> m_timestamp{};
 };
@@ -0,0 +1,162 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/*! \brief Depth statistics of a queue, as seen by the producer */
+struct QueueStatistics
+{
+    std::size_t pushes = 0;   // successful pushes
+    std::size_t depthSum = 0; // sum of the depths after each push
+    std::size_t maxDepth = 0; // high-water mark
+
+    [[nodiscard]] double meanDepth() const { return pushes == 0 ? 0.0 : static_cast<double>(depthSum) / static_cast<double>(pushes); }
+};
+
+/*! \brief Bounded lock-free queue for one producer and one consumer thread
+ *
+ *  The ring buffer holds a power of two of slots. Producer and consumer own
+ *  one index each and keep a cached copy of the other index, so that the
+ *  shared cache lines are touched only when the queue looks full or empty.
+ */
+template<typename T>
+class SpscQueue
+{
+public:
+    /*! \brief Create queue
+     *
+     *  \param capacity Minimal number of elements, rounded up to a power of two
+     */
+    explicit SpscQueue(std::size_t capacity)
+    {
+        std::size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        m_slots.resize(size);
+        m_mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /*! \brief Append element, producer thread only
+     *
+     *  \return False if the queue is full
+     */
+    bool tryPush(const T& value)
+    {
+        std::size_t const tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead > m_mask) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead > m_mask) {
+                return false;
+            }
+        }
+        m_slots[tail & m_mask] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+
+        std::size_t const depth = tail + 1 - m_head.load(std::memory_order_relaxed);
+        m_statistics.pushes++;
+        m_statistics.depthSum += depth;
+        m_statistics.maxDepth = std::max(m_statistics.maxDepth, depth);
+        return true;
+    }
+
+    /*! \brief Remove first element, consumer thread only
+     *
+     *  \return False if the queue is empty
+     */
+    bool tryPop(T& value)
+    {
+        std::size_t const head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail) {
+                return false;
+            }
+        }
+        value = m_slots[head & m_mask];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] std::size_t capacity() const { return m_mask + 1; }
+
+    /*! \brief Depth statistics
+     *
+     *  Updated by the producer. Read them only once the producer has stopped.
+     */
+    [[nodiscard]] const QueueStatistics& statistics() const { return m_statistics; }
+
+private:
+    // Keep indices of producer and consumer on separate cache lines
+    static constexpr std::size_t CacheLineSize = 64;
+
+    std::vector<T> m_slots;
+    std::size_t m_mask = 0;
+
+    alignas(CacheLineSize) std::atomic<std::size_t> m_head{0}; // written by consumer
+    std::size_t m_cachedTail = 0;
+
+    alignas(CacheLineSize) std::atomic<std::size_t> m_tail{0}; // written by producer
+    std::size_t m_cachedHead = 0;
+    QueueStatistics m_statistics;
+};
+
+/*! \brief Wait strategy for threads that poll a queue
+ *
+ *  Spins briefly, then yields, then sleeps for up to one millisecond.
+ */
+class Backoff
+{
+public:
+    void pause()
+    {
+        if (m_count < 64) {
+            ++m_count;
+            return;
+        }
+        if (m_count < 128) {
+            ++m_count;
+            std::this_thread::yield();
+            return;
+        }
+        std::this_thread::sleep_for(m_sleep);
+        m_sleep = std::min(m_sleep * 2, std::chrono::microseconds(1000));
+    }
+
+    void reset()
+    {
+        m_count = 0;
+        m_sleep = std::chrono::microseconds(50);
+    }
+
+private:
+    int m_count = 0;
+    std::chrono::microseconds m_sleep{50};
+};
@@ -18,79 +18,181 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <csignal>
+#include <cstdlib>
 #include <cstring>
 #include <random>
+#include <chrono>
+#include <fcntl.h>
 #include <getopt.h>
 #include <unistd.h>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <netdb.h>
-#include <arpa/inet.h>
+#include <utility>
+#include <vector>
+#include "AprsClient.h"
+#include "OgnDuplicateFilter.h"
+#include "Pipeline.h"
+#include "Replay.h"
 #include "OgnParser.h"
-#include "OgnFormatter.h"
-#include "SBS1Formatter.h"
+#include "OutputFormatter.h"
 
-// Connect to TCP server
-int connectToServer(const std::string& hostname, int port) {
-    // Resolve hostname
-    const struct hostent* const host = gethostbyname(hostname.c_str());
-    if (host == nullptr) {
-        std::cerr << "Error: Could not resolve hostname: " << hostname << std::endl;
-        return -1;
-    }
+// Center and radius of a range filter
+struct Area {
+    double latitude = 0.0;
+    double longitude = 0.0;
+    unsigned int radius = 50;
+};
+
+// Client of the running event loop, stopped by SIGINT and SIGTERM
+AprsClient* activeClient = nullptr;
 
-    // Create socket
-    int sock = socket(AF_INET, SOCK_STREAM, 0); // NOLINT(misc-const-correctness) - modified by connect()
-    if (sock < 0) {
-        std::cerr << "Error: Could not create socket: " << std::strerror(errno) << std::endl;
-        return -1;
+void handleSignal(int /*signal*/) {
+    if (activeClient != nullptr) {
+        activeClient->stop();
     }
+}
 
-    // Setup server address
-    struct sockaddr_in server_addr{};
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(port);
-    std::memcpy(&server_addr.sin_addr.s_addr, host->h_addr, host->h_length);
+// Parse "LAT,LON,RADIUS"
+bool parseArea(const std::string& text, Area& area) {
+    char* end = nullptr;
+    area.latitude = std::strtod(text.c_str(), &end);
+    if (*end != ',') {
+        return false;
+    }
+    area.longitude = std::strtod(end + 1, &end);
+    if (*end != ',') {
+        return false;
+    }
+    area.radius = static_cast<unsigned int>(std::strtoul(end + 1, &end, 10));
+    return *end == '\0';
+}
 
-    // Connect
-    std::cerr << "Connecting to " << hostname << ":" << port << "..." << std::endl;
-    if (connect(sock, reinterpret_cast<struct sockaddr*>(&server_addr), sizeof(server_addr)) < 0) {
-        std::cerr << "Error: Could not connect: " << std::strerror(errno) << std::endl;
-        close(sock);
-        return -1;
+// Write buffer to a file descriptor and clear it
+bool flushOutput(int fd, std::string& output) {
+    const char* data = output.data();
+    size_t remaining = output.size();
+    while (remaining > 0) {
+        const ssize_t bytes = write(fd, data, remaining);
+        if (bytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Error: Could not write output: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        data += bytes;
+        remaining -= static_cast<size_t>(bytes);
     }
+    output.clear();
+    return true;
+}
 
-    std::cerr << "Connected to OGN APRS-IS server" << std::endl;
-    return sock;
+// Parse "FORMAT[:FILE]" and open the file, "-" or no file is stdout
+bool openOutput(const std::string& text, Pipeline::Output& output, std::vector<int>& files) {
+    const size_t colon = text.find(':');
+    if (!outputFormatterFromName(std::string_view(text).substr(0, colon), output.formatter)) {
+        std::cerr << "Error: Unknown output format in " << text << ", expected ogn or sbs1\n" << std::endl;
+        return false;
+    }
+    int fd = STDOUT_FILENO;
+    if (colon != std::string::npos && text.compare(colon + 1, std::string::npos, "-") != 0) {
+        const std::string fileName = text.substr(colon + 1);
+        fd = open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            std::cerr << "Error: Could not open " << fileName << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        files.push_back(fd);
+    }
+    output.writer = [fd](std::string& buffer) { return flushOutput(fd, buffer); };
+    return true;
 }
 
-// Read line from socket (buffered)
-bool readLine(int sock, std::string& line, std::string& buffer) {
-    line.clear();
-    
-    while (true) {
-        // Check if we have a complete line in buffer
-        const size_t pos = buffer.find('\n');
-        if (pos != std::string::npos) {
-            line = buffer.substr(0, pos);
-            buffer.erase(0, pos + 1);
-            // Remove trailing \r if present
-            if (!line.empty() && line.back() == '\r') {
-                line.pop_back();
+// Replay a capture file, parsing the sentences in place
+int replayFile(const std::string& fileName, double pace, std::vector<Pipeline::Output>& outputs,
+               Ogn::OgnDuplicateFilter* duplicateFilter, size_t flushSize) {
+    MappedFile file;
+    if (!file.open(fileName)) {
+        std::cerr << "Error: Could not read " << fileName << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    ReplayPacer pacer(pace);
+    std::vector<Ogn::OgnMessageView> messages;
+    // One buffer per output
+    std::vector<std::string> buffers(outputs.size());
+    for (auto& buffer : buffers) {
+        buffer.reserve(flushSize + 4096);
+    }
+    const auto format = [&](size_t begin, size_t end) {
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            formatMessages(outputs[i].formatter, buffers[i], messages.data() + begin, end - begin);
+        }
+    };
+    const auto flush = [&](size_t minimumSize) {
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            if (!buffers[i].empty() && buffers[i].size() >= minimumSize && !outputs[i].writer(buffers[i])) {
+                return false;
+            }
+        }
+        return true;
+    };
+    size_t messageCount = 0;
+    const auto start = std::chrono::steady_clock::now();
+
+    // Parse in chunks of about 1 MiB that end at a line break
+    constexpr size_t chunkSize = 1024 * 1024;
+    std::string_view data = file.data();
+    while (!data.empty()) {
+        size_t end = data.size();
+        if (end > chunkSize) {
+            const size_t newline = data.find('\n', chunkSize);
+            end = (newline == std::string_view::npos) ? data.size() : newline + 1;
+        }
+        Ogn::OgnParser::parseAprsisBatch(data.substr(0, end), messages);
+        data.remove_prefix(end);
+        messageCount += messages.size();
+        if (duplicateFilter != nullptr) {
+            messages.erase(std::remove_if(messages.begin(), messages.end(),
+                                          [duplicateFilter](const Ogn::OgnMessageView& message) {
+                                              return duplicateFilter->isDuplicate(message);
+                                          }),
+                           messages.end());
+        }
+
+        // Format the messages between two waits in one go
+        size_t begin = 0;
+        if (pace > 0.0) {
+            for (size_t i = 0; i < messages.size(); ++i) {
+                if (pacer.schedule(messages[i].timestamp)) {
+                    // Do not hold output back while waiting
+                    format(begin, i);
+                    if (!flush(0)) {
+                        return 1;
+                    }
+                    pacer.wait();
+                    begin = i;
+                }
             }
-            return true;
         }
-        
-        // Read more data
-        char chunk[1024];
-        const ssize_t bytes = recv(sock, chunk, sizeof(chunk), 0);
-        if (bytes <= 0) {
-            return false; // Connection closed or error
+        format(begin, messages.size());
+        if (!flush(flushSize)) {
+            return 1;
         }
-        buffer.append(chunk, bytes);
     }
+    if (!flush(0)) {
+        return 1;
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "Replayed " << messageCount << " messages in " << seconds << " s ("
+              << static_cast<double>(messageCount) / std::max(seconds, 1e-9) << " messages/s)" << std::endl;
+    if (duplicateFilter != nullptr) {
+        std::cerr << "Dropped " << duplicateFilter->duplicateCount() << " duplicate traffic reports" << std::endl;
+    }
+    return 0;
 }
 
 void printUsage(const char* progName) {
@@ -100,19 +202,35 @@ void printUsage(const char* progName) {
               << "  -h, --help              Show this help message\n"
               << "  -v, --version           Show version\n"
               << "  --sbs1                  Output in SBS-1 BaseStation format (dump1090-compatible)\n"
+              << "  --output FORMAT[:FILE]  Write FORMAT (ogn or sbs1) to FILE (default: stdout), may be repeated\n"
+              << "  --dedup                 Drop traffic reports already received via another receiver\n"
               << "  -s, --server HOST       OGN APRS-IS server (default: aprs.glidernet.org)\n"
               << "  -p, --port PORT         Server port (default: 14580)\n"
-              << "  --lat LATITUDE          Latitude for position filter (required)\n"
-              << "  --lon LONGITUDE         Longitude for position filter (required)\n"
+              << "  --lat LATITUDE          Latitude for position filter (required unless --replay or --area is given)\n"
+              << "  --lon LONGITUDE         Longitude for position filter (required unless --replay or --area is given)\n"
               << "  --radius KM             Radius for position filter in km (default: 50)\n"
+              << "  --area LAT,LON,KM       Additional login with this position filter, may be repeated\n"
+              << "  --no-reconnect          Exit when the connections close, instead of reconnecting\n"
+              << "  --replay FILE           Read sentences from a capture file instead of the server\n"
+              << "  --pace FACTOR           Replay paced by the timestamps, FACTOR times faster than real time\n"
+              << "                          (default: 0, as fast as possible)\n"
+              << "  --flush-interval MS     Write output at least every MS milliseconds (default: 100, 0: every read)\n"
+              << "  --flush-size BYTES      Write output once BYTES are buffered (default: 65536)\n"
+              << "  --workers N             Number of parse threads (default: 1)\n"
+              << "  --stats                 Print queue statistics when the connection closes\n"
+              << "  --latency SECONDS       Print latency histograms every SECONDS, and when the connection closes\n"
               << "\nExample:\n"
-              << "  " << progName << " --lat 48.3537 --lon 11.7860\n";
+              << "  " << progName << " --lat 48.3537 --lon 11.7860\n"
+              << "  " << progName << " --area 48.35,11.79,100 --area 47.26,11.34,50 --dedup\n"
+              << "  " << progName << " --replay capture.txt --sbs1 --pace 1\n"
+              << "  " << progName << " --lat 48.3537 --lon 11.7860 --output ogn:capture.txt --output sbs1\n";
 }
 
 int main(int argc, char *argv[])
 {
     // Default values
-    bool sbs1Mode = false;
+    std::vector<std::string> outputSpecs;
+    bool dedupMode = false;
     std::string server = "aprs.glidernet.org";
     int port = 14580;
     double latitude = 0.0;
@@ -120,17 +238,37 @@ int main(int argc, char *argv[])
     int radius = 50;
     bool hasLat = false;
     bool hasLon = false;
+    int flushIntervalMs = 100;
+    size_t flushSize = 65536;
+    std::string replayFileName;
+    double pace = 0.0;
+    size_t workers = 1;
+    bool printStats = false;
+    int latencyInterval = 0;
+    std::vector<Area> areas;
+    bool reconnect = true;
 
     // Parse command line
     static struct option long_options[] = {
         {"help",    no_argument,       nullptr, 'h'},
         {"version", no_argument,       nullptr, 'v'},
         {"sbs1",    no_argument,       nullptr, '1'},
+        {"output",  required_argument, nullptr, 'O'},
+        {"dedup",   no_argument,       nullptr, 'd'},
         {"server",  required_argument, nullptr, 's'},
         {"port",    required_argument, nullptr, 'p'},
         {"lat",     required_argument, nullptr, 'a'},
         {"lon",     required_argument, nullptr, 'o'},
         {"radius",  required_argument, nullptr, 'r'},
+        {"flush-interval", required_argument, nullptr, 'i'},
+        {"flush-size", required_argument, nullptr, 'z'},
+        {"replay",  required_argument, nullptr, 'f'},
+        {"pace",    required_argument, nullptr, 'c'},
+        {"workers", required_argument, nullptr, 'w'},
+        {"stats",   no_argument,       nullptr, 't'},
+        {"latency", required_argument, nullptr, 'l'},
+        {"area",    required_argument, nullptr, 'A'},
+        {"no-reconnect", no_argument,  nullptr, 'n'},
         {nullptr, 0, nullptr, 0}
     };
 
@@ -145,7 +283,13 @@ int main(int argc, char *argv[])
                 std::cout << "dumpOGN version 1.0" << std::endl;
                 return 0;
             case '1':
-                sbs1Mode = true;
+                outputSpecs.emplace_back("sbs1");
+                break;
+            case 'O':
+                outputSpecs.emplace_back(optarg);
+                break;
+            case 'd':
+                dedupMode = true;
                 break;
             case 's':
                 server = optarg;
@@ -164,74 +308,124 @@ int main(int argc, char *argv[])
             case 'r':
                 radius = std::stoi(optarg);
                 break;
+            case 'i':
+                flushIntervalMs = std::max(0, std::stoi(optarg));
+                break;
+            case 'z':
+                flushSize = std::stoul(optarg);
+                break;
+            case 'f':
+                replayFileName = optarg;
+                break;
+            case 'c':
+                pace = std::max(0.0, std::stod(optarg));
+                break;
+            case 'w':
+                workers = std::clamp<size_t>(std::stoul(optarg), 1, 64);
+                break;
+            case 't':
+                printStats = true;
+                break;
+            case 'l':
+                latencyInterval = std::max(1, std::stoi(optarg));
+                break;
+            case 'A': {
+                Area area;
+                if (!parseArea(optarg, area)) {
+                    std::cerr << "Error: Invalid area " << optarg << ", expected LAT,LON,KM\n" << std::endl;
+                    printUsage(argv[0]);
+                    return 1;
+                }
+                areas.push_back(area);
+                break;
+            }
+            case 'n':
+                reconnect = false;
+                break;
             default:
                 printUsage(argv[0]);
                 return 1;
         }
     }
 
+    // Create formatters and open output files, raw APRS to stdout by default
+    if (outputSpecs.empty()) {
+        outputSpecs.emplace_back("ogn");
+    }
+    std::vector<Pipeline::Output> outputs(outputSpecs.size());
+    std::vector<int> outputFiles;
+    const auto closeOutputFiles = [&outputFiles]() {
+        for (const int fd : outputFiles) {
+            close(fd);
+        }
+    };
+    for (size_t i = 0; i < outputSpecs.size(); ++i) {
+        if (!openOutput(outputSpecs[i], outputs[i], outputFiles)) {
+            closeOutputFiles();
+            return 1;
+        }
+    }
+    Ogn::OgnDuplicateFilter duplicateFilter;
+
+    if (!replayFileName.empty()) {
+        const int result = replayFile(replayFileName, pace, outputs, dedupMode ? &duplicateFilter : nullptr, flushSize);
+        closeOutputFiles();
+        return result;
+    }
+
     // Validate required options
-    if (!hasLat || !hasLon) {
+    if (hasLat != hasLon || (!hasLat && areas.empty())) {
         std::cerr << "Error: --lat and --lon options are required\n" << std::endl;
         printUsage(argv[0]);
+        closeOutputFiles();
         return 1;
     }
-
-    // Connect to server
-    const int sock = connectToServer(server, port);
-    if (sock < 0) {
-        return 1;
+    if (hasLat) {
+        areas.insert(areas.begin(), Area{latitude, longitude, static_cast<unsigned int>(radius)});
     }
 
-    // Generate random callsign
+    // One login with a random callsign per area
+    AprsClient client(server, port, "dumpOGN", "1.0");
+    client.setReconnect(reconnect);
     std::random_device rd;
     std::mt19937 gen(rd());
     std::uniform_int_distribution<> dis(100000, 999999);
-    const std::string callSign = "DMP" + std::to_string(dis(gen));
-
-    // Send login with filter
-    const std::string loginString = Ogn::OgnParser::formatLoginString(
-        callSign,
-        latitude,
-        longitude,
-        radius,
-        "dumpOGN",
-        "1.0"
-    );
-    
-    if (send(sock, loginString.c_str(), loginString.length(), 0) < 0) {
-        std::cerr << "Error: Could not send login: " << std::strerror(errno) << std::endl;
-        close(sock);
-        return 1;
+    for (const auto& area : areas) {
+        client.addConnection("DMP" + std::to_string(dis(gen)), area.latitude, area.longitude, area.radius);
     }
 
-    std::cerr << "Logged in as " << callSign 
-              << " (filter: " << latitude << "," << longitude 
-              << " radius " << radius << "km)" << std::endl;
-
-    // Create formatter based on mode
-    OgnFormatter ognFormatter;
-    SBS1Formatter sbs1Formatter;
-    OutputFormatter* formatter = sbs1Mode ? static_cast<OutputFormatter*>(&sbs1Formatter) 
-                                          : static_cast<OutputFormatter*>(&ognFormatter);
-
-    // Read and process messages
-    std::string buffer;
-    std::string line;
-    while (readLine(sock, line, buffer)) {
-        // Parse OGN message
-        Ogn::OgnMessage message;
-        message.sentence = line;
-        Ogn::OgnParser::parseAprsisMessage(message);
-        
-        // Format using the configured formatter
-        const std::string output = formatter->format(message);
-        if (!output.empty()) {
-            std::cout << output << std::endl;
+    // Read and process messages. The main thread only receives, on all
+    // connections; parsing, formatting and output run on separate threads.
+    Pipeline pipeline(
+        workers,
+        std::move(outputs),
+        dedupMode,
+        std::chrono::milliseconds(flushIntervalMs),
+        flushSize,
+        latencyInterval > 0 ? Pipeline::LatencyCallback([](const LatencyReport& report) { report.print(std::cerr); })
+                            : Pipeline::LatencyCallback(),
+        std::chrono::seconds(latencyInterval));
+    activeClient = &client;
+    struct sigaction action{};
+    action.sa_handler = handleSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    client.run([&](std::string_view lines, std::chrono::steady_clock::time_point received) {
+        pipeline.submit(lines, received);
+        if (pipeline.failed()) {
+            client.stop();
         }
-    }
+    });
+    activeClient = nullptr;
+    pipeline.finish();
 
-    std::cerr << "Disconnected from server" << std::endl;
-    close(sock);
+    if (dedupMode) {
+        std::cerr << "Dropped " << pipeline.duplicateCount() << " duplicate traffic reports" << std::endl;
+    }
+    if (printStats) {
+        pipeline.printStatistics(std::cerr);
+    }
+    closeOutputFiles();
     return 0;
 }
@@ -0,0 +1,131 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+// Fuzz target of the parser.
+//
+// The input is parsed as a receive buffer with parseAprsisBatch, and every
+// line once more from a heap copy of exactly its size, so that reads past
+// the end of a sentence are caught by AddressSanitizer. Lines are parsed
+// with several field masks and with a pre-filter. The target aborts if a
+// field of a parsed message does not point into its sentence, or if batch
+// and single-line parsing disagree.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "OgnParser.h"
+#include "OgnPreFilter.h"
+
+using namespace Ogn;
+
+namespace {
+
+void check(bool condition)
+{
+    if (!condition) {
+        std::abort();
+    }
+}
+
+// All string fields must be empty or lie within the sentence
+void checkFields(const OgnMessageData& message, std::string_view sentence)
+{
+    auto const inside = [sentence](std::string_view field) {
+        return field.empty() ||
+               (field.data() >= sentence.data() && field.data() + field.size() <= sentence.data() + sentence.size());
+    };
+    for (std::string_view const field : {message.sourceId, message.timestamp, message.aircraftID, message.rotationRate,
+                                         message.signalStrength, message.errorCount, message.frequencyOffset,
+                                         message.squawk, message.flightlevel, message.flightnumber, message.gpsInfo,
+                                         message.address, message.destination, message.receiver, message.version,
+                                         message.platform}) {
+        check(inside(field));
+    }
+}
+
+void parseLine(std::string_view line, const OgnMessageView& fromBatch, const OgnPreFilter& preFilter)
+{
+    // Heap copy without terminating zero
+    auto const copy = std::make_unique<char[]>(line.size());
+    std::copy(line.begin(), line.end(), copy.get());
+    std::string_view const sentence(copy.get(), line.size());
+
+    OgnMessageView message;
+    message.sentence = sentence;
+    OgnParser::parseAprsisMessage(message);
+    checkFields(message, sentence);
+    check(message.type == fromBatch.type);
+    check(message.sourceId == fromBatch.sourceId);
+    check(message.addressValue == fromBatch.addressValue);
+
+    for (uint32_t const fieldMask : {OgnField::TrafficReports | OgnField::Position | OgnField::AircraftID,
+                                     OgnField::WeatherReports | OgnField::Weather,
+                                     OgnField::StatusMessages | OgnField::ReceiverStatus | OgnField::Route,
+                                     OgnField::All & ~OgnField::Position}) {
+        OgnMessageView masked;
+        masked.sentence = sentence;
+        OgnParser::parseAprsisMessage(masked, fieldMask);
+        checkFields(masked, sentence);
+    }
+
+    OgnMessageView filtered;
+    filtered.sentence = sentence;
+    OgnParser::parseAprsisMessage(filtered, preFilter);
+    checkFields(filtered, sentence);
+    check(filtered.type == OgnMessageType::UNKNOWN || filtered.type == message.type);
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size)
+{
+    std::string_view const chunk(reinterpret_cast<const char*>(data), size);
+
+    static const OgnPreFilter preFilter = []() {
+        OgnPreFilter filter;
+        filter.setBoundingBox(40.0, -5.0, 55.0, 20.0);
+        filter.setDeniedAddresses({0xDDE626});
+        filter.setRejectNoTracking(true);
+        return filter;
+    }();
+
+    std::vector<OgnMessageView> messages;
+    OgnParser::parseAprsisBatch(chunk, messages);
+    for (const auto& message : messages) {
+        checkFields(message, message.sentence);
+        parseLine(message.sentence, message, preFilter);
+    }
+
+    std::vector<OgnMessageView> filtered;
+    OgnParser::parseAprsisBatch(chunk, filtered, preFilter);
+    check(filtered.size() <= messages.size());
+
+    // Coordinates at the offsets where the parser expects them
+    if (size >= 8) {
+        (void)OgnParser::decodeLatitude(chunk.substr(0, 7), chunk[7], chunk[size - 1]);
+        (void)OgnParser::decodeLongitude(chunk.substr(0, 8), chunk[7], chunk[size - 1]);
+    }
+    return 0;
+}
@@ -0,0 +1,327 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "OgnColumnBatch.h"
+#include "OgnTrafficRecord.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// File header: magic and format version
+constexpr char FileHeader[8] = {'O', 'G', 'N', 'C', 'O', 'L', '\0', '\1'};
+
+constexpr uint32_t ColumnCount = 11;
+
+// Largest block accepted by the reader, protects against corrupt files
+constexpr uint32_t MaximumRows = 1U << 26;
+
+constexpr char Padding[8] = {};
+
+// Number of zero bytes that pad size bytes to a multiple of 8
+std::size_t paddingSize(std::size_t size)
+{
+    return (8 - (size % 8)) % 8;
+}
+
+template<typename T>
+bool writeColumn(std::FILE* file, const std::vector<T>& column)
+{
+    std::size_t const padding = paddingSize(column.size() * sizeof(T));
+    return std::fwrite(column.data(), sizeof(T), column.size(), file) == column.size()
+           && std::fwrite(Padding, 1, padding, file) == padding;
+}
+
+template<typename T>
+bool readColumn(std::FILE* file, std::vector<T>& column, std::size_t rows)
+{
+    char padding[8];
+    column.resize(rows);
+    std::size_t const paddingBytes = paddingSize(rows * sizeof(T));
+    return std::fread(column.data(), sizeof(T), rows, file) == rows
+           && std::fread(padding, 1, paddingBytes, file) == paddingBytes;
+}
+
+bool writeDictionary(std::FILE* file, const std::vector<std::string>& values)
+{
+    auto const count = static_cast<uint32_t>(values.size());
+    if (std::fwrite(&count, sizeof(count), 1, file) != 1) {
+        return false;
+    }
+    std::size_t size = sizeof(count);
+    for (const auto& value : values) {
+        auto const length = static_cast<uint8_t>(std::min<std::size_t>(value.size(), 255));
+        if (std::fwrite(&length, 1, 1, file) != 1 || std::fwrite(value.data(), 1, length, file) != length) {
+            return false;
+        }
+        size += 1 + length;
+    }
+    std::size_t const padding = paddingSize(size);
+    return std::fwrite(Padding, 1, padding, file) == padding;
+}
+
+bool readDictionary(std::FILE* file, std::vector<std::string>& values)
+{
+    uint32_t count = 0;
+    if (std::fread(&count, sizeof(count), 1, file) != 1 || count > MaximumRows) {
+        return false;
+    }
+    values.resize(count);
+    std::size_t size = sizeof(count);
+    for (auto& value : values) {
+        uint8_t length = 0;
+        if (std::fread(&length, 1, 1, file) != 1) {
+            return false;
+        }
+        value.resize(length);
+        if (std::fread(value.data(), 1, length, file) != length) {
+            return false;
+        }
+        size += 1 + length;
+    }
+    char padding[8];
+    std::size_t const paddingBytes = paddingSize(size);
+    return std::fread(padding, 1, paddingBytes, file) == paddingBytes;
+}
+
+} // namespace
+
+namespace Ogn {
+
+uint32_t OgnColumnBatch::Dictionary::encode(std::string_view value)
+{
+    auto const iterator = index.find(value);
+    if (iterator != index.end()) {
+        return iterator->second;
+    }
+    auto const code = static_cast<uint32_t>(values.size());
+    values.emplace_back(value);
+    index.emplace(value, code);
+    return code;
+}
+
+void OgnColumnBatch::Dictionary::clear()
+{
+    values.clear();
+    index.clear();
+}
+
+bool OgnColumnBatch::append(const OgnMessageData& message)
+{
+    if (message.type != OgnMessageType::TRAFFIC_REPORT) {
+        return false;
+    }
+    if (std::isnan(message.latitude) || std::isnan(message.longitude)) {
+        return false;
+    }
+
+    m_address.push_back(message.addressValue == OgnMessageData::InvalidAddress ? 0 : message.addressValue);
+    m_time.push_back(OgnTrafficRecord::decodeTimestamp(message.timestamp));
+    m_latitude.push_back(message.latitude);
+    m_longitude.push_back(message.longitude);
+    m_altitude.push_back(message.altitude);
+    m_speed.push_back(message.speed);
+    m_course.push_back(message.course);
+    m_climbRate.push_back(message.verticalSpeed);
+    m_aircraftType.push_back(static_cast<uint8_t>(message.aircraftType));
+    m_sourceId.push_back(m_sourceIds.encode(message.sourceId));
+    m_flightNumber.push_back(message.flightnumber.empty() ? NoString : m_flightNumbers.encode(message.flightnumber));
+    return true;
+}
+
+void OgnColumnBatch::clear()
+{
+    m_address.clear();
+    m_time.clear();
+    m_latitude.clear();
+    m_longitude.clear();
+    m_altitude.clear();
+    m_speed.clear();
+    m_course.clear();
+    m_climbRate.clear();
+    m_aircraftType.clear();
+    m_sourceId.clear();
+    m_flightNumber.clear();
+    m_sourceIds.clear();
+    m_flightNumbers.clear();
+}
+
+void OgnColumnBatch::reserve(std::size_t rows)
+{
+    m_address.reserve(rows);
+    m_time.reserve(rows);
+    m_latitude.reserve(rows);
+    m_longitude.reserve(rows);
+    m_altitude.reserve(rows);
+    m_speed.reserve(rows);
+    m_course.reserve(rows);
+    m_climbRate.reserve(rows);
+    m_aircraftType.reserve(rows);
+    m_sourceId.reserve(rows);
+    m_flightNumber.reserve(rows);
+}
+
+bool OgnColumnFileWriter::open(const std::string& fileName)
+{
+    close();
+
+    m_file = std::fopen(fileName.c_str(), "a+b");
+    if (m_file == nullptr) {
+        return false;
+    }
+
+    // Write header to new files, check header of existing files
+    std::fseek(m_file, 0, SEEK_END);
+    if (std::ftell(m_file) == 0) {
+        if (std::fwrite(FileHeader, sizeof(FileHeader), 1, m_file) != 1) {
+            close();
+            return false;
+        }
+        return true;
+    }
+    char header[sizeof(FileHeader)];
+    std::rewind(m_file);
+    if (std::fread(header, sizeof(header), 1, m_file) != 1 || std::memcmp(header, FileHeader, sizeof(header)) != 0) {
+        close();
+        return false;
+    }
+    // Switching from reading to writing requires a positioning call
+    std::fseek(m_file, 0, SEEK_END);
+    return true;
+}
+
+bool OgnColumnFileWriter::write(const OgnColumnBatch& batch)
+{
+    if (m_file == nullptr) {
+        return false;
+    }
+    if (batch.empty()) {
+        return true;
+    }
+
+    uint32_t const counts[2] = {static_cast<uint32_t>(batch.size()), ColumnCount};
+    return std::fwrite(counts, sizeof(counts), 1, m_file) == 1
+           && writeColumn(m_file, batch.m_address)
+           && writeColumn(m_file, batch.m_time)
+           && writeColumn(m_file, batch.m_latitude)
+           && writeColumn(m_file, batch.m_longitude)
+           && writeColumn(m_file, batch.m_altitude)
+           && writeColumn(m_file, batch.m_speed)
+           && writeColumn(m_file, batch.m_course)
+           && writeColumn(m_file, batch.m_climbRate)
+           && writeColumn(m_file, batch.m_aircraftType)
+           && writeColumn(m_file, batch.m_sourceId)
+           && writeColumn(m_file, batch.m_flightNumber)
+           && writeDictionary(m_file, batch.m_sourceIds.values)
+           && writeDictionary(m_file, batch.m_flightNumbers.values);
+}
+
+bool OgnColumnFileWriter::flush()
+{
+    return (m_file != nullptr) && (std::fflush(m_file) == 0);
+}
+
+void OgnColumnFileWriter::close()
+{
+    if (m_file != nullptr) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+bool OgnColumnFileReader::open(const std::string& fileName)
+{
+    close();
+
+    m_file = std::fopen(fileName.c_str(), "rb");
+    if (m_file == nullptr) {
+        return false;
+    }
+    char header[sizeof(FileHeader)];
+    if (std::fread(header, sizeof(header), 1, m_file) != 1 || std::memcmp(header, FileHeader, sizeof(header)) != 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool OgnColumnFileReader::read(OgnColumnBatch& batch)
+{
+    batch.clear();
+    if (m_file == nullptr) {
+        return false;
+    }
+
+    uint32_t counts[2] = {};
+    if (std::fread(counts, sizeof(counts), 1, m_file) != 1 || counts[0] > MaximumRows || counts[1] != ColumnCount) {
+        return false;
+    }
+    std::size_t const rows = counts[0];
+    bool const success = readColumn(m_file, batch.m_address, rows)
+                         && readColumn(m_file, batch.m_time, rows)
+                         && readColumn(m_file, batch.m_latitude, rows)
+                         && readColumn(m_file, batch.m_longitude, rows)
+                         && readColumn(m_file, batch.m_altitude, rows)
+                         && readColumn(m_file, batch.m_speed, rows)
+                         && readColumn(m_file, batch.m_course, rows)
+                         && readColumn(m_file, batch.m_climbRate, rows)
+                         && readColumn(m_file, batch.m_aircraftType, rows)
+                         && readColumn(m_file, batch.m_sourceId, rows)
+                         && readColumn(m_file, batch.m_flightNumber, rows)
+                         && readDictionary(m_file, batch.m_sourceIds.values)
+                         && readDictionary(m_file, batch.m_flightNumbers.values);
+    if (!success) {
+        batch.clear();
+        return false;
+    }
+
+    // Rebuild the indices, so that the batch can be appended to
+    auto const rebuild = [](OgnColumnBatch::Dictionary& dictionary) {
+        for (std::size_t i = 0; i < dictionary.values.size(); ++i) {
+            dictionary.index.emplace(dictionary.values[i], static_cast<uint32_t>(i));
+        }
+    };
+    rebuild(batch.m_sourceIds);
+    rebuild(batch.m_flightNumbers);
+
+    // Reject indices outside of the dictionaries
+    auto const sourceIdCount = static_cast<uint32_t>(batch.m_sourceIds.values.size());
+    auto const flightNumberCount = static_cast<uint32_t>(batch.m_flightNumbers.values.size());
+    for (std::size_t row = 0; row < rows; ++row) {
+        if (batch.m_sourceId[row] >= sourceIdCount
+            || (batch.m_flightNumber[row] != OgnColumnBatch::NoString && batch.m_flightNumber[row] >= flightNumberCount)) {
+            batch.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+void OgnColumnFileReader::close()
+{
+    if (m_file != nullptr) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+} // namespace Ogn
@@ -0,0 +1,194 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "OgnParser.h"
+
+namespace Ogn {
+
+/*! \brief Traffic reports stored column by column
+ *
+ *  The batch appends the numeric content of parsed traffic reports to one
+ *  vector per field, so that analysis tools can load many reports at once
+ *  instead of converting messages one by one. Source IDs and flight
+ *  numbers are dictionary-encoded: their columns hold indices into
+ *  sourceIds() and flightNumbers().
+ *
+ *  Values that are unknown are stored as NaN, as in OgnMessageData, or as
+ *  the respective "invalid" constant.
+ */
+class OgnColumnBatch
+{
+public:
+    static constexpr uint32_t InvalidTimestamp = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t NoString = std::numeric_limits<uint32_t>::max();
+
+    /*! \brief Append a parsed traffic report
+     *
+     *  \return False if the message is not a traffic report with valid
+     *  position. In that case, the batch is left unchanged.
+     */
+    bool append(const OgnMessageData& message);
+
+    //! Remove all rows and dictionary entries, keeping the capacity
+    void clear();
+
+    //! Reserve memory for the given number of rows
+    void reserve(std::size_t rows);
+
+    //! Number of rows
+    [[nodiscard]] std::size_t size() const { return m_address.size(); }
+    [[nodiscard]] bool empty() const { return m_address.empty(); }
+
+    [[nodiscard]] const std::vector<uint32_t>& address() const { return m_address; }           // 24-bit address
+    [[nodiscard]] const std::vector<uint32_t>& time() const { return m_time; }                 // seconds of day (UTC), or InvalidTimestamp
+    [[nodiscard]] const std::vector<double>& latitude() const { return m_latitude; }           // degrees (WGS84)
+    [[nodiscard]] const std::vector<double>& longitude() const { return m_longitude; }         // degrees (WGS84)
+    [[nodiscard]] const std::vector<double>& altitude() const { return m_altitude; }           // meters (MSL)
+    [[nodiscard]] const std::vector<double>& speed() const { return m_speed; }                 // knots
+    [[nodiscard]] const std::vector<double>& course() const { return m_course; }               // degrees
+    [[nodiscard]] const std::vector<double>& climbRate() const { return m_climbRate; }         // m/s
+    [[nodiscard]] const std::vector<uint8_t>& aircraftType() const { return m_aircraftType; }  // OgnAircraftType
+    [[nodiscard]] const std::vector<uint32_t>& sourceId() const { return m_sourceId; }         // index into sourceIds()
+    [[nodiscard]] const std::vector<uint32_t>& flightNumber() const { return m_flightNumber; } // index into flightNumbers(), or NoString
+
+    //! Dictionaries, in order of first appearance
+    [[nodiscard]] const std::vector<std::string>& sourceIds() const { return m_sourceIds.values; }
+    [[nodiscard]] const std::vector<std::string>& flightNumbers() const { return m_flightNumbers.values; }
+
+private:
+    friend class OgnColumnFileWriter;
+    friend class OgnColumnFileReader;
+
+    struct Dictionary
+    {
+        std::vector<std::string> values;
+        std::map<std::string, uint32_t, std::less<>> index;
+
+        uint32_t encode(std::string_view value);
+        void clear();
+    };
+
+    std::vector<uint32_t> m_address;
+    std::vector<uint32_t> m_time;
+    std::vector<double> m_latitude;
+    std::vector<double> m_longitude;
+    std::vector<double> m_altitude;
+    std::vector<double> m_speed;
+    std::vector<double> m_course;
+    std::vector<double> m_climbRate;
+    std::vector<uint8_t> m_aircraftType;
+    std::vector<uint32_t> m_sourceId;
+    std::vector<uint32_t> m_flightNumber;
+    Dictionary m_sourceIds;
+    Dictionary m_flightNumbers;
+};
+
+/*! \brief Append-only writer for files of OgnColumnBatch
+ *
+ *  A file starts with an 8-byte header that identifies the format,
+ *  followed by one block per batch written. A block consists of
+ *
+ *  - the number of rows n (uint32) and the number of columns, 11 (uint32),
+ *  - the columns address, time (uint32), latitude, longitude, altitude,
+ *    speed, course, climbRate (float64), aircraftType (uint8), sourceId
+ *    and flightNumber (uint32), n values each,
+ *  - the dictionaries of source IDs and flight numbers, each as the number
+ *    of entries (uint32) followed by the entries as length (uint8) and
+ *    bytes.
+ *
+ *  All numbers are in native byte order (little endian on all supported
+ *  platforms). Every column and dictionary is padded with zeros to a
+ *  multiple of 8 bytes, so that columns are aligned when the file is
+ *  mapped into memory, e.g. with numpy.memmap. Dictionary indices refer to
+ *  the dictionaries of the same block. Entries longer than 255 bytes are
+ *  truncated.
+ */
+class OgnColumnFileWriter
+{
+public:
+    OgnColumnFileWriter() = default;
+    OgnColumnFileWriter(const OgnColumnFileWriter&) = delete;
+    OgnColumnFileWriter& operator=(const OgnColumnFileWriter&) = delete;
+    ~OgnColumnFileWriter() { close(); }
+
+    /*! \brief Open file for appending, creating it if necessary
+     *
+     *  \return False if the file cannot be opened or is not a column file
+     */
+    bool open(const std::string& fileName);
+
+    /*! \brief Append the batch as one block
+     *
+     *  Empty batches are not written.
+     *
+     *  \return False on write error
+     */
+    bool write(const OgnColumnBatch& batch);
+
+    // Flush buffered blocks to the file
+    bool flush();
+
+    void close();
+
+private:
+    std::FILE* m_file = nullptr;
+};
+
+/*! \brief Sequential reader for files written by OgnColumnFileWriter */
+class OgnColumnFileReader
+{
+public:
+    OgnColumnFileReader() = default;
+    OgnColumnFileReader(const OgnColumnFileReader&) = delete;
+    OgnColumnFileReader& operator=(const OgnColumnFileReader&) = delete;
+    ~OgnColumnFileReader() { close(); }
+
+    /*! \brief Open file for reading
+     *
+     *  \return False if the file cannot be opened or is not a column file
+     */
+    bool open(const std::string& fileName);
+
+    /*! \brief Read the next block
+     *
+     *  \param batch Batch that receives the block, replacing its content
+     *  \return False at end of file or on error
+     */
+    bool read(OgnColumnBatch& batch);
+
+    void close();
+
+private:
+    std::FILE* m_file = nullptr;
+};
+
+} // namespace Ogn
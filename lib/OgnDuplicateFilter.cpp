@@ -0,0 +1,104 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "OgnDuplicateFilter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+
+namespace {
+
+// FNV-1a
+constexpr uint64_t FnvOffset = 0xCBF29CE484222325ULL;
+constexpr uint64_t FnvPrime = 0x100000001B3ULL;
+
+uint64_t hashBytes(uint64_t hash, std::string_view bytes)
+{
+    for (char const byte : bytes) {
+        hash ^= static_cast<unsigned char>(byte);
+        hash *= FnvPrime;
+    }
+    return hash;
+}
+
+uint64_t hashValue(uint64_t hash, int64_t value)
+{
+    for (int i = 0; i < 8; ++i) {
+        hash ^= static_cast<uint64_t>(value >> (8 * i)) & 0xFF;
+        hash *= FnvPrime;
+    }
+    return hash;
+}
+
+} // namespace
+
+namespace Ogn {
+
+OgnDuplicateFilter::OgnDuplicateFilter(std::size_t capacity)
+{
+    std::size_t sets = 1;
+    while (sets * Ways < capacity) {
+        sets *= 2;
+    }
+    m_fingerprints.assign(sets * Ways, 0);
+    m_nextVictim.assign(sets, 0);
+    m_setMask = sets - 1;
+}
+
+bool OgnDuplicateFilter::isDuplicate(const OgnMessageData& message)
+{
+    if (message.type != OgnMessageType::TRAFFIC_REPORT) {
+        return false;
+    }
+
+    // Fingerprint of address, timestamp and position. The position enters
+    // in micro-degrees, so that equal sentences give equal fingerprints.
+    uint64_t fingerprint = FnvOffset;
+    if (message.addressValue != OgnMessageData::InvalidAddress) {
+        fingerprint = hashValue(fingerprint, message.addressValue);
+    } else {
+        fingerprint = hashBytes(fingerprint, message.sourceId);
+    }
+    fingerprint = hashBytes(fingerprint, message.timestamp);
+    fingerprint = hashValue(fingerprint, std::isnan(message.latitude) ? 0 : std::llround(message.latitude * 1e6));
+    fingerprint = hashValue(fingerprint, std::isnan(message.longitude) ? 0 : std::llround(message.longitude * 1e6));
+    fingerprint = std::max<uint64_t>(fingerprint, 1);
+
+    std::size_t const set = (fingerprint >> 32) & m_setMask;
+    uint64_t* const entries = m_fingerprints.data() + set * Ways;
+    if (std::find(entries, entries + Ways, fingerprint) != entries + Ways) {
+        m_duplicateCount++;
+        return true;
+    }
+
+    entries[m_nextVictim[set]] = fingerprint;
+    m_nextVictim[set] = static_cast<uint8_t>((m_nextVictim[set] + 1) % Ways);
+    return false;
+}
+
+void OgnDuplicateFilter::clear()
+{
+    std::fill(m_fingerprints.begin(), m_fingerprints.end(), 0);
+    std::fill(m_nextVictim.begin(), m_nextVictim.end(), 0);
+    m_duplicateCount = 0;
+}
+
+} // namespace Ogn
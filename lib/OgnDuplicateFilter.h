@@ -0,0 +1,75 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "OgnParser.h"
+
+namespace Ogn {
+
+/*! \brief Detect traffic reports that arrive more than once
+ *
+ *  APRS-IS delivers the same FLARM packet several times when several
+ *  receivers pick it up, differing only in the receiver named in the
+ *  header. This filter recognizes such repeats by a fingerprint of address,
+ *  timestamp and position.
+ *
+ *  Fingerprints are kept in a fixed-size, four-way set-associative table.
+ *  When a set is full, the oldest entry of the set is replaced, so memory
+ *  use is constant and old fingerprints are eventually forgotten.
+ *
+ *  The filter is not thread-safe.
+ */
+class OgnDuplicateFilter
+{
+public:
+    /*! \brief Create filter
+     *
+     *  \param capacity Number of fingerprints remembered, rounded up to a power of two
+     */
+    explicit OgnDuplicateFilter(std::size_t capacity = 4096);
+
+    /*! \brief Check message and remember it
+     *
+     *  Messages other than traffic reports are never duplicates.
+     *
+     *  \return True if the same traffic report has been seen before
+     */
+    bool isDuplicate(const OgnMessageData& message);
+
+    //! Number of duplicates detected since construction or the last clear()
+    [[nodiscard]] std::size_t duplicateCount() const { return m_duplicateCount; }
+
+    void clear();
+
+private:
+    static constexpr std::size_t Ways = 4;
+
+    std::vector<uint64_t> m_fingerprints; // 0 marks an empty entry
+    std::vector<uint8_t> m_nextVictim;    // per set, entry to replace next
+    std::size_t m_setMask = 0;
+    std::size_t m_duplicateCount = 0;
+};
+
+} // namespace Ogn
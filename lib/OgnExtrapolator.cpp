@@ -0,0 +1,161 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "OgnExtrapolator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define OGN_RESTRICT __restrict__
+#elif defined(_MSC_VER)
+#define OGN_RESTRICT __restrict
+#else
+#define OGN_RESTRICT
+#endif
+
+namespace {
+
+constexpr double Pi = 3.14159265358979323846;
+constexpr double DegreesToRadians = Pi / 180.0;
+constexpr double RadiansToDegrees = 180.0 / Pi;
+constexpr double KnotsToMetersPerSecond = 1852.0 / 3600.0;
+constexpr double EarthRadiusMeters = 6371008.8;
+
+// Adding and subtracting this constant rounds doubles below 2^51 to the
+// nearest integer. Unlike std::nearbyint, this vectorizes on plain SSE2.
+constexpr double RoundingConstant = 6755399441055744.0; // 1.5 * 2^52
+
+inline double roundToInteger(double x)
+{
+    return (x + RoundingConstant) - RoundingConstant;
+}
+
+/* Sine and cosine of x, for |x| up to a few thousand radians
+ *
+ * Reduces x to [-pi/4, pi/4] and evaluates Taylor polynomials, with an
+ * absolute error below 1e-13. Written without branches and calls, so that
+ * loops using it can be vectorized, which is not the case for std::sin
+ * and std::cos.
+ */
+inline void sinCos(double x, double& sine, double& cosine)
+{
+    // x = quadrant * pi/2 + r, with the quadrant split into two parts so
+    // that r is exact
+    constexpr double PiHalfHigh = 1.57079632673412561417;
+    constexpr double PiHalfLow = 6.07710050650619224932e-11;
+    double const quadrant = roundToInteger(x * (2.0 / Pi));
+    double const r = (x - quadrant * PiHalfHigh) - quadrant * PiHalfLow;
+    double const r2 = r * r;
+
+    double const s = r * (1.0 + r2 * (-1.0 / 6 + r2 * (1.0 / 120 + r2 * (-1.0 / 5040 + r2 * (1.0 / 362880 + r2 * (-1.0 / 39916800 + r2 * (1.0 / 6227020800)))))));
+    double const c = 1.0 + r2 * (-1.0 / 2 + r2 * (1.0 / 24 + r2 * (-1.0 / 720 + r2 * (1.0 / 40320 + r2 * (-1.0 / 3628800 + r2 * (1.0 / 479001600 + r2 * (-1.0 / 87178291200)))))));
+
+    // Quadrant modulo 4, as a double
+    double const q = quadrant - 4.0 * roundToInteger(quadrant * 0.25 - 0.375);
+    bool const odd = (q == 1.0) | (q == 3.0);
+    double const sineBase = odd ? c : s;
+    double const cosineBase = odd ? s : c;
+    sine = (q >= 2.0) ? -sineBase : sineBase;
+    cosine = ((q == 1.0) | (q == 2.0)) ? -cosineBase : cosineBase;
+}
+
+// Value modulo period, in [0, period). Rounding errors near multiples of
+// the period are clamped.
+inline double wrap(double value, double period)
+{
+    double const result = value - period * roundToInteger(value / period - 0.5);
+    return std::min(std::max(result, 0.0), period * (1.0 - 0x1p-52));
+}
+
+/* Extrapolate count aircraft to time
+ *
+ * The columns are restrict-qualified parameters, which tells the compiler
+ * that they do not overlap, so that the loop is vectorized without
+ * run-time alias checks.
+ */
+void extrapolate(std::size_t count, double time, double horizon,
+                 const double* OGN_RESTRICT latitudes, const double* OGN_RESTRICT longitudes,
+                 const double* OGN_RESTRICT altitudes, const double* OGN_RESTRICT courses,
+                 const double* OGN_RESTRICT speeds, const double* OGN_RESTRICT verticalSpeeds,
+                 const double* OGN_RESTRICT turnRates, const double* OGN_RESTRICT lastSeen,
+                 double* OGN_RESTRICT latitudeOut, double* OGN_RESTRICT longitudeOut,
+                 double* OGN_RESTRICT altitudeOut, double* OGN_RESTRICT courseOut)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        double const dt = std::min(std::max(time - lastSeen[i], 0.0), horizon);
+        double const distance = speeds[i] * KnotsToMetersPerSecond * dt;
+
+        // Integrate the direction of flight, (cos, sin) of the course,
+        // over the turn angle. With turn angle a and course c, the distance
+        // north is distance * (cos c * sin(a)/a - sin c * (1 - cos a)/a).
+        // A turn angle of zero is replaced by a tiny one, so that the loop
+        // needs no branch; at 1e-6 radians, the error is below a millimeter
+        // per kilometer.
+        double const turn = turnRates[i] * DegreesToRadians * dt;
+        double const angle = std::copysign(std::max(std::fabs(turn), 1e-6), turn);
+        double sinCourse = 0.0;
+        double cosCourse = 0.0;
+        double sinAngle = 0.0;
+        double cosAngle = 0.0;
+        sinCos(courses[i] * DegreesToRadians, sinCourse, cosCourse);
+        sinCos(angle, sinAngle, cosAngle);
+        double const along = sinAngle / angle;
+        double const across = (1.0 - cosAngle) / angle;
+        double const north = distance * (cosCourse * along - sinCourse * across);
+        double const east = distance * (sinCourse * along + cosCourse * across);
+
+        double sinLatitude = 0.0;
+        double cosLatitude = 0.0;
+        sinCos(latitudes[i] * DegreesToRadians, sinLatitude, cosLatitude);
+        double const latitude = latitudes[i] + north * (RadiansToDegrees / EarthRadiusMeters);
+        double const longitude = longitudes[i] + east * (RadiansToDegrees / EarthRadiusMeters) / std::max(cosLatitude, 1e-6);
+
+        latitudeOut[i] = std::min(std::max(latitude, -90.0), 90.0);
+        longitudeOut[i] = wrap(longitude + 180.0, 360.0) - 180.0;
+        altitudeOut[i] = altitudes[i] + verticalSpeeds[i] * dt;
+        courseOut[i] = wrap(courses[i] + turnRates[i] * dt, 360.0);
+    }
+}
+
+} // namespace
+
+namespace Ogn {
+
+OgnExtrapolator::OgnExtrapolator(double horizon)
+    : m_horizon(std::max(horizon, 0.0))
+{
+}
+
+void OgnExtrapolator::predict(const OgnTrafficTable& table, double time)
+{
+    std::size_t const count = table.size();
+    m_latitude.resize(count);
+    m_longitude.resize(count);
+    m_altitude.resize(count);
+    m_course.resize(count);
+
+    extrapolate(count, time, m_horizon,
+                table.latitudes(), table.longitudes(), table.altitudes(), table.courses(),
+                table.speeds(), table.verticalSpeeds(), table.turnRates(), table.lastSeen(),
+                m_latitude.data(), m_longitude.data(), m_altitude.data(), m_course.data());
+}
+
+} // namespace Ogn
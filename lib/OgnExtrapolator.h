@@ -0,0 +1,84 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "OgnTrafficTable.h"
+
+namespace Ogn {
+
+/*! \brief Dead reckoning of all aircraft in an OgnTrafficTable
+ *
+ *  OGN reports arrive every few seconds per aircraft. The extrapolator
+ *  predicts the positions of all aircraft of a table at one common time,
+ *  so that displays can move targets smoothly between reports. Aircraft
+ *  fly at constant speed, vertical speed and turn rate: along a straight
+ *  line if the turn rate is zero, and along a circular arc otherwise. The
+ *  earth is treated as locally flat, which is accurate over the distances
+ *  covered between two reports.
+ *
+ *  predict() runs over the columns of the table in one pass without
+ *  branches or calls, so that the compiler can vectorize it.
+ *
+ *  The results are columns that are parallel to those of the table, and
+ *  remain valid until the next call to predict(). Memory is allocated only
+ *  when the table has grown.
+ */
+class OgnExtrapolator
+{
+public:
+    /*! \brief Create extrapolator
+     *
+     *  \param horizon Aircraft are extrapolated at most this many seconds
+     *  beyond the time they were last seen, and stay there afterwards
+     */
+    explicit OgnExtrapolator(double horizon = 20.0);
+
+    /*! \brief Predict the state of all aircraft at the given time
+     *
+     *  Aircraft last seen after time are reported at their last position.
+     *
+     *  \param table Traffic table
+     *  \param time Time in seconds, on the clock used for table
+     */
+    void predict(const OgnTrafficTable& table, double time);
+
+    //! Number of aircraft of the latest prediction
+    [[nodiscard]] std::size_t size() const { return m_latitude.size(); }
+
+    // Column access, each array has size() elements, index as in the table
+    [[nodiscard]] const double* latitudes() const { return m_latitude.data(); }   // degrees (WGS84)
+    [[nodiscard]] const double* longitudes() const { return m_longitude.data(); } // degrees (WGS84), -180 to 180
+    [[nodiscard]] const double* altitudes() const { return m_altitude.data(); }   // meters (MSL), NaN if unknown
+    [[nodiscard]] const double* courses() const { return m_course.data(); }       // degrees, 0 to 360
+
+private:
+    double m_horizon;
+
+    std::vector<double> m_latitude;
+    std::vector<double> m_longitude;
+    std::vector<double> m_altitude;
+    std::vector<double> m_course;
+};
+
+} // namespace Ogn
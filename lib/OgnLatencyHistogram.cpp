@@ -0,0 +1,113 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "OgnLatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Ogn {
+
+std::size_t OgnLatencyHistogram::bucketIndex(uint64_t value)
+{
+    if (value < (uint64_t{2} << SubBucketBits)) {
+        return static_cast<std::size_t>(value);
+    }
+    // Keep the SubBucketBits + 1 most significant bits
+#if defined(__GNUC__) || defined(__clang__)
+    auto const mostSignificantBit = static_cast<unsigned int>(63 - __builtin_clzll(value));
+#else
+    unsigned int mostSignificantBit = 63;
+    while ((value >> mostSignificantBit) == 0) {
+        --mostSignificantBit;
+    }
+#endif
+    unsigned int const shift = mostSignificantBit - SubBucketBits;
+    return (static_cast<std::size_t>(shift) << SubBucketBits) + static_cast<std::size_t>(value >> shift);
+}
+
+uint64_t OgnLatencyHistogram::highestValueOfBucket(std::size_t index)
+{
+    if (index < (std::size_t{2} << SubBucketBits)) {
+        return index;
+    }
+    auto const shift = static_cast<unsigned int>((index >> SubBucketBits) - 1);
+    uint64_t const mantissa = index - (static_cast<std::size_t>(shift) << SubBucketBits);
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void OgnLatencyHistogram::record(uint64_t value, uint64_t count)
+{
+    if (count == 0) {
+        return;
+    }
+    value = std::min(value, HighestValue);
+    m_buckets[bucketIndex(value)] += count;
+    m_count += count;
+    m_minimum = std::min(m_minimum, value);
+    m_maximum = std::max(m_maximum, value);
+    m_sum += static_cast<double>(value) * static_cast<double>(count);
+}
+
+void OgnLatencyHistogram::merge(const OgnLatencyHistogram& other)
+{
+    for (std::size_t i = 0; i < BucketCount; ++i) {
+        m_buckets[i] += other.m_buckets[i];
+    }
+    m_count += other.m_count;
+    m_minimum = std::min(m_minimum, other.m_minimum);
+    m_maximum = std::max(m_maximum, other.m_maximum);
+    m_sum += other.m_sum;
+}
+
+void OgnLatencyHistogram::reset()
+{
+    m_buckets.fill(0);
+    m_count = 0;
+    m_minimum = HighestValue;
+    m_maximum = 0;
+    m_sum = 0.0;
+}
+
+double OgnLatencyHistogram::mean() const
+{
+    return m_count == 0 ? 0.0 : m_sum / static_cast<double>(m_count);
+}
+
+uint64_t OgnLatencyHistogram::valueAtPercentile(double percentile) const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+    // Number of values at or below the result, at least one
+    double const fraction = std::clamp(percentile, 0.0, 100.0) / 100.0;
+    auto const rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(m_count))));
+
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < BucketCount; ++i) {
+        seen += m_buckets[i];
+        if (seen >= rank) {
+            return std::clamp(highestValueOfBucket(i), minimum(), m_maximum);
+        }
+    }
+    return m_maximum;
+}
+
+} // namespace Ogn
@@ -0,0 +1,87 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Ogn {
+
+/*! \brief Histogram of latencies with constant relative precision
+ *
+ *  Values are non-negative integers, typically microseconds. As with
+ *  HdrHistogram, values below 128 are counted exactly, and every larger
+ *  power of two is split into 64 buckets of equal width, so that every
+ *  reported value is within 1.6 percent of a recorded one. Values of
+ *  2^40 and above are counted as 2^40 - 1.
+ *
+ *  Recording is a few instructions and never allocates, as the buckets
+ *  are a fixed-size array of about 18 kB. The histogram is not
+ *  thread-safe; threads keep histograms of their own and merge them.
+ */
+class OgnLatencyHistogram
+{
+public:
+    //! Largest value that is counted without clamping
+    static constexpr uint64_t HighestValue = (uint64_t{1} << 40) - 1;
+
+    //! Count value, count times
+    void record(uint64_t value, uint64_t count = 1);
+
+    //! Add the counts of another histogram
+    void merge(const OgnLatencyHistogram& other);
+
+    void reset();
+
+    //! Number of recorded values
+    [[nodiscard]] uint64_t count() const { return m_count; }
+
+    //! Smallest and largest recorded value, 0 if the histogram is empty
+    [[nodiscard]] uint64_t minimum() const { return m_count == 0 ? 0 : m_minimum; }
+    [[nodiscard]] uint64_t maximum() const { return m_maximum; }
+
+    //! Mean of the recorded values, 0 if the histogram is empty
+    [[nodiscard]] double mean() const;
+
+    /*! \brief Value below or at which the given percentage of values lie
+     *
+     *  \param percentile Percentage between 0 and 100
+     *  \return Highest value of the bucket that contains the percentile,
+     *  but at most maximum(). Returns 0 if the histogram is empty.
+     */
+    [[nodiscard]] uint64_t valueAtPercentile(double percentile) const;
+
+private:
+    static constexpr unsigned int SubBucketBits = 6;
+    static constexpr std::size_t BucketCount = (40 - SubBucketBits + 1) << SubBucketBits;
+
+    static std::size_t bucketIndex(uint64_t value);
+    static uint64_t highestValueOfBucket(std::size_t index);
+
+    std::array<uint64_t, BucketCount> m_buckets{};
+    uint64_t m_count = 0;
+    uint64_t m_minimum = HighestValue;
+    uint64_t m_maximum = 0;
+    double m_sum = 0.0;
+};
+
+} // namespace Ogn
@@ -19,22 +19,18 @@
  ***************************************************************************/
 
 #include "OgnParser.h"
+#include "OgnPreFilter.h"
+#include "OgnTokenizer.h"
 
 #include <algorithm>
+#include <array>
 #include <cstdint>
 #include <cmath>
 #include <ctime>
 #include <charconv>
-#include <iomanip>
-#include <sstream>
-#include <unordered_map>
-#include <map>
+#include <cstring>
 #include <cassert>
 
-#if defined(__APPLE__) || defined(__ANDROID__)
-#include <xlocale.h>
-#endif
-
 #define OGNPARSER_DEBUG 0
 
 namespace {
@@ -44,52 +40,316 @@ inline bool starts_with(std::string_view sv, std::string_view prefix) {
     return sv.size() >= prefix.size() && sv.substr(0, prefix.size()) == prefix;
 }
 
-inline bool ends_with(std::string_view sv, std::string_view suffix) {
-    return sv.size() >= suffix.size() && sv.substr(sv.size() - suffix.size()) == suffix;
+// Value of a decimal digit. Characters other than '0'..'9' give values larger than 9.
+inline unsigned int digitValue(char character)
+{
+    return static_cast<unsigned char>(character) - static_cast<unsigned int>('0');
 }
 
-// see http://wiki.glidernet.org/wiki:ogn-flavoured-aprs
-static const std::unordered_map<std::string, Ogn::OgnAircraftType> AircraftTypeMap = {
-    {"/z",  Ogn::OgnAircraftType::unknown},         // Unknown
-    {"/'",  Ogn::OgnAircraftType::Glider},          // Glider
-    {"/X",  Ogn::OgnAircraftType::Copter},          // Helicopter
-    {"/g",  Ogn::OgnAircraftType::Paraglider},      // Parachute, Hang Glider, Paraglider
-    {"\\^", Ogn::OgnAircraftType::Aircraft},        // Drop Plane, Powered Aircraft
-    {"/^",  Ogn::OgnAircraftType::Jet},             // Jet Aircraft
-    {"/O",  Ogn::OgnAircraftType::Balloon},         // Balloon, Airship
-    {"\\n", Ogn::OgnAircraftType::StaticObstacle},  // Static Object
+// Value of a precision enhancement digit as in "!W91!", 0 if absent or invalid
+inline unsigned int enhancementValue(char enhancement)
+{
+    unsigned int const value = digitValue(enhancement);
+    return value <= 9 ? value : 0;
+}
+
+// Decimal number like "-2.0" or "951.4", NaN if the text is not a number.
+// Works on integers only, so that results are identical on all platforms.
+double parseDecimal(std::string_view text)
+{
+    bool negative = false;
+    if (!text.empty() && (text[0] == '+' || text[0] == '-')) {
+        negative = (text[0] == '-');
+        text.remove_prefix(1);
+    }
+    uint64_t mantissa = 0;
+    int decimals = -1; // -1 before the decimal point
+    std::size_t digits = 0;
+    for (char const character : text) {
+        if (character == '.' && decimals < 0) {
+            decimals = 0;
+            continue;
+        }
+        unsigned int const value = digitValue(character);
+        if (value > 9 || digits == 15) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        mantissa = mantissa * 10 + value;
+        digits++;
+        if (decimals >= 0) {
+            decimals++;
+        }
+    }
+    if (digits == 0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    constexpr double powersOfTen[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+    // Both are exact, so the quotient is correctly rounded
+    double const result = static_cast<double>(mantissa) / powersOfTen[std::max(decimals, 0)];
+    return negative ? -result : result;
+}
+
+// Parse "SOURCE>DESTINATION,PATH..." into destination and relaying receiver
+void parseRoute(Ogn::OgnMessageData& ognMessage, std::string_view header)
+{
+    auto const index = header.find('>');
+    if (index == std::string_view::npos) {
+        return;
+    }
+    std::string_view path = header.substr(index + 1);
+    auto comma = path.find(',');
+    ognMessage.destination = path.substr(0, comma);
+
+    // The element after the q construct names the receiver, except for
+    // qAC, which marks stations connected directly, followed by the server
+    while (comma != std::string_view::npos) {
+        path.remove_prefix(comma + 1);
+        comma = path.find(',');
+        std::string_view const element = path.substr(0, comma);
+        if (element.size() == 3 && element[0] == 'q' && element[1] == 'A') {
+            if (element[2] != 'C' && comma != std::string_view::npos) {
+                ognMessage.receiver = path.substr(comma + 1, path.find(',', comma + 1) - comma - 1);
+            }
+            return;
+        }
+    }
+}
+
+// Round value * scale to an integer, as printf rounds the exact binary value
+// of value to the corresponding number of decimals. For non-negative values
+// that are small enough to be represented exactly after scaling.
+long long roundScaled(double value, double scale)
+{
+    double const product = value * scale;
+    double const down = std::floor(product);
+    if (product - down != 0.5) {
+        return std::llround(product);
+    }
+    // The product rounded to a tie: decide by the rounding error of the
+    // multiplication, and round exact ties to even
+    double const error = std::fma(value, scale, -product);
+    auto const lower = static_cast<long long>(down);
+    if (error > 0.0) {
+        return lower + 1;
+    }
+    if (error < 0.0) {
+        return lower;
+    }
+    return lower + (lower & 1);
+}
+
+// Bounded output for the format functions. Writes that do not fit set
+// an overflow flag instead.
+class BufferWriter
+{
+public:
+    BufferWriter(char* buffer, std::size_t size)
+        : m_begin(buffer)
+        , m_position(buffer)
+        , m_end(buffer + size)
+    {
+    }
+
+    void append(char character)
+    {
+        if (m_position == m_end) {
+            m_overflow = true;
+            return;
+        }
+        *m_position++ = character;
+    }
+
+    void append(std::string_view text)
+    {
+        if (text.size() > static_cast<std::size_t>(m_end - m_position)) {
+            m_overflow = true;
+            return;
+        }
+        std::memcpy(m_position, text.data(), text.size());
+        m_position += text.size();
+    }
+
+    // Integer, padded with leading zeros to width, as with std::setfill('0') << std::setw(width)
+    void appendInteger(long long value, int width = 0)
+    {
+        char digits[24];
+        auto const result = std::to_chars(digits, digits + sizeof(digits), value);
+        for (auto length = result.ptr - digits; length < width; ++length) {
+            append('0');
+        }
+        append(std::string_view(digits, static_cast<std::size_t>(result.ptr - digits)));
+    }
+
+    // Value with a fixed number of decimals, as with std::fixed << std::setprecision(decimals)
+    void appendFixed(double value, int decimals)
+    {
+        if (std::isnan(value)) {
+            append("nan");
+            return;
+        }
+        if (std::signbit(value)) {
+            append('-');
+        }
+        long long scale = 1;
+        for (int i = 0; i < decimals; ++i) {
+            scale *= 10;
+        }
+        // Clamp, so that the scaled value fits into long long
+        auto const scaled = roundScaled(std::min(std::abs(value), 1e12), static_cast<double>(scale));
+        appendInteger(scaled / scale);
+        append('.');
+        appendInteger(scaled % scale, decimals);
+    }
+
+    // Number of characters written, or 0 on overflow
+    [[nodiscard]] std::size_t size() const { return m_overflow ? 0 : static_cast<std::size_t>(m_position - m_begin); }
+
+private:
+    char* m_begin;
+    char* m_position;
+    char* m_end;
+    bool m_overflow = false;
 };
 
-static const std::unordered_map<std::string, Ogn::OgnSymbol> AprsSymbolMap = {
-    {"/z",  Ogn::OgnSymbol::UNKNOWN},        // Unknown
-    {"/'",  Ogn::OgnSymbol::GLIDER},         // Glider
-    {"/X",  Ogn::OgnSymbol::HELICOPTER},     // Helicopter
-    {"/g",  Ogn::OgnSymbol::PARACHUTE},      // Parachute, Hang Glider, Paraglider
-    {"\\^", Ogn::OgnSymbol::AIRCRAFT},       // Drop Plane, Powered Aircraft
-    {"/^",  Ogn::OgnSymbol::JET},            // Jet Aircraft
-    {"/O",  Ogn::OgnSymbol::BALLOON},        // Balloon, Airship
-    {"\\n", Ogn::OgnSymbol::STATIC_OBJECT},  // Static Object
-    {"/_",  Ogn::OgnSymbol::WEATHERSTATION},  // WeatherStation
+// Append a std::string, using the given format function for char buffers.
+// Does not allocate if out has sufficient capacity.
+template<typename Format>
+void appendFormatted(std::string& out, std::size_t maximumSize, Format&& format)
+{
+    std::size_t const offset = out.size();
+    out.resize(offset + maximumSize);
+    out.resize(offset + format(out.data() + offset, maximumSize));
+}
+
+// APRS coordinate, e.g. "5111.32N" for latitudes (two digits for the
+// degrees) and "00102.04W" for longitudes (three digits)
+void appendCoordinate(BufferWriter& writer, double value, int degreeDigits, char positive, char negative)
+{
+    // Clamp, so that invalid values cannot overflow the buffer
+    double const absolute = std::isnan(value) ? 0.0 : std::min(std::abs(value), 999.0);
+    auto degrees = static_cast<long long>(absolute);
+    auto hundredthsOfMinutes = roundScaled((absolute - static_cast<double>(degrees)) * 60.0, 100.0);
+    if (hundredthsOfMinutes >= 6000) {
+        // Rounded up to a full degree
+        degrees += 1;
+        hundredthsOfMinutes -= 6000;
+    }
+    writer.appendInteger(degrees, degreeDigits);
+    writer.appendInteger(hundredthsOfMinutes / 100, 2);
+    writer.append('.');
+    writer.appendInteger(hundredthsOfMinutes % 100, 2);
+    writer.append(value >= 0 ? positive : negative);
+}
+
+// Range filter, e.g. "filter r/-48.0000/7.8512/99 t/o"
+void appendFilter(BufferWriter& writer, double latitude, double longitude, unsigned int receiveRadius)
+{
+    writer.append("filter r/");
+    writer.appendFixed(latitude, 4);
+    writer.append('/');
+    writer.appendFixed(longitude, 4);
+    writer.append('/');
+    writer.appendInteger(receiveRadius);
+    writer.append(" t/o");
+}
+
+// APRS-IS passcode: Sum of ASCII values of the first 6 characters of the call sign
+// e.g. "ENR12345" -> 379
+int calculatePassword(std::string_view callSign)
+{
+    int sum = 0;
+    for (size_t i = 0; i < callSign.length() && i < 6; ++i)
+    {
+        sum += static_cast<unsigned char>(callSign[i]);
+    }
+    return sum % 10000;
+}
+
+// Conversion of doubles that are not representable as int is undefined
+int toInt(double value)
+{
+    if (std::isnan(value)) {
+        return 0;
+    }
+    return static_cast<int>(std::clamp(value, -1e9, 1e9));
+}
+
+// Number of values of Ogn::Tokenizer::TokenKind
+constexpr std::size_t TokenKindCount = static_cast<std::size_t>(Ogn::Tokenizer::TokenKind::Enhancement) + 1;
+
+// APRS symbol (symbol table, symbol code) for an aircraft type, indexed by OgnAircraftType
+// see http://wiki.glidernet.org/wiki:ogn-flavoured-aprs
+struct AprsSymbol {
+    char table;
+    char code;
 };
+constexpr std::array<AprsSymbol, 13> AircraftTypeSymbols = {{
+    {'/',  'z'},  // unknown: Unknown
+    {'\\', '^'},  // Aircraft: Drop Plane, Powered Aircraft
+    {'\\', '^'},  // Airship (no symbol of its own)
+    {'/',  'O'},  // Balloon: Balloon, Airship
+    {'/',  'X'},  // Copter: Helicopter
+    {'\\', '^'},  // Drone (no symbol of its own)
+    {'/',  '\''}, // Glider: Glider
+    {'\\', '^'},  // HangGlider (no symbol of its own)
+    {'/',  '^'},  // Jet: Jet Aircraft
+    {'/',  'g'},  // Paraglider: Parachute, Hang Glider, Paraglider
+    {'\\', '^'},  // Skydiver (no symbol of its own)
+    {'\\', 'n'},  // StaticObstacle: Static Object
+    {'\\', '^'},  // TowPlane (no symbol of its own)
+}};
+static_assert(AircraftTypeSymbols.size() == static_cast<std::size_t>(Ogn::OgnAircraftType::TowPlane) + 1,
+              "AircraftTypeSymbols must have one entry per OgnAircraftType");
+
+// OgnSymbol for APRS symbols, indexed by symbol table ('/' = 0, '\\' = 1) and symbol code
+using AprsSymbolTable = std::array<std::array<Ogn::OgnSymbol, 128>, 2>;
+constexpr AprsSymbolTable AprsSymbols = [] {
+    AprsSymbolTable table{}; // Ogn::OgnSymbol::UNKNOWN
+    table[0]['z']  = Ogn::OgnSymbol::UNKNOWN;        // Unknown
+    table[0]['\''] = Ogn::OgnSymbol::GLIDER;         // Glider
+    table[0]['X']  = Ogn::OgnSymbol::HELICOPTER;     // Helicopter
+    table[0]['g']  = Ogn::OgnSymbol::PARACHUTE;      // Parachute, Hang Glider, Paraglider
+    table[1]['^']  = Ogn::OgnSymbol::AIRCRAFT;       // Drop Plane, Powered Aircraft
+    table[0]['^']  = Ogn::OgnSymbol::JET;            // Jet Aircraft
+    table[0]['O']  = Ogn::OgnSymbol::BALLOON;        // Balloon, Airship
+    table[1]['n']  = Ogn::OgnSymbol::STATIC_OBJECT;  // Static Object
+    table[0]['_']  = Ogn::OgnSymbol::WEATHERSTATION; // WeatherStation
+    return table;
+}();
+
+inline Ogn::OgnSymbol lookupSymbol(char symbolTable, char symbolCode)
+{
+    auto const code = static_cast<unsigned char>(symbolCode);
+    if (code >= 128) {
+        return Ogn::OgnSymbol::UNKNOWN;
+    }
+    if (symbolTable == '/') {
+        return AprsSymbols[0][code];
+    }
+    if (symbolTable == '\\') {
+        return AprsSymbols[1][code];
+    }
+    return Ogn::OgnSymbol::UNKNOWN;
+}
 
 // see http://wiki.glidernet.org/wiki:ogn-flavoured-aprs
-static const std::map<uint32_t, Ogn::OgnAircraftType> AircraftCategoryMap = {
-    {0x0, Ogn::OgnAircraftType::unknown},         // Reserved
-    {0x1, Ogn::OgnAircraftType::Glider},          // Glider/Motor Glider/TMG
-    {0x2, Ogn::OgnAircraftType::TowPlane},        // Tow Plane/Tug Plane
-    {0x3, Ogn::OgnAircraftType::Copter},          // Helicopter/Gyrocopter/Rotorcraft
-    {0x4, Ogn::OgnAircraftType::Skydiver},        // Skydiver/Parachute
-    {0x5, Ogn::OgnAircraftType::Aircraft},        // Drop Plane for Skydivers
-    {0x6, Ogn::OgnAircraftType::HangGlider},      // Hang Glider (hard)
-    {0x7, Ogn::OgnAircraftType::Paraglider},      // Paraglider (soft)
-    {0x8, Ogn::OgnAircraftType::Aircraft},        // Aircraft with reciprocating engine(s)
-    {0x9, Ogn::OgnAircraftType::Jet},             // Aircraft with jet/turboprop engine(s)
-    {0xA, Ogn::OgnAircraftType::unknown},         // Unknown
-    {0xB, Ogn::OgnAircraftType::Balloon},         // Balloon (hot, gas, weather, static)
-    {0xC, Ogn::OgnAircraftType::Airship},         // Airship/Blimp/Zeppelin
-    {0xD, Ogn::OgnAircraftType::Drone},           // UAV/RPAS/Drone
-    {0xE, Ogn::OgnAircraftType::unknown},         // Reserved
-    {0xF, Ogn::OgnAircraftType::StaticObstacle}   // Static Obstacle
+constexpr std::array<Ogn::OgnAircraftType, 16> AircraftCategories = {
+    Ogn::OgnAircraftType::unknown,         // 0x0: Reserved
+    Ogn::OgnAircraftType::Glider,          // 0x1: Glider/Motor Glider/TMG
+    Ogn::OgnAircraftType::TowPlane,        // 0x2: Tow Plane/Tug Plane
+    Ogn::OgnAircraftType::Copter,          // 0x3: Helicopter/Gyrocopter/Rotorcraft
+    Ogn::OgnAircraftType::Skydiver,        // 0x4: Skydiver/Parachute
+    Ogn::OgnAircraftType::Aircraft,        // 0x5: Drop Plane for Skydivers
+    Ogn::OgnAircraftType::HangGlider,      // 0x6: Hang Glider (hard)
+    Ogn::OgnAircraftType::Paraglider,      // 0x7: Paraglider (soft)
+    Ogn::OgnAircraftType::Aircraft,        // 0x8: Aircraft with reciprocating engine(s)
+    Ogn::OgnAircraftType::Jet,             // 0x9: Aircraft with jet/turboprop engine(s)
+    Ogn::OgnAircraftType::unknown,         // 0xA: Unknown
+    Ogn::OgnAircraftType::Balloon,         // 0xB: Balloon (hot, gas, weather, static)
+    Ogn::OgnAircraftType::Airship,         // 0xC: Airship/Blimp/Zeppelin
+    Ogn::OgnAircraftType::Drone,           // 0xD: UAV/RPAS/Drone
+    Ogn::OgnAircraftType::unknown,         // 0xE: Reserved
+    Ogn::OgnAircraftType::StaticObstacle   // 0xF: Static Obstacle
 };
 
 } // namespace
@@ -98,19 +358,94 @@ namespace Ogn {
 
 
 void OgnParser::parseAprsisMessage(OgnMessage& ognMessage)
+{
+    parseSentence(ognMessage, ognMessage.sentence, OgnField::All);
+}
+
+void OgnParser::parseAprsisMessage(OgnMessageView& ognMessage)
+{
+    parseSentence(ognMessage, ognMessage.sentence, OgnField::All);
+}
+
+void OgnParser::parseAprsisMessage(OgnMessage& ognMessage, uint32_t fieldMask)
+{
+    parseSentence(ognMessage, ognMessage.sentence, fieldMask);
+}
+
+void OgnParser::parseAprsisMessage(OgnMessageView& ognMessage, uint32_t fieldMask)
+{
+    parseSentence(ognMessage, ognMessage.sentence, fieldMask);
+}
+
+void OgnParser::parseAprsisMessage(OgnMessage& ognMessage, const OgnPreFilter& preFilter, uint32_t fieldMask)
+{
+    parseSentence(ognMessage, ognMessage.sentence, fieldMask, &preFilter);
+}
+
+void OgnParser::parseAprsisMessage(OgnMessageView& ognMessage, const OgnPreFilter& preFilter, uint32_t fieldMask)
+{
+    parseSentence(ognMessage, ognMessage.sentence, fieldMask, &preFilter);
+}
+
+std::size_t OgnParser::parseAprsisBatch(std::string_view chunk, std::vector<OgnMessageView>& ognMessages, uint32_t fieldMask)
+{
+    return parseBatch(chunk, ognMessages, fieldMask, nullptr);
+}
+
+std::size_t OgnParser::parseAprsisBatch(std::string_view chunk, std::vector<OgnMessageView>& ognMessages, const OgnPreFilter& preFilter, uint32_t fieldMask)
+{
+    return parseBatch(chunk, ognMessages, fieldMask, &preFilter);
+}
+
+std::size_t OgnParser::parseBatch(std::string_view chunk, std::vector<OgnMessageView>& ognMessages, uint32_t fieldMask, const OgnPreFilter* preFilter)
+{
+    // In this function
+    // avoid heap allocations for performance reasons. The vector is cleared,
+    // but keeps its capacity, so that repeated calls do not allocate.
+    ognMessages.clear();
+
+    while (!chunk.empty())
+    {
+        auto const newlineIndex = chunk.find('\n');
+        std::string_view line = chunk.substr(0, newlineIndex);
+        chunk = (newlineIndex == std::string_view::npos) ? std::string_view() : chunk.substr(newlineIndex + 1);
+
+        // Remove trailing '\r' if present
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.remove_suffix(1);
+        }
+        if (line.empty())
+        {
+            continue;
+        }
+
+        OgnMessageView& ognMessage = ognMessages.emplace_back();
+        ognMessage.sentence = line;
+        if (!parseSentence(ognMessage, line, fieldMask, preFilter))
+        {
+            ognMessages.pop_back();
+        }
+    }
+    return ognMessages.size();
+}
+
+bool OgnParser::parseSentence(OgnMessageData& ognMessage, const std::string_view sentence, uint32_t fieldMask, const OgnPreFilter* preFilter)
 {
     // In this function 
     // avoid heap allocations for performance reasons.
 
-    // Expect that data Structure OgnMessage is reset or initialized to default values.
+    // Expect that data Structure OgnMessageData is reset or initialized to default values.
     assert(ognMessage.type == OgnMessageType::UNKNOWN);
 
-    const std::string_view sentence(ognMessage.sentence);
     if (starts_with(sentence, "#"))
     {
         // Comment message  
-        parseCommentMessage(ognMessage);
-        return;
+        if ((fieldMask & OgnField::Comments) != 0)
+        {
+            parseCommentMessage(ognMessage);
+        }
+        return true;
     }
 
     // Split the sentence into header and body at the first colon
@@ -121,7 +456,7 @@ void OgnParser::parseAprsisMessage(OgnMessage& ognMessage)
         // Debug: Invalid message format
 #endif
         ognMessage.type = OgnMessageType::UNKNOWN;
-        return;
+        return true;
     }
 
     // This function runs all the time, so it is performance critical.
@@ -136,28 +471,38 @@ void OgnParser::parseAprsisMessage(OgnMessage& ognMessage)
         // Debug: Invalid message header or body
 #endif
         ognMessage.type = OgnMessageType::UNKNOWN;
-        return;
+        return true;
     }
 
     // Determine the type of message based on the first character in the body
     if (starts_with(body, "/"))
     {
-        // "/" indicates a Traffic Report
-        parseTrafficReport(ognMessage, header, body);
-        return;
+        // "/" indicates a Traffic Report (or a Weather Report)
+        if (preFilter != nullptr && !preFilter->accepts(body))
+        {
+            return false;
+        }
+        if ((fieldMask & (OgnField::TrafficReports | OgnField::WeatherReports)) != 0)
+        {
+            parseTrafficReport(ognMessage, header, body, fieldMask);
+        }
+        return true;
     }
     if (starts_with(body, ">"))
     {
         // ">" indicates a Receiver Status
-        parseStatusMessage(ognMessage, header, body);
-        return;
+        if ((fieldMask & OgnField::StatusMessages) != 0)
+        {
+            parseStatusMessage(ognMessage, header, body, fieldMask);
+        }
+        return true;
     }
 
     ognMessage.type = OgnMessageType::UNKNOWN;
 #if OGNPARSER_DEBUG
     // Debug: Unknown message type
 #endif
-    return;
+    return true;
 }
 
 double OgnParser::decodeLatitude(std::string_view nmeaLatitude, char latitudeDirection, char latEnhancement)
@@ -165,69 +510,28 @@ double OgnParser::decodeLatitude(std::string_view nmeaLatitude, char latitudeDir
     // In this function 
     // avoid heap allocations for performance reasons.
 
-    // e.g. "5111.32"
-    if (nmeaLatitude.size() < 7) {
+    // e.g. "5111.32", fixed format DDMM.MM
+    if (nmeaLatitude.size() < 7 || nmeaLatitude[4] != '.') {
         // Debug: invalid input
         return std::numeric_limits<double>::quiet_NaN(); // Invalid input
     }
-
-    // Parse degrees (first 2 characters)
-    double latitudeDegrees = 0.0;
-#if defined(__ANDROID__) || defined(__APPLE__)
-    // Android NDK and Apple platforms don't support std::from_chars for floating-point yet
-    char* endPtr = nullptr;
-    const char degreesBuffer[3] = {nmeaLatitude[0], nmeaLatitude[1], '\0'};
-    latitudeDegrees = std::strtod(degreesBuffer, &endPtr);
-    if (endPtr == degreesBuffer) {
+    unsigned int const d0 = digitValue(nmeaLatitude[0]);
+    unsigned int const d1 = digitValue(nmeaLatitude[1]);
+    unsigned int const m0 = digitValue(nmeaLatitude[2]);
+    unsigned int const m1 = digitValue(nmeaLatitude[3]);
+    unsigned int const m2 = digitValue(nmeaLatitude[5]);
+    unsigned int const m3 = digitValue(nmeaLatitude[6]);
+    if (std::max({d0, d1, m0, m1, m2, m3}) > 9) {
         return std::numeric_limits<double>::quiet_NaN();
     }
-#else
-    auto result = std::from_chars(nmeaLatitude.data(), nmeaLatitude.data() + 2, latitudeDegrees);
-    if (result.ec != std::errc{}) {
-        // Debug: decodeLatitude from_chars failed 1
-        return std::numeric_limits<double>::quiet_NaN();
-    }
-#endif
 
-    // Parse minutes (remaining characters after the first 2)
-    double latitudeMinutes = 0.0;
-    std::string_view const minutesStr = nmeaLatitude.substr(2);
-#if defined(__ANDROID__) || defined(__APPLE__)
-    // Android NDK and Apple platforms don't support std::from_chars for floating-point yet
-    // Use strtod_l with C locale to ensure locale-independent parsing
-    char minutesBuffer[16];
-    size_t copyLen = minutesStr.size() < 15 ? minutesStr.size() : 15;
-    std::copy_n(minutesStr.data(), copyLen, minutesBuffer);
-    minutesBuffer[copyLen] = '\0';
-    static locale_t c_locale = newlocale(LC_ALL_MASK, "C", (locale_t)0);
-    latitudeMinutes = strtod_l(minutesBuffer, &endPtr, c_locale);
-    if (endPtr == minutesBuffer) {
-        return std::numeric_limits<double>::quiet_NaN();
-    }
-#else
-    auto minutesResult = std::from_chars(minutesStr.data(), minutesStr.data() + minutesStr.size(), latitudeMinutes);
-    if (minutesResult.ec != std::errc{}) {
-        // Debug: decodeLatitude from_chars failed 2
-        return std::numeric_limits<double>::quiet_NaN();
-    }
-#endif
-
-    // Combine degrees and minutes
-    double latitude = latitudeDegrees + (latitudeMinutes / 60.0);
-
-    // Apply precision enhancement
-    if(latEnhancement != '\0') {
-        if (latEnhancement >= '0' && latEnhancement <= '9') {
-            latitude += static_cast<double>(latEnhancement - '0') * 0.001 / 60;
-        }
-    }
+    // Combine degrees and minutes, including the optional precision enhancement (thousandths of minutes)
+    unsigned int const degrees = d0 * 10 + d1;
+    unsigned int const thousandthsOfMinutes = (m0 * 1000 + m1 * 100 + m2 * 10 + m3) * 10 + enhancementValue(latEnhancement);
+    double const latitude = degrees + thousandthsOfMinutes * (1.0 / 60000.0);
 
     // Adjust for direction (South is negative)
-    if (latitudeDirection == 'S') {
-        latitude = -latitude;
-    }
-
-    return latitude;
+    return (latitudeDirection == 'S') ? -latitude : latitude;
 }
 
 double OgnParser::decodeLongitude(std::string_view nmeaLongitude, char longitudeDirection, char lonEnhancement)
@@ -235,72 +539,32 @@ double OgnParser::decodeLongitude(std::string_view nmeaLongitude, char longitude
     // In this function 
     // avoid heap allocations for performance reasons.
 
-    // e.g. "00102.04W"
-    if (nmeaLongitude.size() < 8) {
+    // e.g. "00102.04", fixed format DDDMM.MM
+    if (nmeaLongitude.size() < 8 || nmeaLongitude[5] != '.') {
         // Debug: lon invalid input
         return std::numeric_limits<double>::quiet_NaN(); // Invalid input
     }
-
-    // Parse degrees (first 3 characters)
-    double longitudeDegrees = 0.0;
-#if defined(__ANDROID__) || defined(__APPLE__)
-    // Android NDK and Apple platforms don't support std::from_chars for floating-point yet
-    char* endPtr = nullptr;
-    const char degreesBuffer[4] = {nmeaLongitude[0], nmeaLongitude[1], nmeaLongitude[2], '\0'};
-    longitudeDegrees = std::strtod(degreesBuffer, &endPtr);
-    if (endPtr == degreesBuffer) {
+    unsigned int const d0 = digitValue(nmeaLongitude[0]);
+    unsigned int const d1 = digitValue(nmeaLongitude[1]);
+    unsigned int const d2 = digitValue(nmeaLongitude[2]);
+    unsigned int const m0 = digitValue(nmeaLongitude[3]);
+    unsigned int const m1 = digitValue(nmeaLongitude[4]);
+    unsigned int const m2 = digitValue(nmeaLongitude[6]);
+    unsigned int const m3 = digitValue(nmeaLongitude[7]);
+    if (std::max({d0, d1, d2, m0, m1, m2, m3}) > 9) {
         return std::numeric_limits<double>::quiet_NaN();
     }
-#else
-    auto result = std::from_chars(nmeaLongitude.data(), nmeaLongitude.data() + 3, longitudeDegrees);
-    if (result.ec != std::errc{}) {
-        // Debug: lon from_chars failed 1
-        return std::numeric_limits<double>::quiet_NaN();
-    }
-#endif
 
-    // Parse minutes (remaining characters after the first 3)
-    double longitudeMinutes = 0.0;
-    std::string_view const minutesStr = nmeaLongitude.substr(3);
-#if defined(__ANDROID__) || defined(__APPLE__)
-    // Android NDK and Apple platforms don't support std::from_chars for floating-point yet
-    // Use strtod_l with C locale to ensure locale-independent parsing
-    char minutesBuffer[16];
-    size_t copyLen = minutesStr.size() < 15 ? minutesStr.size() : 15;
-    std::copy_n(minutesStr.data(), copyLen, minutesBuffer);
-    minutesBuffer[copyLen] = '\0';
-    static locale_t c_locale = newlocale(LC_ALL_MASK, "C", (locale_t)0);
-    longitudeMinutes = strtod_l(minutesBuffer, &endPtr, c_locale);
-    if (endPtr == minutesBuffer) {
-        return std::numeric_limits<double>::quiet_NaN();
-    }
-#else
-    auto minutesResult = std::from_chars(minutesStr.data(), minutesStr.data() + minutesStr.size(), longitudeMinutes);
-    if (minutesResult.ec != std::errc{}) {
-        // Debug: decodeLongitude from_chars failed 2
-        return std::numeric_limits<double>::quiet_NaN();
-    }
-#endif
-
-    // Combine degrees and minutes
-    double longitude = longitudeDegrees + (longitudeMinutes / 60.0);
-
-    // Apply precision enhancement
-    if(lonEnhancement != '\0') {
-        if (lonEnhancement >= '0' && lonEnhancement <= '9') {
-            longitude += static_cast<double>(lonEnhancement - '0') * 0.001 / 60;
-        }
-    }
+    // Combine degrees and minutes, including the optional precision enhancement (thousandths of minutes)
+    unsigned int const degrees = d0 * 100 + d1 * 10 + d2;
+    unsigned int const thousandthsOfMinutes = (m0 * 1000 + m1 * 100 + m2 * 10 + m3) * 10 + enhancementValue(lonEnhancement);
+    double const longitude = degrees + thousandthsOfMinutes * (1.0 / 60000.0);
 
     // Adjust for direction (West is negative)
-    if (longitudeDirection == 'W') {
-        longitude = -longitude;
-    }
-
-    return longitude;
+    return (longitudeDirection == 'W') ? -longitude : longitude;
 }
 
-void OgnParser::parseTrafficReport(OgnMessage& ognMessage, const std::string_view header, const std::string_view body)
+void OgnParser::parseTrafficReport(OgnMessageData& ognMessage, const std::string_view header, const std::string_view body, uint32_t fieldMask)
 {
     // In this function 
     // avoid heap allocations for performance reasons.
@@ -323,6 +587,22 @@ void OgnParser::parseTrafficReport(OgnMessage& ognMessage, const std::string_vie
         return;
     }
 
+    // Parse symbol, which tells weather reports from traffic reports. It sits
+    // at fixed offsets of the APRS part, so that unwanted message types are
+    // rejected before the body is tokenized.
+    if (body.size() < 30) {
+        ognMessage.type = OgnMessageType::UNKNOWN;
+        return;
+    }
+    char const symbolTable = body[16];
+    char const symbolCode = body[26];
+    OgnSymbol const symbol = lookupSymbol(symbolTable, symbolCode);
+    bool const isWeatherReport = (symbol == OgnSymbol::WEATHERSTATION);
+    if ((fieldMask & (isWeatherReport ? OgnField::WeatherReports : OgnField::TrafficReports)) == 0) {
+        ognMessage.type = OgnMessageType::UNKNOWN;
+        return;
+    }
+
     // Parse the Header
     auto const index = header.find('>');
     if (index == std::string_view::npos) {
@@ -334,29 +614,49 @@ void OgnParser::parseTrafficReport(OgnMessage& ognMessage, const std::string_vie
     }
     ognMessage.type = OgnMessageType::TRAFFIC_REPORT;
     ognMessage.sourceId = header.substr(0, index);
+    if ((fieldMask & OgnField::Route) != 0) {
+        parseRoute(ognMessage, header);
+    }
 
-    // Parse the body
-    auto const blankIndex = body.find(' ');
+    // Parse the body. A single pass finds all blanks: the APRS part is the
+    // first token, the items of the OGN part are classified as they are found.
+    // For every kind of item, the last one counts. The OGN part is skipped
+    // if no field is requested that lives there; the precision enhancement
+    // of the position is one of these.
+    constexpr uint32_t ognPartFields = OgnField::Position | OgnField::AircraftID | OgnField::VerticalSpeed |
+                                       OgnField::RotationRate | OgnField::Reception | OgnField::FlightLevel |
+                                       OgnField::FlightNumber | OgnField::Squawk | OgnField::GpsInfo | OgnField::Weather;
     std::string_view aprsPart;
-    std::string_view ognPart;
-    if (blankIndex == std::string_view::npos) {
-        aprsPart = body;
+    std::array<std::string_view, TokenKindCount> ognItems;
+    if ((fieldMask & ognPartFields) != 0) {
+        Tokenizer::forEachToken(body, [&aprsPart, &ognItems](std::string_view token) {
+            if (aprsPart.empty()) {
+                aprsPart = token; // never empty, body starts with '/'
+                return;
+            }
+            ognItems[static_cast<std::size_t>(Tokenizer::classifyToken(token))] = token;
+        });
     } else {
-        aprsPart = body.substr(0, blankIndex); // APRS Part before the first blank
-        ognPart = body.substr(blankIndex + 1); // OGN Part after the first blank
+        aprsPart = body.substr(0, body.find(' '));
     }
+    auto const ognItem = [&ognItems](Tokenizer::TokenKind kind) {
+        return ognItems[static_cast<std::size_t>(kind)];
+    };
 
     // Parse aprsPart
     if (!starts_with(aprsPart, "/") || aprsPart.size() < 30) {
         ognMessage.type = OgnMessageType::UNKNOWN;
         return;
     }
+    ognMessage.symbol = symbol;
 
     // Parse timestamp
-    ognMessage.timestamp = aprsPart.substr(1, 6);
+    if ((fieldMask & OgnField::Timestamp) != 0) {
+        ognMessage.timestamp = aprsPart.substr(1, 6);
+    }
 
     // Parse coordinates
-    {
+    if ((fieldMask & OgnField::Position) != 0) {
         // latitude
         std::string_view const latString = aprsPart.substr(8, 7); // "4741.90"
         char const latDirection = aprsPart[15];      // "N" or "S"
@@ -366,10 +666,10 @@ void OgnParser::parseTrafficReport(OgnMessage& ognMessage, const std::string_vie
         // optional precision enhancement, e.g. "!W91"
         char latEnhancement = '\0';
         char lonEnhancement = '\0';
-        auto const precisionIndex = body.find("!W");
-        if (precisionIndex != std::string_view::npos && body.size() > precisionIndex + 4) {
-            latEnhancement = body[precisionIndex + 2];
-            lonEnhancement = body[precisionIndex + 3];
+        std::string_view const enhancement = ognItem(Tokenizer::TokenKind::Enhancement);
+        if (!enhancement.empty()) {
+            latEnhancement = enhancement[2];
+            lonEnhancement = enhancement[3];
         }
         // decode
         double const latitude = decodeLatitude(latString, latDirection, latEnhancement);
@@ -378,21 +678,11 @@ void OgnParser::parseTrafficReport(OgnMessage& ognMessage, const std::string_vie
         ognMessage.longitude = longitude;
     }
 
-
-    // Parse symbol
-    char const symbolTable = aprsPart[16];
-    char const symbolCode = aprsPart[26];
-    const char symbolKey[3] = {symbolTable, symbolCode, '\0'};
-    auto it = AprsSymbolMap.find(symbolKey);
-    if (it != AprsSymbolMap.end()) {
-        ognMessage.symbol = it->second;
-    } else {
-        ognMessage.symbol = OgnSymbol::UNKNOWN;
-    }
-
     // If the weather report is detected (e.g. an underscore appears after the longitude)
-    if(ognMessage.symbol == OgnSymbol::WEATHERSTATION) {
+    if (isWeatherReport) {
         ognMessage.type = OgnMessageType::WEATHER;
+    }
+    if (isWeatherReport && (fieldMask & OgnField::Weather) != 0) {
         int const underscoreIndex = 26;
         // Decode wind direction: next 3 digits after the underscore
         std::string_view const windDirStr = aprsPart.substr(underscoreIndex + 1, 3);
@@ -400,6 +690,7 @@ void OgnParser::parseTrafficReport(OgnMessage& ognMessage, const std::string_vie
         auto result = std::from_chars(windDirStr.data(), windDirStr.data() + windDirStr.size(), windDir);
         if (result.ec == std::errc{}) {
             ognMessage.wind_direction = windDir;
+            ognMessage.weatherFields |= OgnMessageData::HasWindDirection;
         }
         
         // Find the slash following the wind direction to decode wind speed
@@ -410,6 +701,7 @@ void OgnParser::parseTrafficReport(OgnMessage& ognMessage, const std::string_vie
             auto result = std::from_chars(windSpeedStr.data(), windSpeedStr.data() + windSpeedStr.size(), windSpd);
             if (result.ec == std::errc{}) {
                 ognMessage.wind_speed = windSpd;
+                ognMessage.weatherFields |= OgnMessageData::HasWindSpeed;
             }
         }
         // Decode wind gust speed: look for 'g'
@@ -420,16 +712,19 @@ void OgnParser::parseTrafficReport(OgnMessage& ognMessage, const std::string_vie
             auto result = std::from_chars(gustStr.data(), gustStr.data() + gustStr.size(), gust);
             if (result.ec == std::errc{}) {
                 ognMessage.wind_gust_speed = gust;
+                ognMessage.weatherFields |= OgnMessageData::HasWindGustSpeed;
             }
         }
         // Decode temperature: look for 't'
         auto const tIndex = aprsPart.find("t", underscoreIndex);
         if (tIndex != std::string_view::npos) {
+            // Three characters, like "032" or "-05"
             std::string_view const tempStr = aprsPart.substr(tIndex + 1, 3);
-            uint32_t temp = 0;
+            int temp = 0;
             auto result = std::from_chars(tempStr.data(), tempStr.data() + tempStr.size(), temp);
             if (result.ec == std::errc{}) {
-                ognMessage.temperature = temp;
+                ognMessage.temperature = static_cast<uint32_t>(temp);
+                ognMessage.weatherFields |= OgnMessageData::HasTemperature;
             }
         }
         // Decode humidity: look for 'h'
@@ -440,6 +735,7 @@ void OgnParser::parseTrafficReport(OgnMessage& ognMessage, const std::string_vie
             auto result = std::from_chars(humStr.data(), humStr.data() + humStr.size(), hum);
             if (result.ec == std::errc{}) {
                 ognMessage.humidity = hum;
+                ognMessage.weatherFields |= OgnMessageData::HasHumidity;
             }
         }
         // Decode pressure: look for 'b'
@@ -455,11 +751,12 @@ void OgnParser::parseTrafficReport(OgnMessage& ognMessage, const std::string_vie
             auto result = std::from_chars(presStr.data(), presStr.data() + presStr.size(), pressureTenths);
             if (result.ec == std::errc{}) {
                 ognMessage.pressure = pressureTenths / 10.0; // tenths of hectopascal
+                ognMessage.weatherFields |= OgnMessageData::HasPressure;
             }
         }
-    } else {
+    } else if (!isWeatherReport) {
         // Parse course, speed
-        if (aprsPart.size() >= 34 && aprsPart[30] == '/') {
+        if ((fieldMask & OgnField::CourseSpeed) != 0 && aprsPart.size() >= 34 && aprsPart[30] == '/') {
             std::string_view const courseStr = aprsPart.substr(27, 3);
             std::string_view const speedStr = aprsPart.substr(31, 3);
             int course = 0;
@@ -474,7 +771,7 @@ void OgnParser::parseTrafficReport(OgnMessage& ognMessage, const std::string_vie
             }
         }
         // Parse altitude
-        auto const altitudeIndex = aprsPart.find("/A=");
+        auto const altitudeIndex = ((fieldMask & OgnField::Altitude) != 0) ? aprsPart.find("/A=") : std::string_view::npos;
         if (altitudeIndex != std::string_view::npos) {
             auto const altStart = altitudeIndex + 3;
             std::string_view const altitudeStr = aprsPart.substr(altStart, 6);
@@ -488,81 +785,79 @@ void OgnParser::parseTrafficReport(OgnMessage& ognMessage, const std::string_vie
     }
 
     // Parse ognPart
-    if (!ognPart.empty()) {
-        auto it = ognPart.begin();
-        while (it != ognPart.end()) {
-            // Skip leading whitespace
-            while (it != ognPart.end() && *it == ' ') {
-                ++it;
+    if (auto const item = ognItem(Tokenizer::TokenKind::AircraftID); !item.empty() && (fieldMask & OgnField::AircraftID) != 0) {
+        ognMessage.aircraftID = item.substr(2);
+    }
+    if ((fieldMask & OgnField::Weather) != 0) {
+        if (auto const item = ognItem(Tokenizer::TokenKind::Temperature); !item.empty()) {
+            std::string_view const tempStr = item.substr(1);
+            int temp = 0;
+            auto result = std::from_chars(tempStr.data(), tempStr.data() + tempStr.size(), temp);
+            if (result.ec == std::errc{}) {
+                ognMessage.temperature = static_cast<uint32_t>(temp);
+                ognMessage.weatherFields |= OgnMessageData::HasTemperature;
             }
-            if (it == ognPart.end()) break;
-            
-            // Find end of current item (next space or end)
-            auto end = std::find(it, ognPart.end(), ' ');
-            std::string_view const item(it, end - it);
-
-            if (starts_with(item, "id")) {
-                ognMessage.aircraftID = item.substr(2);
-            } else if (starts_with(item, "t")) {
-                std::string_view const tempStr = item.substr(1);
-                int temp = 0;
-                auto result = std::from_chars(tempStr.data(), tempStr.data() + tempStr.size(), temp);
-                if (result.ec == std::errc{}) {
-                    ognMessage.temperature = static_cast<uint32_t>(temp);
-                }
-            } else if (starts_with(item, "h")) {
-                std::string_view const humStr = item.substr(1);
-                uint32_t hum = 0;
-                auto result = std::from_chars(humStr.data(), humStr.data() + humStr.size(), hum);
-                if (result.ec == std::errc{}) {
-                    ognMessage.humidity = hum;
-                }
-            } else if (starts_with(item, "b")) {
-                std::string_view const presStr = item.substr(1);
-                uint32_t pressureTenths = 0;
-                auto result = std::from_chars(presStr.data(), presStr.data() + presStr.size(), pressureTenths);
-                if (result.ec == std::errc{}) {
-                    ognMessage.pressure = pressureTenths / 10.0; // Convert to hPa
-                }
-            } else if (ends_with(item, "fpm")) {
-                // Convert feet per minute to meters per second: 1 fpm = 0.00508 m/s
-                auto fpmIndex = item.find('f');
-                if (fpmIndex != std::string_view::npos) {
-                    std::string_view vspeedStr = item.substr(0, fpmIndex);
-                    // Skip leading '+' if present (from_chars only handles '-' for signed types)
-                    if (!vspeedStr.empty() && vspeedStr[0] == '+') {
-                        vspeedStr = vspeedStr.substr(1);
-                    }
-                    int vspeedFpm = 0;
-                    auto result = std::from_chars(vspeedStr.data(), vspeedStr.data() + vspeedStr.size(), vspeedFpm);
-                    if (result.ec == std::errc{}) {
-                        ognMessage.verticalSpeed = vspeedFpm * 0.00508;
-                    }
-                }
-            } else if (ends_with(item, "rot")) {
-                ognMessage.rotationRate = item;
-            } else if (ends_with(item, "dB")) {
-                ognMessage.signalStrength = item;
-            } else if (ends_with(item, "e")) {
-                ognMessage.errorCount = item;
-            } else if (ends_with(item, "kHz")) {
-                ognMessage.frequencyOffset = item;
-            } else if (starts_with(item, "FL")) {
-                ognMessage.flightlevel = item;
-            } else if (starts_with(item, "A") && item.size() > 2 && item[2] == ':') {
-                auto colonPos = item.find(':');
-                if (colonPos != std::string_view::npos) {
-                    ognMessage.flightnumber = item.substr(colonPos + 1);
-                }
-            } else if (starts_with(item, "Sq")) {
-                ognMessage.squawk = item.substr(2);
-            } else if (starts_with(item, "gps:")) {
-                ognMessage.gpsInfo = item.substr(4);
+        }
+        if (auto const item = ognItem(Tokenizer::TokenKind::Humidity); !item.empty()) {
+            std::string_view const humStr = item.substr(1);
+            uint32_t hum = 0;
+            auto result = std::from_chars(humStr.data(), humStr.data() + humStr.size(), hum);
+            if (result.ec == std::errc{}) {
+                ognMessage.humidity = hum;
+                ognMessage.weatherFields |= OgnMessageData::HasHumidity;
             }
-
-            it = (end != ognPart.end()) ? end + 1 : ognPart.end();
+        }
+        if (auto const item = ognItem(Tokenizer::TokenKind::Pressure); !item.empty()) {
+            std::string_view const presStr = item.substr(1);
+            uint32_t pressureTenths = 0;
+            auto result = std::from_chars(presStr.data(), presStr.data() + presStr.size(), pressureTenths);
+            if (result.ec == std::errc{}) {
+                ognMessage.pressure = pressureTenths / 10.0; // Convert to hPa
+                ognMessage.weatherFields |= OgnMessageData::HasPressure;
+            }
+        }
+    }
+    if (auto const item = ognItem(Tokenizer::TokenKind::VerticalSpeed); !item.empty() && (fieldMask & OgnField::VerticalSpeed) != 0) {
+        // Convert feet per minute to meters per second: 1 fpm = 0.00508 m/s
+        auto fpmIndex = item.find('f');
+        if (fpmIndex != std::string_view::npos) {
+            std::string_view vspeedStr = item.substr(0, fpmIndex);
+            // Skip leading '+' if present (from_chars only handles '-' for signed types)
+            if (!vspeedStr.empty() && vspeedStr[0] == '+') {
+                vspeedStr = vspeedStr.substr(1);
+            }
+            int vspeedFpm = 0;
+            auto result = std::from_chars(vspeedStr.data(), vspeedStr.data() + vspeedStr.size(), vspeedFpm);
+            if (result.ec == std::errc{}) {
+                ognMessage.verticalSpeed = vspeedFpm * 0.00508;
+            }
+        }
+    }
+    if ((fieldMask & OgnField::RotationRate) != 0) {
+        ognMessage.rotationRate = ognItem(Tokenizer::TokenKind::RotationRate);
+        if (ognMessage.rotationRate.size() > 3) {
+            // Unit "rot" is half a turn per two minutes
+            double const rot = parseDecimal(ognMessage.rotationRate.substr(0, ognMessage.rotationRate.size() - 3));
+            ognMessage.turnRate = std::isnan(rot) ? 0.0 : rot * 1.5;
         }
     }
+    if ((fieldMask & OgnField::Reception) != 0) {
+        ognMessage.signalStrength = ognItem(Tokenizer::TokenKind::SignalStrength);
+        ognMessage.errorCount = ognItem(Tokenizer::TokenKind::ErrorCount);
+        ognMessage.frequencyOffset = ognItem(Tokenizer::TokenKind::FrequencyOffset);
+    }
+    if ((fieldMask & OgnField::FlightLevel) != 0) {
+        ognMessage.flightlevel = ognItem(Tokenizer::TokenKind::FlightLevel);
+    }
+    if (auto const item = ognItem(Tokenizer::TokenKind::FlightNumber); !item.empty() && (fieldMask & OgnField::FlightNumber) != 0) {
+        ognMessage.flightnumber = item.substr(3);
+    }
+    if (auto const item = ognItem(Tokenizer::TokenKind::Squawk); !item.empty() && (fieldMask & OgnField::Squawk) != 0) {
+        ognMessage.squawk = item.substr(2);
+    }
+    if (auto const item = ognItem(Tokenizer::TokenKind::GpsInfo); !item.empty() && (fieldMask & OgnField::GpsInfo) != 0) {
+        ognMessage.gpsInfo = item.substr(4);
+    }
 
     // Parse aircraft type, address type, and address
     if (!ognMessage.aircraftID.empty()) {
@@ -571,19 +866,17 @@ void OgnParser::parseTrafficReport(OgnMessage& ognMessage, const std::string_vie
                                       ognMessage.aircraftID.data() + ognMessage.aircraftID.size(), 
                                       hexcode, 16);
         if (result.ec == std::errc{}) {
+            ognMessage.aircraftIDValue = hexcode;
             ognMessage.stealthMode = hexcode & 0x80000000;
             ognMessage.noTrackingFlag = hexcode & 0x40000000;
             uint32_t const aircraftCategory = ((hexcode >> 26) & 0xF);
-            auto catIt = AircraftCategoryMap.find(aircraftCategory);
-            if (catIt != AircraftCategoryMap.end()) {
-                ognMessage.aircraftType = catIt->second;
-            } else {
-                ognMessage.aircraftType = Ogn::OgnAircraftType::unknown;
-            }
+            ognMessage.aircraftType = AircraftCategories[aircraftCategory];
             uint32_t const addressTypeValue = (hexcode >> 24) & 0x3;
             ognMessage.addressType = static_cast<OgnAddressType>(addressTypeValue);
-            if (ognMessage.aircraftID.size() >= 8) {
+            // The address is given by the last six of eight hex digits
+            if (result.ptr == ognMessage.aircraftID.data() + 8) {
                 ognMessage.address = ognMessage.aircraftID.substr(2, 6);
+                ognMessage.addressValue = hexcode & 0xFFFFFF;
             }
         }
     }
@@ -593,178 +886,222 @@ void OgnParser::parseTrafficReport(OgnMessage& ognMessage, const std::string_vie
     #endif
 }
 
-void OgnParser::parseCommentMessage(OgnMessage& ognMessage)
+void OgnParser::parseCommentMessage(OgnMessageData& ognMessage)
 {
     ognMessage.type = OgnMessageType::COMMENT;
 }
 
-void OgnParser::parseStatusMessage(OgnMessage &ognMessage,
-                                                     const std::string_view /*header*/,
-                                                     const std::string_view /*body*/)
+void OgnParser::parseStatusMessage(OgnMessageData &ognMessage,
+                                   const std::string_view header,
+                                   const std::string_view body,
+                                   uint32_t fieldMask)
 {
+    // e.g. header = "EDQG>OGNSDR,TCPIP*,qAC,GLIDERN5"
+    // e.g. body = ">222247h v0.3.2.arm64 CPU:0.9 RAM:278.4/951.4MB NTP:0.6ms/-2.0ppm +54.2C EGM96:+48m 0/0Acfts[1h] RF:+0+0.0ppm/+5.69dB/..."
     ognMessage.type = OgnMessageType::STATUS;
-}
-
-std::string OgnParser::formatPositionReport(const std::string_view callSign,
-                                                          double latitude,
-                                                          double longitude,
-                                                          double altitude,
-                                                          double course,
-                                                          double speed,
-                                                          OgnAircraftType aircraftType)
-{
-    // e.g. "ENR12345>APRS,TCPIP*: /074548h5111.32N/00102.04W'086/007/A=000607"
-
-    // Static cache for the last lookup
-    static OgnAircraftType lastAircraftType = OgnAircraftType::unknown;
-    static std::string lastSymbol = "/z"; // Default to unknown symbol
+    auto const index = header.find('>');
+    if (index != std::string_view::npos) {
+        ognMessage.sourceId = header.substr(0, index);
+    }
+    if ((fieldMask & OgnField::Route) != 0) {
+        parseRoute(ognMessage, header);
+    }
+    if ((fieldMask & (OgnField::Timestamp | OgnField::ReceiverStatus)) == 0) {
+        return;
+    }
 
-    // Check if the cached value matches the current aircraft type
-    if (lastAircraftType != aircraftType)
-    {
-        // Perform reverse lookup
-        lastSymbol.clear();
-        for (auto const& pair : AircraftTypeMap)
-        {
-            if (pair.second == aircraftType)
-            {
-                lastSymbol = pair.first;
-                break;
+    bool first = true;
+    Tokenizer::forEachToken(body.substr(1), [&ognMessage, &first, fieldMask](std::string_view token) {
+        if (first && token.size() == 7 && token.back() == 'h') {
+            first = false;
+            if ((fieldMask & OgnField::Timestamp) != 0) {
+                ognMessage.timestamp = token.substr(0, 6);
             }
+            return;
+        }
+        first = false;
+        if ((fieldMask & OgnField::ReceiverStatus) == 0) {
+            return;
         }
 
-        // Default to unknown symbol if no match is found
-        if (lastSymbol.empty())
-        {
-            lastSymbol = "\\^";
+        if (token.size() > 1 && token[0] == 'v' && digitValue(token[1]) <= 9) {
+            // "v0.3.2.arm64": the platform starts at the first dot that is not followed by a digit
+            std::string_view const version = token.substr(1);
+            std::size_t split = version.size();
+            for (std::size_t i = 0; i + 1 < version.size(); ++i) {
+                if (version[i] == '.' && digitValue(version[i + 1]) > 9) {
+                    split = i;
+                    break;
+                }
+            }
+            ognMessage.version = version.substr(0, split);
+            ognMessage.platform = split < version.size() ? version.substr(split + 1) : std::string_view();
+        } else if (starts_with(token, "CPU:")) {
+            ognMessage.cpuLoad = parseDecimal(token.substr(4));
+        } else if (starts_with(token, "RAM:") && token.size() > 6 && token.substr(token.size() - 2) == "MB") {
+            // "RAM:278.4/951.4MB", free and total
+            std::string_view const values = token.substr(4, token.size() - 6);
+            auto const slash = values.find('/');
+            if (slash != std::string_view::npos) {
+                ognMessage.ramFree = parseDecimal(values.substr(0, slash));
+                ognMessage.ramTotal = parseDecimal(values.substr(slash + 1));
+            }
+        } else if (starts_with(token, "NTP:")) {
+            // "NTP:0.6ms/-2.0ppm", offset and frequency correction
+            std::string_view const values = token.substr(4);
+            auto const ms = values.find("ms/");
+            if (ms != std::string_view::npos && values.size() > ms + 6 && values.substr(values.size() - 3) == "ppm") {
+                ognMessage.ntpOffset = parseDecimal(values.substr(0, ms));
+                ognMessage.ntpCorrection = parseDecimal(values.substr(ms + 3, values.size() - ms - 6));
+            }
+        } else if (token.size() > 2 && (token[0] == '+' || token[0] == '-') && token.back() == 'C') {
+            // "+54.2C"
+            ognMessage.cpuTemperature = parseDecimal(token.substr(0, token.size() - 1));
         }
+    });
+}
 
-        // Update the cache
-        lastAircraftType = aircraftType;
-    }
+std::size_t OgnParser::formatPositionReport(char* buffer,
+                                            std::size_t size,
+                                            std::string_view callSign,
+                                            double latitude,
+                                            double longitude,
+                                            double altitude,
+                                            double course,
+                                            double speed,
+                                            OgnAircraftType aircraftType)
+{
+    // e.g. "ENR12345>APRS,TCPIP*: /074548h5111.32N/00102.04W'086/007/A=000607"
+
+    // Look up the APRS symbol, default to powered aircraft for unexpected values
+    auto const aircraftTypeIndex = static_cast<std::size_t>(aircraftType);
+    AprsSymbol const symbol = aircraftTypeIndex < AircraftTypeSymbols.size() ? AircraftTypeSymbols[aircraftTypeIndex] : AprsSymbol{'\\', '^'};
 
     // Convert altitude from meters to feet: 1 meter = 3.28084 feet
     double const altitudeFeet = altitude * 3.28084;
 
-    // Get current UTC time
-    const std::time_t now = std::time(nullptr);
-    const std::tm* utc_tm = std::gmtime(&now);
-
-    // Format position report using ostringstream with "C" locale to ensure decimal points, not commas
-    std::ostringstream oss;
-    oss.imbue(std::locale::classic());
-    oss << callSign << ">APRS,TCPIP*: /"
-        << std::setfill('0') << std::setw(2) << utc_tm->tm_hour
-        << std::setw(2) << utc_tm->tm_min
-        << std::setw(2) << utc_tm->tm_sec
-        << "h" << formatLatitude(latitude)
-        << lastSymbol[0] << formatLongitude(longitude)
-        << lastSymbol[1]
-        << std::setw(3) << static_cast<int>(course) << "/"
-        << std::setw(3) << static_cast<int>(speed) << "/A="
-        << std::setw(6) << static_cast<int>(altitudeFeet) << "\n";
-
-    return oss.str();
-}
-
-std::string OgnParser::formatLatitude(double latitude)
-{
-    // e.g. "5111.32N"
-    const char* direction = latitude >= 0 ? "N" : "S";
-    latitude = std::abs(latitude);
-    int const degrees = static_cast<int>(latitude);
-    double const minutes = (latitude - degrees) * 60.0;
-    
-    // Use ostringstream with "C" locale to ensure decimal points, not commas
-    std::ostringstream oss;
-    oss.imbue(std::locale::classic());
-    oss << std::setfill('0') << std::setw(2) << degrees
-        << std::fixed << std::setprecision(2) << std::setw(5) << minutes
-        << direction;
-    return oss.str();
-}
-
-std::string OgnParser::formatLongitude(double longitude)
-{
-    // e.g. "00102.04W"
-    const char* direction = longitude >= 0 ? "E" : "W";
-    longitude = std::abs(longitude);
-    int const degrees = static_cast<int>(longitude);
-    double const minutes = (longitude - degrees) * 60.0;
-    
-    // Use ostringstream with "C" locale to ensure decimal points, not commas
-    std::ostringstream oss;
-    oss.imbue(std::locale::classic());
-    oss << std::setfill('0') << std::setw(3) << degrees
-        << std::fixed << std::setprecision(2) << std::setw(5) << minutes
-        << direction;
-    return oss.str();
-}
-
-std::string OgnParser::calculatePassword(std::string_view callSign)
-{
-    // APRS-IS passcode calculation: Sum of ASCII values of the first 6 characters of the call sign
-    // e.g. "ENR12345" -> 379
-    int sum = 0;
-    for (size_t i = 0; i < callSign.length() && i < 6; ++i)
-    {
-        sum += static_cast<unsigned char>(callSign[i]);
-    }
-    return std::to_string(sum % 10000);
+    // Current UTC time of day. POSIX time has exactly 86400 seconds per day.
+    auto const secondOfDay = static_cast<int>(std::time(nullptr) % 86400);
+
+    BufferWriter writer(buffer, size);
+    writer.append(callSign);
+    writer.append(">APRS,TCPIP*: /");
+    writer.appendInteger(secondOfDay / 3600, 2);
+    writer.appendInteger((secondOfDay / 60) % 60, 2);
+    writer.appendInteger(secondOfDay % 60, 2);
+    writer.append('h');
+    appendCoordinate(writer, latitude, 2, 'N', 'S');
+    writer.append(symbol.table);
+    appendCoordinate(writer, longitude, 3, 'E', 'W');
+    writer.append(symbol.code);
+    writer.appendInteger(toInt(course), 3);
+    writer.append('/');
+    writer.appendInteger(toInt(speed), 3);
+    writer.append("/A=");
+    writer.appendInteger(toInt(altitudeFeet), 6);
+    writer.append('\n');
+    return writer.size();
 }
 
-std::string OgnParser::formatLoginString(std::string_view callSign,
-                                      double latitude,
-                                      double longitude,
-                                      unsigned int receiveRadius,
-                                      std::string_view appName,
-                                      std::string_view appVersion)
+void OgnParser::formatPositionReport(std::string& out,
+                                     std::string_view callSign,
+                                     double latitude,
+                                     double longitude,
+                                     double altitude,
+                                     double course,
+                                     double speed,
+                                     OgnAircraftType aircraftType)
+{
+    appendFormatted(out, callSign.size() + MaximumFormatOverhead, [&](char* buffer, std::size_t size) {
+        return formatPositionReport(buffer, size, callSign, latitude, longitude, altitude, course, speed, aircraftType);
+    });
+}
+
+std::string OgnParser::formatPositionReport(std::string_view callSign,
+                                            double latitude,
+                                            double longitude,
+                                            double altitude,
+                                            double course,
+                                            double speed,
+                                            OgnAircraftType aircraftType)
+{
+    std::string result;
+    formatPositionReport(result, callSign, latitude, longitude, altitude, course, speed, aircraftType);
+    return result;
+}
+
+std::size_t OgnParser::formatLoginString(char* buffer,
+                                         std::size_t size,
+                                         std::string_view callSign,
+                                         double latitude,
+                                         double longitude,
+                                         unsigned int receiveRadius,
+                                         std::string_view appName,
+                                         std::string_view appVersion)
 {
     // e.g. "user ENR12345 pass 379 vers Akaflieg-Freiburg Enroute 1.99 filter r/-48.0000/7.8512/99 t/o\n"
-    std::string const password = calculatePassword(callSign);
-    std::string const filter = formatFilter(latitude, longitude, receiveRadius);
-    
+    BufferWriter writer(buffer, size);
+    writer.append("user ");
+    writer.append(callSign);
+    writer.append(" pass ");
+    writer.appendInteger(calculatePassword(callSign));
+    writer.append(" vers ");
+    writer.append(appName);
+    writer.append(' ');
+    writer.append(appVersion);
+    writer.append(' ');
+    appendFilter(writer, latitude, longitude, receiveRadius);
+    writer.append('\n');
+    return writer.size();
+}
+
+void OgnParser::formatLoginString(std::string& out,
+                                  std::string_view callSign,
+                                  double latitude,
+                                  double longitude,
+                                  unsigned int receiveRadius,
+                                  std::string_view appName,
+                                  std::string_view appVersion)
+{
+    appendFormatted(out, callSign.size() + appName.size() + appVersion.size() + MaximumFormatOverhead, [&](char* buffer, std::size_t size) {
+        return formatLoginString(buffer, size, callSign, latitude, longitude, receiveRadius, appName, appVersion);
+    });
+}
+
+std::string OgnParser::formatLoginString(std::string_view callSign,
+                                         double latitude,
+                                         double longitude,
+                                         unsigned int receiveRadius,
+                                         std::string_view appName,
+                                         std::string_view appVersion)
+{
     std::string result;
-    result.reserve(200);
-    result += "user ";
-    result += callSign;
-    result += " pass ";
-    result += password;
-    result += " vers ";
-    result += appName;
-    result += " ";
-    result += appVersion;
-    result += " ";
-    result += filter;
-    result += "\n";
-    
+    formatLoginString(result, callSign, latitude, longitude, receiveRadius, appName, appVersion);
     return result;
 }
 
-std::string OgnParser::formatFilter(double latitude, double longitude, unsigned int receiveRadius)
+std::size_t OgnParser::formatFilterCommand(char* buffer, std::size_t size, double latitude, double longitude, unsigned int receiveRadiusKm)
+{
+    // e.g. "# filter r/-48.0000/7.8512/99 t/o\n"
+    BufferWriter writer(buffer, size);
+    writer.append("# ");
+    appendFilter(writer, latitude, longitude, receiveRadiusKm);
+    writer.append('\n');
+    return writer.size();
+}
+
+void OgnParser::formatFilterCommand(std::string& out, double latitude, double longitude, unsigned int receiveRadiusKm)
 {
-    // e.g. "filter r/-48.0000/7.8512/99 t/o"
-    // Use ostringstream with "C" locale to ensure decimal points, not commas
-    std::ostringstream oss;
-    oss.imbue(std::locale::classic());
-    oss << "filter r/"
-        << std::fixed << std::setprecision(4) << latitude << "/"
-        << std::fixed << std::setprecision(4) << longitude << "/"
-        << receiveRadius << " t/o";
-    return oss.str();
+    appendFormatted(out, MaximumFormatOverhead, [&](char* buffer, std::size_t size) {
+        return formatFilterCommand(buffer, size, latitude, longitude, receiveRadiusKm);
+    });
 }
 
 std::string OgnParser::formatFilterCommand(double latitude, double longitude, unsigned int receiveRadiusKm)
 {
-    // e.g. "# filter r/-48.0000/7.8512/99 t/o\n"
-    // Use ostringstream with "C" locale to ensure decimal points, not commas
-    std::ostringstream oss;
-    oss.imbue(std::locale::classic());
-    oss << "# filter r/"
-        << std::fixed << std::setprecision(4) << latitude << "/"
-        << std::fixed << std::setprecision(4) << longitude << "/"
-        << receiveRadiusKm << " t/o\n";
-    return oss.str();
+    std::string result;
+    formatFilterCommand(result, latitude, longitude, receiveRadiusKm);
+    return result;
 }
 
 } // namespace Ogn
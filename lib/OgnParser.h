@@ -21,13 +21,59 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <string>
 #include <string_view>
+#include <type_traits>
+#include <vector>
 
 namespace Ogn {
 struct OgnMessage;
+struct OgnMessageData;
+struct OgnMessageView;
+class OgnPreFilter;
+
+/*! \brief Bits of the field mask passed to OgnParser::parseAprsisMessage
+ *
+ *  The first group selects message types. Sentences of other types are
+ *  rejected after a quick check and left as OgnMessageType::UNKNOWN; the
+ *  other members of rejected messages are unspecified. The second group
+ *  selects the fields that are decoded. Fields that are not selected keep
+ *  their default values. The message type, sourceId and symbol are always
+ *  set.
+ */
+namespace OgnField {
+// Message types
+constexpr uint32_t TrafficReports = 1U << 0;
+constexpr uint32_t WeatherReports = 1U << 1;
+constexpr uint32_t StatusMessages = 1U << 2;
+constexpr uint32_t Comments = 1U << 3;
+constexpr uint32_t AllMessages = TrafficReports | WeatherReports | StatusMessages | Comments;
+
+// Fields of traffic and weather reports
+constexpr uint32_t Timestamp = 1U << 8;      // timestamp
+constexpr uint32_t Position = 1U << 9;       // latitude, longitude
+constexpr uint32_t Altitude = 1U << 10;      // altitude
+constexpr uint32_t CourseSpeed = 1U << 11;   // course, speed
+constexpr uint32_t AircraftID = 1U << 12;    // aircraftID, address, addressType, aircraftType, stealthMode, noTrackingFlag
+constexpr uint32_t VerticalSpeed = 1U << 13; // verticalSpeed
+constexpr uint32_t RotationRate = 1U << 14;  // rotationRate, turnRate
+constexpr uint32_t Reception = 1U << 15;     // signalStrength, errorCount, frequencyOffset
+constexpr uint32_t FlightLevel = 1U << 16;   // flightlevel
+constexpr uint32_t FlightNumber = 1U << 17;  // flightnumber
+constexpr uint32_t Squawk = 1U << 18;        // squawk
+constexpr uint32_t GpsInfo = 1U << 19;       // gpsInfo
+constexpr uint32_t Weather = 1U << 20;       // wind_direction, wind_speed, wind_gust_speed, temperature, humidity, pressure
+constexpr uint32_t Route = 1U << 21;         // destination, receiver
+
+// Fields of status messages
+constexpr uint32_t ReceiverStatus = 1U << 22; // version, platform, cpuLoad, ramFree, ramTotal, ntpOffset, ntpCorrection, cpuTemperature
+constexpr uint32_t AllFields = 0xFFFFFF00U;
+
+constexpr uint32_t All = AllMessages | AllFields;
+} // namespace OgnField
 
 /*! \brief Aircraft type for OGN messages
  *
@@ -63,16 +109,137 @@ enum class OgnAircraftType
 * \see https://github.com/svoop/ogn_client-ruby/wiki/SenderBeacon
 *
 * This class is used in the UnitTest. It should not have external dependencies like GlobalObject.
+*
+* All methods are reentrant and thread-safe: they keep no mutable static
+* state and do not depend on the global locale. Several threads may parse
+* and format concurrently, as long as each message is accessed by one
+* thread at a time.
 */
 class OgnParser {
 public:
     static void parseAprsisMessage(OgnMessage& ognMessage);
+
+    /*! \brief Parse the sentence referenced by an OgnMessageView
+     *
+     *  The member sentence must be set, all other members are expected to
+     *  have default values. Parsing does not allocate.
+     */
+    static void parseAprsisMessage(OgnMessageView& ognMessage);
+
+    /*! \brief Parse selected message types and fields only
+     *
+     *  Parts of the sentence that are not needed for the selected fields
+     *  are skipped.
+     *
+     *  \param ognMessage Message, as for the overloads without field mask
+     *  \param fieldMask Combination of the bits in namespace OgnField
+     */
+    static void parseAprsisMessage(OgnMessage& ognMessage, uint32_t fieldMask);
+    static void parseAprsisMessage(OgnMessageView& ognMessage, uint32_t fieldMask);
+
+    /*! \brief Parse traffic and weather reports that pass a pre-filter only
+     *
+     *  Reports rejected by the pre-filter are left as OgnMessageType::UNKNOWN,
+     *  at the cost of a few comparisons.
+     *
+     *  \param ognMessage Message, as for the overloads without pre-filter
+     *  \param preFilter Pre-filter, see OgnPreFilter
+     *  \param fieldMask Combination of the bits in namespace OgnField
+     */
+    static void parseAprsisMessage(OgnMessage& ognMessage, const OgnPreFilter& preFilter, uint32_t fieldMask = OgnField::All);
+    static void parseAprsisMessage(OgnMessageView& ognMessage, const OgnPreFilter& preFilter, uint32_t fieldMask = OgnField::All);
+
+    /*! \brief Parse all sentences contained in a receive buffer
+     *
+     *  The chunk is split at '\n' (a trailing '\r' is removed), empty lines
+     *  are skipped. A final line without terminating newline is parsed as
+     *  well, so callers reading from a stream should pass complete lines only.
+     *
+     *  The vector is cleared and receives one message per line. All members
+     *  of the messages, including OgnMessageView::sentence, point directly
+     *  into the chunk, which must therefore outlive the messages. The vector
+     *  keeps its capacity, so that repeated calls with a reused vector do not
+     *  allocate.
+     *
+     *  \param chunk Receive buffer containing one or more sentences
+     *  \param ognMessages Vector that receives the parsed messages
+     *  \param fieldMask Message types and fields to parse, see OgnField
+     *  \return Number of messages parsed
+     */
+    static std::size_t parseAprsisBatch(std::string_view chunk, std::vector<OgnMessageView>& ognMessages, uint32_t fieldMask = OgnField::All);
+
+    /*! \brief Parse all sentences of a receive buffer that pass a pre-filter
+     *
+     *  As the overload without pre-filter, but lines rejected by the
+     *  pre-filter are not added to the vector.
+     *
+     *  \return Number of messages parsed
+     */
+    static std::size_t parseAprsisBatch(std::string_view chunk, std::vector<OgnMessageView>& ognMessages, const OgnPreFilter& preFilter, uint32_t fieldMask = OgnField::All);
+
+    /*! \brief Space needed by the format functions, besides their string arguments
+     *
+     *  A buffer of MaximumFormatOverhead characters plus the sizes of all
+     *  std::string_view arguments is always large enough.
+     */
+    static constexpr std::size_t MaximumFormatOverhead = 128;
+
+    /*! \brief Login string for APRS-IS, with range filter
+     *
+     *  e.g. "user ENR12345 pass 379 vers Enroute 1.99 filter r/-48.0000/7.8512/99 t/o\n"
+     *
+     *  The overloads that write into a char buffer or append to a
+     *  std::string do not use the locale and do not allocate, unless the
+     *  std::string needs to grow.
+     *
+     *  \return Number of characters written, or 0 if the buffer is too
+     *  small. The output is not null-terminated.
+     */
+    static std::size_t formatLoginString(char* buffer,
+                                         std::size_t size,
+                                         std::string_view callSign,
+                                         double latitude,
+                                         double longitude,
+                                         unsigned int receiveRadius,
+                                         std::string_view appName,
+                                         std::string_view appVersion);
+    static void formatLoginString(std::string& out,
+                                  std::string_view callSign,
+                                  double latitude,
+                                  double longitude,
+                                  unsigned int receiveRadius,
+                                  std::string_view appName,
+                                  std::string_view appVersion);
     static std::string formatLoginString(std::string_view callSign,
                                          double latitude,
                                          double longitude,
                                          unsigned int receiveRadius,
                                          std::string_view appName,
                                          std::string_view appVersion);
+
+    /*! \brief Position report of the own aircraft, with the current time
+     *
+     *  e.g. "ENR12345>APRS,TCPIP*: /074548h5111.32N/00102.04W'086/007/A=000607\n"
+     *
+     *  \see formatLoginString for the overloads
+     */
+    static std::size_t formatPositionReport(char* buffer,
+                                            std::size_t size,
+                                            std::string_view callSign,
+                                            double latitude,
+                                            double longitude,
+                                            double altitude,
+                                            double course,
+                                            double speed,
+                                            OgnAircraftType aircraftType);
+    static void formatPositionReport(std::string& out,
+                                     std::string_view callSign,
+                                     double latitude,
+                                     double longitude,
+                                     double altitude,
+                                     double course,
+                                     double speed,
+                                     OgnAircraftType aircraftType);
     static std::string formatPositionReport(std::string_view callSign,
                                             double latitude,
                                             double longitude,
@@ -80,18 +247,47 @@ public:
                                             double course,
                                             double speed,
                                             OgnAircraftType aircraftType);
+
+    /*! \brief Command that changes the range filter of a connection
+     *
+     *  e.g. "# filter r/-48.0000/7.8512/99 t/o\n"
+     *
+     *  \see formatLoginString for the overloads
+     */
+    static std::size_t formatFilterCommand(char* buffer, std::size_t size, double latitude, double longitude, unsigned int receiveRadiusKm);
+    static void formatFilterCommand(std::string& out, double latitude, double longitude, unsigned int receiveRadiusKm);
     static std::string formatFilterCommand(double latitude, double longitude, unsigned int receiveRadiusKm);
 
-private:
-    static std::string formatFilter(double latitude, double longitude, unsigned int receiveRadius);
-    static std::string formatLatitude(double latitude);
-    static std::string formatLongitude(double longitude);
-    static std::string calculatePassword(std::string_view callSign);
+    /*! \brief Decode an APRS latitude
+     *
+     *  The decoder works on integers only and gives identical results on
+     *  all platforms, independent of the locale.
+     *
+     *  \param nmeaLatitude Latitude in the fixed format "DDMM.MM", e.g. "5111.32"
+     *  \param latitudeDirection 'N' or 'S'
+     *  \param latEnhancement Precision enhancement digit as in "!W91!", or '\0'
+     *  \return Latitude in degrees, or NaN if the input is invalid
+     */
     static double decodeLatitude(std::string_view nmeaLatitude, char latitudeDirection, char latEnhancement);
+
+    /*! \brief Decode an APRS longitude
+     *
+     *  \param nmeaLongitude Longitude in the fixed format "DDDMM.MM", e.g. "00102.04"
+     *  \param longitudeDirection 'E' or 'W'
+     *  \param lonEnhancement Precision enhancement digit as in "!W91!", or '\0'
+     *  \return Longitude in degrees, or NaN if the input is invalid
+     *
+     *  \see decodeLatitude
+     */
     static double decodeLongitude(std::string_view nmeaLongitude, char longitudeDirection, char lonEnhancement);
-    static void parseTrafficReport(OgnMessage &ognMessage, std::string_view header, std::string_view body);
-    static void parseCommentMessage(OgnMessage& ognMessage);
-    static void parseStatusMessage(OgnMessage &ognMessage, std::string_view header, std::string_view body);
+
+private:
+    static std::size_t parseBatch(std::string_view chunk, std::vector<OgnMessageView>& ognMessages, uint32_t fieldMask, const OgnPreFilter* preFilter);
+    // Returns false if the sentence is rejected by the pre-filter
+    static bool parseSentence(OgnMessageData& ognMessage, std::string_view sentence, uint32_t fieldMask, const OgnPreFilter* preFilter = nullptr);
+    static void parseTrafficReport(OgnMessageData &ognMessage, std::string_view header, std::string_view body, uint32_t fieldMask);
+    static void parseCommentMessage(OgnMessageData& ognMessage);
+    static void parseStatusMessage(OgnMessageData &ognMessage, std::string_view header, std::string_view body, uint32_t fieldMask);
 };
 
 enum class OgnMessageType
@@ -126,9 +322,18 @@ enum class OgnSymbol
     WEATHERSTATION,
 };
 
-struct OgnMessage
+/*! \brief Data parsed from an OGN sentence
+ *
+ *  This struct contains all fields of a parsed sentence, but not the
+ *  sentence itself. The std::string_view members point into the sentence
+ *  that has been parsed. Use OgnMessage if the message shall own its
+ *  sentence, or OgnMessageView if the sentence is stored elsewhere.
+ */
+struct OgnMessageData
 {
-    std::string sentence;       // e.g. "FLRDDE626>APRS,qAS,EGHL:/074548h5111.32N/00102.04W'086/007/A=000607 id0ADDE626 -019fpm +0.0rot 5.5dB 3e -4.3kHz"
+    //! Value of addressValue if the sentence has no valid aircraft ID
+    static constexpr uint32_t InvalidAddress = std::numeric_limits<uint32_t>::max();
+
     OgnMessageType type = OgnMessageType::UNKNOWN; // e.g. OgnMessageType::TRAFFIC_REPORT
 
     std::string_view sourceId;       // like ENROUTE12345
@@ -140,9 +345,11 @@ struct OgnMessage
 
     double course = {};         // course in degrees
     double speed = {};          // speed in knots
-    std::string_view aircraftID;     // aircraft ID, e.g. "id0ADDE626"
+    std::string_view aircraftID;     // aircraft ID, e.g. "0ADDE626" for "id0ADDE626"
+    uint32_t aircraftIDValue = {};   // aircraft ID as number, e.g. 0x0ADDE626; 0 if there is none
     double verticalSpeed = {};  // in m/s
     std::string_view rotationRate;   // like "+0.0rot"
+    double turnRate = {};       // degrees per second, positive clockwise; decoded from rotationRate
     std::string_view signalStrength; // like "5.5dB"
     std::string_view errorCount;     // like "3e"
     std::string_view frequencyOffset;// like "-4.3kHz"
@@ -153,19 +360,41 @@ struct OgnMessage
     OgnAircraftType aircraftType = OgnAircraftType::unknown; // e.g., "Glider", "Tow Plane", etc.
     OgnAddressType addressType = OgnAddressType::UNKNOWN; // e.g., "ICAO", "FLARM", "OGN Tracker"
     std::string_view address;        // like "4D21C2"
+    uint32_t addressValue = InvalidAddress; // 24-bit address as number, like 0x4D21C2
     bool stealthMode = false;   // true if the aircraft shall be hidden
     bool noTrackingFlag = false;// true if the aircraft shall not be tracked
 
+    // Bits of weatherFields: weather quantities that the report contains
+    static constexpr uint8_t HasWindDirection = 0x01;
+    static constexpr uint8_t HasWindSpeed = 0x02;
+    static constexpr uint8_t HasWindGustSpeed = 0x04;
+    static constexpr uint8_t HasTemperature = 0x08;
+    static constexpr uint8_t HasHumidity = 0x10;
+    static constexpr uint8_t HasPressure = 0x20;
+
     uint32_t wind_direction = {};  // degree 0..359
     uint32_t wind_speed = {};      // m/s
     uint32_t wind_gust_speed = {}; // m/s
-    uint32_t temperature = {};     // degree C
+    uint32_t temperature = {};     // degree Fahrenheit, as in APRS. Signed: read as static_cast<int32_t>(temperature)
     uint32_t humidity = {};        // percent
     double pressure = {};          // hPa
+    uint8_t weatherFields = 0;     // HasWindDirection, HasWindSpeed, ...; unreported quantities are 0
+
+    std::string_view destination;    // like "OGFLR", or "OGNSDR" for receivers
+    std::string_view receiver;       // receiver that relayed the sentence, like "EGHL" in "qAS,EGHL"; empty for stations connected to APRS-IS directly
+
+    // Receiver status, e.g. ">222247h v0.3.2.arm64 CPU:0.9 RAM:278.4/951.4MB NTP:0.6ms/-2.0ppm +54.2C"
+    std::string_view version;        // like "0.3.2"
+    std::string_view platform;       // like "arm64"
+    double cpuLoad = std::numeric_limits<double>::quiet_NaN();
+    double ramFree = std::numeric_limits<double>::quiet_NaN();        // MB
+    double ramTotal = std::numeric_limits<double>::quiet_NaN();       // MB
+    double ntpOffset = std::numeric_limits<double>::quiet_NaN();      // ms
+    double ntpCorrection = std::numeric_limits<double>::quiet_NaN();  // ppm
+    double cpuTemperature = std::numeric_limits<double>::quiet_NaN(); // degree C
 
     void reset()
     {
-        sentence.clear();
         type = OgnMessageType::UNKNOWN;
         sourceId = std::string_view();       
         timestamp = std::string_view();      
@@ -176,8 +405,10 @@ struct OgnMessage
         course = 0.0;
         speed = 0.0;
         aircraftID = std::string_view();     
+        aircraftIDValue = 0;
         verticalSpeed = 0.0;
-        rotationRate = std::string_view();   
+        rotationRate = std::string_view();
+        turnRate = 0.0;   
         signalStrength = std::string_view(); 
         errorCount = std::string_view();     
         frequencyOffset = std::string_view();
@@ -188,6 +419,7 @@ struct OgnMessage
         aircraftType = OgnAircraftType::unknown;
         addressType = OgnAddressType::UNKNOWN;
         address = std::string_view();        
+        addressValue = InvalidAddress;
         stealthMode = false;
         noTrackingFlag = false;
         wind_direction = 0;
@@ -196,6 +428,67 @@ struct OgnMessage
         temperature = 0;
         humidity = 0;
         pressure = 0.0;
+        weatherFields = 0;
+        destination = std::string_view();
+        receiver = std::string_view();
+        version = std::string_view();
+        platform = std::string_view();
+        cpuLoad = std::numeric_limits<double>::quiet_NaN();
+        ramFree = std::numeric_limits<double>::quiet_NaN();
+        ramTotal = std::numeric_limits<double>::quiet_NaN();
+        ntpOffset = std::numeric_limits<double>::quiet_NaN();
+        ntpCorrection = std::numeric_limits<double>::quiet_NaN();
+        cpuTemperature = std::numeric_limits<double>::quiet_NaN();
+    }
+};
+
+/*! \brief Parsed OGN message that owns its sentence
+ *
+ *  The std::string_view members point into the member sentence. The views
+ *  of a copy still refer to the original, and moving a message can leave
+ *  them dangling, because short sentences are stored inside the std::string
+ *  object itself. Use OgnMessageView to store or pass parsed messages.
+ */
+struct OgnMessage : OgnMessageData
+{
+    std::string sentence;       // e.g. "FLRDDE626>APRS,qAS,EGHL:/074548h5111.32N/00102.04W'086/007/A=000607 id0ADDE626 -019fpm +0.0rot 5.5dB 3e -4.3kHz"
+
+    void reset()
+    {
+        sentence.clear();
+        OgnMessageData::reset();
+    }
+
+    // Non-owning view of this message, valid as long as this message is neither modified nor destroyed
+    [[nodiscard]] OgnMessageView view() const;
+};
+
+/*! \brief Parsed OGN message that refers to a sentence stored elsewhere
+ *
+ *  All members, including the sentence, are views into a buffer that is
+ *  owned by the caller, for instance a receive buffer handed to
+ *  OgnParser::parseAprsisBatch. The struct is trivially copyable, so
+ *  messages can be stored in arrays and passed between threads by value,
+ *  as long as the buffer outlives them.
+ */
+struct OgnMessageView : OgnMessageData
+{
+    std::string_view sentence;  // e.g. "FLRDDE626>APRS,qAS,EGHL:/074548h5111.32N/00102.04W'086/007/A=000607 id0ADDE626 -019fpm +0.0rot 5.5dB 3e -4.3kHz"
+
+    void reset()
+    {
+        sentence = std::string_view();
+        OgnMessageData::reset();
     }
 };
+
+static_assert(std::is_trivially_copyable_v<OgnMessageView>, "OgnMessageView must be trivially copyable");
+
+inline OgnMessageView OgnMessage::view() const
+{
+    OgnMessageView result;
+    static_cast<OgnMessageData&>(result) = *this;
+    result.sentence = sentence;
+    return result;
+}
 }
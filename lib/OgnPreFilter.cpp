@@ -0,0 +1,118 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "OgnPreFilter.h"
+
+#include <algorithm>
+#include <charconv>
+#include <utility>
+
+namespace {
+
+// Value of the "id" item, e.g. 0x0ADDE626 for "id0ADDE626"
+bool findAircraftID(std::string_view body, uint32_t& hexcode)
+{
+    auto const index = body.find(" id");
+    if (index == std::string_view::npos) {
+        return false;
+    }
+    char const* const first = body.data() + index + 3;
+    char const* const last = body.data() + body.size();
+    auto const result = std::from_chars(first, last, hexcode, 16);
+    return result.ec == std::errc{} && (result.ptr - first) == 8;
+}
+
+} // namespace
+
+namespace Ogn {
+
+void OgnPreFilter::setBoundingBox(double south, double west, double north, double east)
+{
+    m_hasBoundingBox = true;
+    m_south = south;
+    m_west = west;
+    m_north = north;
+    m_east = east;
+}
+
+void OgnPreFilter::setAllowedAddresses(std::vector<uint32_t> addresses)
+{
+    std::sort(addresses.begin(), addresses.end());
+    m_allowed = std::move(addresses);
+}
+
+void OgnPreFilter::setDeniedAddresses(std::vector<uint32_t> addresses)
+{
+    std::sort(addresses.begin(), addresses.end());
+    m_denied = std::move(addresses);
+}
+
+bool OgnPreFilter::checksAircraftID() const
+{
+    return !m_allowed.empty() || !m_denied.empty() || m_addressTypes != AllAddressTypes || m_rejectStealth || m_rejectNoTracking;
+}
+
+bool OgnPreFilter::accepts(std::string_view body) const
+{
+    // In this function
+    // avoid heap allocations for performance reasons.
+
+    // e.g. body = "/074548h5111.32N/00102.04W'086/007/A=000607 id0ADDE626 -019fpm +0.0rot 5.5dB 3e -4.3kHz"
+    if (m_hasBoundingBox) {
+        if (body.size() < 26) {
+            return false;
+        }
+        double const latitude = OgnParser::decodeLatitude(body.substr(8, 7), body[15], '\0');
+        double const longitude = OgnParser::decodeLongitude(body.substr(17, 8), body[25], '\0');
+        // Comparisons with NaN are false
+        if (!(latitude >= m_south && latitude <= m_north)) {
+            return false;
+        }
+        bool const insideLongitude = (m_west <= m_east) ? (longitude >= m_west && longitude <= m_east)
+                                                        : (longitude >= m_west || longitude <= m_east);
+        if (!insideLongitude) {
+            return false;
+        }
+    }
+
+    if (!checksAircraftID()) {
+        return true;
+    }
+    uint32_t hexcode = 0;
+    if (!findAircraftID(body, hexcode)) {
+        return m_allowed.empty() && (m_addressTypes & addressTypeBit(OgnAddressType::UNKNOWN)) != 0;
+    }
+    if (m_rejectStealth && (hexcode & 0x80000000) != 0) {
+        return false;
+    }
+    if (m_rejectNoTracking && (hexcode & 0x40000000) != 0) {
+        return false;
+    }
+    if (((m_addressTypes >> ((hexcode >> 24) & 0x3)) & 1U) == 0) {
+        return false;
+    }
+    uint32_t const address = hexcode & 0xFFFFFF;
+    if (!m_allowed.empty() && !std::binary_search(m_allowed.begin(), m_allowed.end(), address)) {
+        return false;
+    }
+    return !std::binary_search(m_denied.begin(), m_denied.end(), address);
+}
+
+} // namespace Ogn
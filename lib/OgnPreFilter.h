@@ -0,0 +1,118 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "OgnParser.h"
+
+namespace Ogn {
+
+/*! \brief Cheap rejection of unwanted traffic and weather reports
+ *
+ *  A pre-filter is passed to OgnParser::parseAprsisMessage or
+ *  OgnParser::parseAprsisBatch. The parser consults it right after
+ *  splitting header and body, before coordinates are decoded and the OGN
+ *  part is tokenized. Rejected sentences stay OgnMessageType::UNKNOWN, as
+ *  with the field mask.
+ *
+ *  The filter checks the bounding box on the position found at its fixed
+ *  offset in the body, and then the flags, address type and address in the
+ *  "id" item. Reports without "id" item, such as weather reports and
+ *  receiver beacons, have address type UNKNOWN and no address.
+ *
+ *  Status and comment messages are never rejected by the pre-filter; use
+ *  the field mask for those. A default-constructed filter accepts everything.
+ */
+class OgnPreFilter
+{
+public:
+    //! Address type mask with all address types
+    static constexpr uint32_t AllAddressTypes = 0xF;
+
+    //! Bit of an address type in the address type mask
+    static constexpr uint32_t addressTypeBit(OgnAddressType addressType) { return 1U << static_cast<uint32_t>(addressType); }
+
+    /*! \brief Accept reports inside a bounding box only
+     *
+     *  Reports without valid position are rejected. The box is checked on
+     *  the position without precision enhancement, which differs from the
+     *  decoded position by less than 0.0002 degrees.
+     *
+     *  \param south Southern boundary in degrees
+     *  \param west Western boundary in degrees
+     *  \param north Northern boundary in degrees
+     *  \param east Eastern boundary in degrees. If east is less than west,
+     *  the box crosses the antimeridian.
+     */
+    void setBoundingBox(double south, double west, double north, double east);
+
+    //! Accept reports at all positions
+    void clearBoundingBox() { m_hasBoundingBox = false; }
+
+    /*! \brief Accept reports from these 24-bit addresses only
+     *
+     *  An empty list accepts all addresses, including reports without
+     *  address. A non-empty list rejects reports without address.
+     */
+    void setAllowedAddresses(std::vector<uint32_t> addresses);
+
+    //! Reject reports from these 24-bit addresses
+    void setDeniedAddresses(std::vector<uint32_t> addresses);
+
+    //! Accept these address types only, as combination of addressTypeBit
+    void setAddressTypes(uint32_t mask) { m_addressTypes = mask; }
+
+    //! Reject aircraft that have stealth mode set
+    void setRejectStealth(bool reject) { m_rejectStealth = reject; }
+
+    //! Reject aircraft that have the no-tracking flag set
+    void setRejectNoTracking(bool reject) { m_rejectNoTracking = reject; }
+
+    /*! \brief Check the body of a traffic or weather report
+     *
+     *  \param body Body of the sentence, as following the first ':'
+     *  \return True if the report passes the filter
+     */
+    [[nodiscard]] bool accepts(std::string_view body) const;
+
+private:
+    // True if a check of the "id" item is needed
+    [[nodiscard]] bool checksAircraftID() const;
+
+    bool m_hasBoundingBox = false;
+    double m_south = 0.0;
+    double m_west = 0.0;
+    double m_north = 0.0;
+    double m_east = 0.0;
+
+    // Sorted
+    std::vector<uint32_t> m_allowed;
+    std::vector<uint32_t> m_denied;
+
+    uint32_t m_addressTypes = AllAddressTypes;
+    bool m_rejectStealth = false;
+    bool m_rejectNoTracking = false;
+};
+
+} // namespace Ogn
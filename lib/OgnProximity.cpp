@@ -0,0 +1,194 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "OgnProximity.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double DegreesToRadians = 3.14159265358979323846 / 180.0;
+constexpr double EarthRadiusMeters = 6371008.8;
+constexpr double KnotsToMetersPerSecond = 1852.0 / 3600.0;
+
+} // namespace
+
+namespace Ogn {
+
+OgnProximityMonitor::OgnProximityMonitor(double horizontalThreshold, double verticalThreshold, double lookAhead)
+    : m_horizontalThreshold(std::max(horizontalThreshold, 0.0))
+    , m_verticalThreshold(std::max(verticalThreshold, 0.0))
+    , m_lookAhead(std::max(lookAhead, 0.0))
+{
+}
+
+void OgnProximityMonitor::setOwnship(const OgnTrafficTable& table, const OgnOwnship& ownship, double now)
+{
+    m_ownship = ownship;
+    m_ownshipTime = now;
+    m_alerts.clear();
+    if (std::isnan(ownship.latitude) || std::isnan(ownship.longitude)) {
+        return;
+    }
+    m_cosLatitude = std::cos(ownship.latitude * DegreesToRadians);
+
+    // Aircraft that can reach the protected volume in time: both aircraft
+    // move for the look-ahead time, and targets may have moved for up to
+    // the look-ahead time since their last report
+    double const ownSpeed = ownship.speed * KnotsToMetersPerSecond;
+    double const radius = m_horizontalThreshold + m_lookAhead * (ownSpeed + 2.0 * MaximumTargetSpeed);
+    table.findInRadius(ownship.latitude, ownship.longitude, radius / 1000.0, m_candidates);
+
+    OgnProximityAlert alert;
+    for (std::size_t const index : m_candidates) {
+        if (evaluate(table, index, now, alert)) {
+            m_alerts.push_back(alert);
+        }
+    }
+}
+
+bool OgnProximityMonitor::update(const OgnTrafficTable& table, const OgnMessageData& message, double now)
+{
+    uint32_t key = 0;
+    if (!OgnTrafficTable::keyOf(message, key)) {
+        return false;
+    }
+    return update(table, key, now);
+}
+
+bool OgnProximityMonitor::update(const OgnTrafficTable& table, uint32_t key, double now)
+{
+    expire(table);
+    std::size_t const index = table.find(key);
+    OgnProximityAlert alert;
+    if (index == OgnTrafficTable::npos || !evaluate(table, index, now, alert)) {
+        store(key, nullptr);
+        return false;
+    }
+    store(key, &alert);
+    return true;
+}
+
+void OgnProximityMonitor::expire(const OgnTrafficTable& table)
+{
+    m_alerts.erase(std::remove_if(m_alerts.begin(), m_alerts.end(),
+                                  [&table](const OgnProximityAlert& alert) { return table.find(alert.key) == OgnTrafficTable::npos; }),
+                   m_alerts.end());
+}
+
+void OgnProximityMonitor::clear()
+{
+    m_ownship = OgnOwnship();
+    m_alerts.clear();
+}
+
+const OgnProximityAlert* OgnProximityMonitor::mostUrgent() const
+{
+    auto const iterator = std::min_element(m_alerts.begin(), m_alerts.end(), [](const OgnProximityAlert& a, const OgnProximityAlert& b) {
+        return a.timeToClosestApproach < b.timeToClosestApproach;
+    });
+    return iterator == m_alerts.end() ? nullptr : &*iterator;
+}
+
+bool OgnProximityMonitor::evaluate(const OgnTrafficTable& table, std::size_t index, double now, OgnProximityAlert& alert) const
+{
+    if (std::isnan(m_ownship.latitude) || std::isnan(m_ownship.longitude)) {
+        return false;
+    }
+
+    // Local frame around the own position: x east, y north, in meters
+    double const metersPerDegree = EarthRadiusMeters * DegreesToRadians;
+    double const ownCourse = m_ownship.course * DegreesToRadians;
+    double const ownSpeed = m_ownship.speed * KnotsToMetersPerSecond;
+    double const ownVx = ownSpeed * std::sin(ownCourse);
+    double const ownVy = ownSpeed * std::cos(ownCourse);
+    double const ownDt = std::clamp(now - m_ownshipTime, 0.0, m_lookAhead);
+
+    double const course = table.courses()[index] * DegreesToRadians;
+    double const speed = table.speeds()[index] * KnotsToMetersPerSecond;
+    double const vx = speed * std::sin(course);
+    double const vy = speed * std::cos(course);
+    double const dt = std::clamp(now - table.lastSeen()[index], 0.0, m_lookAhead);
+
+    // Relative position now, and relative velocity
+    double const deltaLongitude = std::remainder(table.longitudes()[index] - m_ownship.longitude, 360.0);
+    double const x = deltaLongitude * metersPerDegree * m_cosLatitude + vx * dt - ownVx * ownDt;
+    double const y = (table.latitudes()[index] - m_ownship.latitude) * metersPerDegree + vy * dt - ownVy * ownDt;
+    double const relativeVx = vx - ownVx;
+    double const relativeVy = vy - ownVy;
+
+    // Closest approach in the horizontal plane
+    double const relativeSpeedSquared = relativeVx * relativeVx + relativeVy * relativeVy;
+    double time = 0.0;
+    if (relativeSpeedSquared > 0.0) {
+        time = std::clamp(-(x * relativeVx + y * relativeVy) / relativeSpeedSquared, 0.0, m_lookAhead);
+    }
+    double const closestDistance = std::hypot(x + relativeVx * time, y + relativeVy * time);
+    if (closestDistance > m_horizontalThreshold) {
+        return false;
+    }
+
+    double const altitude = table.altitudes()[index] + table.verticalSpeeds()[index] * dt;
+    double const ownAltitude = m_ownship.altitude + m_ownship.verticalSpeed * ownDt;
+    double const verticalSeparation = altitude - ownAltitude;
+    double const closestVerticalSeparation = verticalSeparation + (table.verticalSpeeds()[index] - m_ownship.verticalSpeed) * time;
+    // Passes if an altitude is unknown and the separation is NaN
+    if (std::fabs(closestVerticalSeparation) > m_verticalThreshold) {
+        return false;
+    }
+
+    alert.key = table.keys()[index];
+    alert.distance = std::hypot(x, y);
+    double const bearing = std::atan2(x, y) / DegreesToRadians;
+    alert.bearing = bearing < 0.0 ? bearing + 360.0 : bearing;
+    alert.verticalSeparation = verticalSeparation;
+    alert.timeToClosestApproach = time;
+    alert.closestDistance = closestDistance;
+    alert.closestVerticalSeparation = closestVerticalSeparation;
+    if (time <= 8.0) {
+        alert.level = OgnAlarmLevel::Urgent;
+    } else if (time <= 13.0) {
+        alert.level = OgnAlarmLevel::Important;
+    } else {
+        alert.level = OgnAlarmLevel::Low;
+    }
+    return true;
+}
+
+void OgnProximityMonitor::store(uint32_t key, const OgnProximityAlert* alert)
+{
+    // Alerts are few, a linear search is fastest
+    auto const iterator = std::find_if(m_alerts.begin(), m_alerts.end(), [key](const OgnProximityAlert& existing) {
+        return existing.key == key;
+    });
+    if (alert == nullptr) {
+        if (iterator != m_alerts.end()) {
+            *iterator = m_alerts.back();
+            m_alerts.pop_back();
+        }
+    } else if (iterator != m_alerts.end()) {
+        *iterator = *alert;
+    } else {
+        m_alerts.push_back(*alert);
+    }
+}
+
+} // namespace Ogn
@@ -0,0 +1,156 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "OgnTrafficTable.h"
+
+namespace Ogn {
+
+/*! \brief State of the own aircraft */
+struct OgnOwnship
+{
+    double latitude = std::numeric_limits<double>::quiet_NaN();  // degrees (WGS84)
+    double longitude = std::numeric_limits<double>::quiet_NaN(); // degrees (WGS84)
+    double altitude = std::numeric_limits<double>::quiet_NaN();  // meters (MSL)
+    double course = 0.0;             // degrees
+    double speed = 0.0;              // knots
+    double verticalSpeed = 0.0;      // m/s
+};
+
+//! Urgency of a proximity alert, from the time to closest approach as with FLARM
+enum class OgnAlarmLevel
+{
+    Low,       // closest approach in more than 13 seconds
+    Important, // closest approach in 9 to 13 seconds
+    Urgent,    // closest approach in 8 seconds or less
+};
+
+/*! \brief Aircraft that comes close to the own aircraft */
+struct OgnProximityAlert
+{
+    uint32_t key = 0;                // see OgnTrafficTable::makeKey
+    OgnAlarmLevel level = OgnAlarmLevel::Low;
+    double distance = 0.0;           // meters, horizontal distance now
+    double bearing = 0.0;            // degrees, direction from the own aircraft now
+    double verticalSeparation = std::numeric_limits<double>::quiet_NaN(); // meters, positive if above, NaN if unknown
+    double timeToClosestApproach = 0.0; // seconds, 0 if the aircraft are diverging
+    double closestDistance = 0.0;    // meters, horizontal distance at closest approach
+    double closestVerticalSeparation = std::numeric_limits<double>::quiet_NaN(); // meters, at closest approach
+};
+
+/*! \brief FLARM-like proximity alerts from the traffic of an OgnTrafficTable
+ *
+ *  The monitor keeps the list of aircraft whose closest approach to the own
+ *  aircraft, within the look-ahead time, falls inside a protected volume
+ *  given by horizontal and vertical thresholds. Both aircraft are assumed
+ *  to fly straight at constant speed. Target positions are first moved
+ *  from the time they were reported to the current time.
+ *
+ *  The monitor works incrementally. Call update() for every traffic report
+ *  after adding it to the table; this evaluates only the one aircraft.
+ *  Call setOwnship() when the own position changes; this re-evaluates the
+ *  aircraft within reach, which are found with the spatial index of the
+ *  table, so that the cost does not grow with the total traffic.
+ *
+ *  Aircraft with unknown altitude, or if the own altitude is unknown, are
+ *  judged by horizontal distance only.
+ *
+ *  The monitor is not thread-safe.
+ */
+class OgnProximityMonitor
+{
+public:
+    /*! \brief Fastest aircraft considered when searching the table, in m/s
+     *
+     *  setOwnship() only looks at aircraft that can reach the protected
+     *  volume within the look-ahead time at this speed.
+     */
+    static constexpr double MaximumTargetSpeed = 300.0;
+
+    /*! \brief Create monitor
+     *
+     *  \param horizontalThreshold Radius of the protected volume in meters
+     *  \param verticalThreshold Half height of the protected volume in meters
+     *  \param lookAhead Closest approaches further in the future are ignored, in seconds
+     */
+    explicit OgnProximityMonitor(double horizontalThreshold = 2000.0, double verticalThreshold = 300.0, double lookAhead = 20.0);
+
+    /*! \brief Set state of the own aircraft and re-evaluate the traffic within reach
+     *
+     *  \param table Traffic table
+     *  \param ownship New state. An invalid position clears all alerts.
+     *  \param now Current time in seconds, on the clock of the table
+     */
+    void setOwnship(const OgnTrafficTable& table, const OgnOwnship& ownship, double now);
+
+    /*! \brief Re-evaluate one aircraft after a traffic report
+     *
+     *  Call after passing message to OgnTrafficTable::update. Aircraft
+     *  that are no longer in the table, for instance because they expired,
+     *  are dropped from the alerts.
+     *
+     *  \return True if the aircraft is now alerted
+     */
+    bool update(const OgnTrafficTable& table, const OgnMessageData& message, double now);
+
+    //! Re-evaluate the aircraft with the given key
+    bool update(const OgnTrafficTable& table, uint32_t key, double now);
+
+    /*! \brief Drop the alerts of aircraft that are no longer in the table
+     *
+     *  Call after OgnTrafficTable::expire, so that alerts do not outlive
+     *  their aircraft while no traffic reports arrive.
+     */
+    void expire(const OgnTrafficTable& table);
+
+    void clear();
+
+    //! Current alerts, in no particular order
+    [[nodiscard]] const std::vector<OgnProximityAlert>& alerts() const { return m_alerts; }
+
+    //! Alert with the shortest time to closest approach, or nullptr
+    [[nodiscard]] const OgnProximityAlert* mostUrgent() const;
+
+private:
+    // Evaluate aircraft at index of the table, returns false if it is no conflict
+    [[nodiscard]] bool evaluate(const OgnTrafficTable& table, std::size_t index, double now, OgnProximityAlert& alert) const;
+
+    // Insert, replace or remove the alert of key
+    void store(uint32_t key, const OgnProximityAlert* alert);
+
+    double m_horizontalThreshold;
+    double m_verticalThreshold;
+    double m_lookAhead;
+
+    OgnOwnship m_ownship;
+    double m_ownshipTime = 0.0;
+    double m_cosLatitude = 1.0;
+
+    std::vector<OgnProximityAlert> m_alerts;
+    std::vector<std::size_t> m_candidates; // reused by setOwnship
+};
+
+} // namespace Ogn
@@ -0,0 +1,167 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "OgnReceiverTable.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double DegreesToRadians = 3.14159265358979323846 / 180.0;
+constexpr double EarthRadiusKm = 6371.0088;
+
+// Great-circle distance (haversine)
+double distanceKm(double latitude1, double longitude1, double latitude2, double longitude2)
+{
+    double const sinHalfLatitude = std::sin((latitude2 - latitude1) * DegreesToRadians / 2.0);
+    double const sinHalfLongitude = std::sin((longitude2 - longitude1) * DegreesToRadians / 2.0);
+    double const a = sinHalfLatitude * sinHalfLatitude
+                     + std::cos(latitude1 * DegreesToRadians) * std::cos(latitude2 * DegreesToRadians) * sinHalfLongitude * sinHalfLongitude;
+    return 2.0 * EarthRadiusKm * std::asin(std::min(std::sqrt(a), 1.0));
+}
+
+// Maximum of the times that are not NaN, or NaN
+double latest(double a, double b)
+{
+    if (std::isnan(a)) {
+        return b;
+    }
+    if (std::isnan(b)) {
+        return a;
+    }
+    return std::max(a, b);
+}
+
+// APRS destination of the position beacons of OGN receivers. Other stations
+// that connect to APRS-IS directly (FANET ground stations "OGNFNT", weather
+// stations, "OGNDVS", ...) are no receivers. Old receiver software sends
+// "APRS".
+bool isReceiverDestination(std::string_view destination)
+{
+    return destination == "OGNSDR" || destination == "OGNSXR" || destination == "APRS";
+}
+
+} // namespace
+
+namespace Ogn {
+
+double OgnReceiver::lastSeen() const
+{
+    return latest(latest(lastStatus, lastPosition), lastRelay);
+}
+
+bool OgnReceiverTable::update(const OgnMessageData& message, double now, bool duplicate)
+{
+    switch (message.type) {
+    case OgnMessageType::STATUS: {
+        if (message.sourceId.empty()) {
+            return false;
+        }
+        OgnReceiver& receiver = findOrInsert(message.sourceId);
+        receiver.version.assign(message.version.data(), message.version.size());
+        receiver.platform.assign(message.platform.data(), message.platform.size());
+        receiver.cpuLoad = message.cpuLoad;
+        receiver.ramFree = message.ramFree;
+        receiver.ramTotal = message.ramTotal;
+        receiver.ntpOffset = message.ntpOffset;
+        receiver.ntpCorrection = message.ntpCorrection;
+        receiver.cpuTemperature = message.cpuTemperature;
+        receiver.lastStatus = now;
+        return true;
+    }
+    case OgnMessageType::TRAFFIC_REPORT:
+        break;
+    default:
+        return false;
+    }
+
+    if (message.receiver.empty()) {
+        // Position beacon of a receiver connected to APRS-IS directly
+        if (message.sourceId.empty() || !isReceiverDestination(message.destination) || std::isnan(message.latitude) || std::isnan(message.longitude)) {
+            return false;
+        }
+        OgnReceiver& receiver = findOrInsert(message.sourceId);
+        receiver.latitude = message.latitude;
+        receiver.longitude = message.longitude;
+        receiver.altitude = message.altitude;
+        receiver.lastPosition = now;
+        return true;
+    }
+
+    // Traffic report relayed by a receiver
+    OgnReceiver& receiver = findOrInsert(message.receiver);
+    receiver.lastRelay = now;
+    receiver.relayedReports++;
+    if (!duplicate) {
+        receiver.uniqueReports++;
+    }
+    if (!std::isnan(receiver.latitude) && !std::isnan(message.latitude)) {
+        double const range = distanceKm(receiver.latitude, receiver.longitude, message.latitude, message.longitude);
+        receiver.maximumRangeKm = std::max(receiver.maximumRangeKm, range);
+    }
+    return true;
+}
+
+void OgnReceiverTable::expire(double now, double timeout)
+{
+    std::size_t index = 0;
+    while (index < m_receivers.size()) {
+        if (now - m_receivers[index].lastSeen() <= timeout) {
+            ++index;
+            continue;
+        }
+
+        // Move the last receiver into the gap
+        std::size_t const last = m_receivers.size() - 1;
+        m_index.erase(m_receivers[index].name);
+        if (index != last) {
+            m_receivers[index] = std::move(m_receivers[last]);
+            m_index.find(m_receivers[index].name)->second = index;
+        }
+        m_receivers.pop_back();
+    }
+}
+
+void OgnReceiverTable::clear()
+{
+    m_index.clear();
+    m_receivers.clear();
+}
+
+std::size_t OgnReceiverTable::find(std::string_view name) const
+{
+    auto const iterator = m_index.find(name);
+    return iterator == m_index.end() ? npos : iterator->second;
+}
+
+OgnReceiver& OgnReceiverTable::findOrInsert(std::string_view name)
+{
+    std::size_t const index = find(name);
+    if (index != npos) {
+        return m_receivers[index];
+    }
+    m_index.emplace(name, m_receivers.size());
+    OgnReceiver& receiver = m_receivers.emplace_back();
+    receiver.name.assign(name.data(), name.size());
+    return receiver;
+}
+
+} // namespace Ogn
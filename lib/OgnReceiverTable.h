@@ -0,0 +1,133 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "OgnParser.h"
+
+namespace Ogn {
+
+/*! \brief What is known about one OGN receiver */
+struct OgnReceiver
+{
+    std::string name;                // callsign, e.g. "EDQG"
+    std::string version;             // software version, e.g. "0.3.2"
+    std::string platform;            // e.g. "arm64"
+
+    // Position, from the receiver's position beacon
+    double latitude = std::numeric_limits<double>::quiet_NaN();  // degrees (WGS84)
+    double longitude = std::numeric_limits<double>::quiet_NaN(); // degrees (WGS84)
+    double altitude = std::numeric_limits<double>::quiet_NaN();  // meters (MSL)
+
+    // Status, from the receiver's status beacon; NaN if not reported
+    double cpuLoad = std::numeric_limits<double>::quiet_NaN();
+    double ramFree = std::numeric_limits<double>::quiet_NaN();        // MB
+    double ramTotal = std::numeric_limits<double>::quiet_NaN();       // MB
+    double ntpOffset = std::numeric_limits<double>::quiet_NaN();      // ms
+    double ntpCorrection = std::numeric_limits<double>::quiet_NaN();  // ppm
+    double cpuTemperature = std::numeric_limits<double>::quiet_NaN(); // degree C
+
+    // Times as passed to OgnReceiverTable::update, NaN if never seen
+    double lastStatus = std::numeric_limits<double>::quiet_NaN();
+    double lastPosition = std::numeric_limits<double>::quiet_NaN();
+    double lastRelay = std::numeric_limits<double>::quiet_NaN();
+
+    uint64_t relayedReports = 0;     // traffic reports relayed, including duplicates
+    uint64_t uniqueReports = 0;      // traffic reports relayed that were not duplicates
+    double maximumRangeKm = 0.0;     // largest distance of a relayed report, if the position is known
+
+    //! Time of the latest beacon or relayed report
+    [[nodiscard]] double lastSeen() const;
+};
+
+/*! \brief Table of OGN receivers, keyed by callsign
+ *
+ *  The table is fed with parsed messages and collects, for every receiver,
+ *  the content of its status beacon (software version, CPU load, memory,
+ *  NTP and temperature), its position and statistics of the traffic
+ *  reports that it relayed. It requires the fields OgnField::Route and
+ *  OgnField::ReceiverStatus.
+ *
+ *  Receivers are identified as follows.
+ *
+ *  - Status messages update the receiver named by their source ID.
+ *  - Position reports of stations that are connected to APRS-IS directly
+ *    (q construct qAC, so that OgnMessageData::receiver is empty) update
+ *    the position of the receiver named by their source ID, provided that
+ *    their destination is that of a receiver ("OGNSDR", "OGNSXR" or the
+ *    legacy "APRS"). Positions of other stations, such as FANET ground
+ *    stations ("OGNFNT"), are ignored.
+ *  - Traffic reports that name a relaying receiver (e.g. "qAS,EDQG")
+ *    count towards that receiver.
+ *
+ *  Times are seconds on an arbitrary, monotonic clock chosen by the caller.
+ *
+ *  The table is not thread-safe.
+ */
+class OgnReceiverTable
+{
+public:
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    /*! \brief Add a parsed message
+     *
+     *  \param message Parsed message
+     *  \param now Current time in seconds
+     *  \param duplicate True if the message is a traffic report that was
+     *  already received via another receiver, as reported by OgnDuplicateFilter
+     *  \return False if the message does not concern any receiver
+     */
+    bool update(const OgnMessageData& message, double now, bool duplicate = false);
+
+    /*! \brief Remove receivers not seen for longer than timeout seconds
+     *
+     *  Takes time proportional to the number of receivers.
+     */
+    void expire(double now, double timeout);
+
+    void clear();
+
+    //! Index of the receiver, or npos. Indices change when receivers are removed.
+    [[nodiscard]] std::size_t find(std::string_view name) const;
+
+    //! Number of receivers
+    [[nodiscard]] std::size_t size() const { return m_receivers.size(); }
+    [[nodiscard]] bool empty() const { return m_receivers.empty(); }
+
+    //! Receiver at index, 0 <= index < size()
+    [[nodiscard]] const OgnReceiver& receiver(std::size_t index) const { return m_receivers[index]; }
+
+private:
+    OgnReceiver& findOrInsert(std::string_view name);
+
+    std::map<std::string, std::size_t, std::less<>> m_index;
+    std::vector<OgnReceiver> m_receivers;
+};
+
+} // namespace Ogn
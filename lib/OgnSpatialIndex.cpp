@@ -0,0 +1,142 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "OgnSpatialIndex.h"
+
+#include <algorithm>
+
+namespace Ogn {
+
+OgnSpatialIndex::OgnSpatialIndex(double cellSize)
+    : m_cellSize(std::clamp(std::isnan(cellSize) ? 0.5 : cellSize, MinimumCellSize, 180.0))
+    , m_rows(static_cast<std::size_t>(std::ceil(180.0 / m_cellSize)))
+    , m_columns(static_cast<std::size_t>(std::ceil(360.0 / m_cellSize)))
+{
+}
+
+void OgnSpatialIndex::append(double latitude, double longitude)
+{
+    if (m_heads.empty()) {
+        m_heads.assign(m_rows * m_columns, None);
+    }
+    m_cell.push_back(0);
+    m_previous.push_back(None);
+    m_next.push_back(None);
+    link(m_cell.size() - 1, cellOf(latitude, longitude));
+}
+
+void OgnSpatialIndex::update(std::size_t index, double latitude, double longitude)
+{
+    uint32_t const cell = cellOf(latitude, longitude);
+    if (cell != m_cell[index]) {
+        unlink(index);
+        link(index, cell);
+    }
+}
+
+void OgnSpatialIndex::remove(std::size_t index)
+{
+    unlink(index);
+
+    // Move the last entry into the free place, keeping its place in the list
+    std::size_t const last = m_cell.size() - 1;
+    if (index != last) {
+        uint32_t const previous = m_previous[last];
+        uint32_t const next = m_next[last];
+        m_cell[index] = m_cell[last];
+        m_previous[index] = previous;
+        m_next[index] = next;
+        if (previous != None) {
+            m_next[previous] = static_cast<uint32_t>(index);
+        } else {
+            m_heads[m_cell[index]] = static_cast<uint32_t>(index);
+        }
+        if (next != None) {
+            m_previous[next] = static_cast<uint32_t>(index);
+        }
+    }
+
+    m_cell.pop_back();
+    m_previous.pop_back();
+    m_next.pop_back();
+}
+
+void OgnSpatialIndex::clear()
+{
+    m_heads.clear();
+    m_cell.clear();
+    m_previous.clear();
+    m_next.clear();
+}
+
+std::size_t OgnSpatialIndex::rowOf(double latitude) const
+{
+    if (std::isnan(latitude)) {
+        return 0;
+    }
+    double const row = std::floor((std::clamp(latitude, -90.0, 90.0) + 90.0) / m_cellSize);
+    return std::min(static_cast<std::size_t>(row), m_rows - 1);
+}
+
+std::size_t OgnSpatialIndex::columnOf(double longitude) const
+{
+    if (std::isnan(longitude) || std::isinf(longitude)) {
+        return 0;
+    }
+    // Normalize to [0, 360)
+    double normalized = std::fmod(longitude + 180.0, 360.0);
+    if (normalized < 0.0) {
+        normalized += 360.0;
+    }
+    double const column = std::floor(normalized / m_cellSize);
+    return std::min(static_cast<std::size_t>(column), m_columns - 1);
+}
+
+uint32_t OgnSpatialIndex::cellOf(double latitude, double longitude) const
+{
+    return static_cast<uint32_t>(rowOf(latitude) * m_columns + columnOf(longitude));
+}
+
+void OgnSpatialIndex::link(std::size_t index, uint32_t cell)
+{
+    m_cell[index] = cell;
+    m_previous[index] = None;
+    m_next[index] = m_heads[cell];
+    if (m_heads[cell] != None) {
+        m_previous[m_heads[cell]] = static_cast<uint32_t>(index);
+    }
+    m_heads[cell] = static_cast<uint32_t>(index);
+}
+
+void OgnSpatialIndex::unlink(std::size_t index)
+{
+    uint32_t const previous = m_previous[index];
+    uint32_t const next = m_next[index];
+    if (previous != None) {
+        m_next[previous] = next;
+    } else {
+        m_heads[m_cell[index]] = next;
+    }
+    if (next != None) {
+        m_previous[next] = previous;
+    }
+}
+
+} // namespace Ogn
@@ -0,0 +1,147 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Ogn {
+
+/*! \brief Grid index over positions, for bounding-box queries
+ *
+ *  The index divides the globe into cells of equal angular size and keeps
+ *  one doubly linked list of entries per cell. Entries are identified by
+ *  dense indices 0, 1, ..., size()-1, matching the columns of
+ *  OgnTrafficTable, which owns an instance of this class.
+ *
+ *  Insertion, update and removal are O(1). A query visits the cells that
+ *  overlap the box, so that its cost is proportional to the number of
+ *  entries in these cells rather than to the total number of entries.
+ *
+ *  The index is not thread-safe.
+ */
+class OgnSpatialIndex
+{
+public:
+    /*! \brief Smallest cell size in degrees
+     *
+     *  The list heads of all cells are allocated with the first entry. With
+     *  this size, the grid has 720 x 1440 cells, and the heads take 4 MiB.
+     */
+    static constexpr double MinimumCellSize = 0.25;
+
+    /*! \brief Create empty index
+     *
+     *  \param cellSize Size of the grid cells in degrees, clamped to the
+     *  range from MinimumCellSize to 180
+     */
+    explicit OgnSpatialIndex(double cellSize = 0.5);
+
+    //! Size of the grid cells in degrees
+    [[nodiscard]] double cellSize() const { return m_cellSize; }
+
+    //! Append entry with index size()
+    void append(double latitude, double longitude);
+
+    //! Set new position of entry
+    void update(std::size_t index, double latitude, double longitude);
+
+    //! Remove entry. The last entry takes over its index.
+    void remove(std::size_t index);
+
+    void clear();
+
+    [[nodiscard]] std::size_t size() const { return m_cell.size(); }
+
+    /*! \brief Call callback(index) for every entry in cells that overlap the box
+     *
+     *  The callback may also be called for entries slightly outside the
+     *  box. If west > east, the box crosses the antimeridian.
+     */
+    template<typename Callback>
+    void forEachCandidate(double south, double west, double north, double east, Callback&& callback) const
+    {
+        if (m_heads.empty() || std::isnan(south) || std::isnan(west) || std::isnan(north) || std::isnan(east) || south > north) {
+            return;
+        }
+        std::size_t const firstRow = rowOf(south);
+        std::size_t const lastRow = rowOf(north);
+
+        // Column ranges, two of them if the box crosses the antimeridian
+        std::size_t ranges[2][2] = {{0, m_columns - 1}, {1, 0}};
+        if (west <= east && east - west < 360.0) {
+            ranges[0][0] = columnOf(west);
+            ranges[0][1] = columnOf(east);
+            if (ranges[0][0] > ranges[0][1]) {
+                // Normalization moved east past the antimeridian
+                ranges[1][0] = 0;
+                ranges[1][1] = ranges[0][1];
+                ranges[0][1] = m_columns - 1;
+            }
+        } else if (west > east) {
+            ranges[0][0] = columnOf(west);
+            ranges[1][0] = 0;
+            ranges[1][1] = columnOf(east);
+            if (ranges[1][1] >= ranges[0][0]) {
+                // The ranges overlap: all columns
+                ranges[0][0] = 0;
+                ranges[1][0] = 1;
+                ranges[1][1] = 0;
+            }
+        }
+
+        for (std::size_t row = firstRow; row <= lastRow; ++row) {
+            for (auto const& range : ranges) {
+                for (std::size_t column = range[0]; column <= range[1]; ++column) {
+                    for (uint32_t index = m_heads[row * m_columns + column]; index != None; index = m_next[index]) {
+                        callback(static_cast<std::size_t>(index));
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr uint32_t None = std::numeric_limits<uint32_t>::max();
+
+    [[nodiscard]] std::size_t rowOf(double latitude) const;
+    [[nodiscard]] std::size_t columnOf(double longitude) const;
+    [[nodiscard]] uint32_t cellOf(double latitude, double longitude) const;
+    void link(std::size_t index, uint32_t cell);
+    void unlink(std::size_t index);
+
+    double m_cellSize;
+    std::size_t m_rows;
+    std::size_t m_columns;
+
+    // Head of the list of every cell, allocated with the first entry
+    std::vector<uint32_t> m_heads;
+
+    // Per entry: cell and list links
+    std::vector<uint32_t> m_cell;
+    std::vector<uint32_t> m_previous;
+    std::vector<uint32_t> m_next;
+};
+
+} // namespace Ogn
@@ -0,0 +1,266 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Internal header of the OGN parser: tokenizer for the body of APRS sentences
+
+#if defined(__GNUC__) || defined(__clang__)
+#if defined(__SSE2__)
+#define OGN_TOKENIZER_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define OGN_TOKENIZER_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+namespace Ogn::Tokenizer {
+
+/*! \brief Kind of an item in the OGN part of a sentence
+ *
+ *  \see classifyToken
+ */
+enum class TokenKind
+{
+    Other,
+    AircraftID,       // "id0ADDE626"
+    Temperature,      // "t030" (weather)
+    Humidity,         // "h01" (weather)
+    Pressure,         // "b65526" (weather)
+    VerticalSpeed,    // "-019fpm"
+    RotationRate,     // "+0.0rot"
+    SignalStrength,   // "5.5dB"
+    ErrorCount,       // "3e"
+    FrequencyOffset,  // "-4.3kHz"
+    FlightLevel,      // "FL350.00"
+    FlightNumber,     // "A3:AXY547M"
+    Squawk,           // "Sq2244"
+    GpsInfo,          // "gps:3x5"
+    Enhancement,      // "!W91!"
+};
+
+/*! \brief Store the positions of all blanks in text
+ *
+ *  Scalar reference implementation of findBlanks.
+ *
+ *  \return Number of positions stored, at most capacity
+ */
+inline std::size_t findBlanksScalar(std::string_view text, uint32_t* positions, std::size_t capacity)
+{
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == ' ') {
+            if (count == capacity) {
+                return count;
+            }
+            positions[count++] = static_cast<uint32_t>(i);
+        }
+    }
+    return count;
+}
+
+/*! \brief Store the positions of all blanks in text, in increasing order
+ *
+ *  Compares 16 bytes at a time using SSE2 or NEON where available, and
+ *  falls back to findBlanksScalar otherwise.
+ *
+ *  \return Number of positions stored, at most capacity
+ */
+inline std::size_t findBlanks(std::string_view text, uint32_t* positions, std::size_t capacity)
+{
+#if defined(OGN_TOKENIZER_SSE2) || defined(OGN_TOKENIZER_NEON)
+    std::size_t count = 0;
+    std::size_t i = 0;
+    const char* const data = text.data();
+
+#if defined(OGN_TOKENIZER_SSE2)
+    const __m128i blank = _mm_set1_epi8(' ');
+    for (; i + 16 <= text.size(); i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        // One bit per byte
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, blank)));
+        while (mask != 0) {
+            if (count == capacity) {
+                return count;
+            }
+            positions[count++] = static_cast<uint32_t>(i) + static_cast<uint32_t>(__builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+#else
+    const uint8x16_t blank = vdupq_n_u8(' ');
+    for (; i + 16 <= text.size(); i += 16) {
+        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+        const uint8x16_t equal = vceqq_u8(chunk, blank);
+        // Four bits per byte
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(equal), 4)), 0);
+        while (mask != 0) {
+            if (count == capacity) {
+                return count;
+            }
+            auto const bit = static_cast<uint32_t>(__builtin_ctzll(mask));
+            positions[count++] = static_cast<uint32_t>(i) + (bit >> 2);
+            mask &= ~(uint64_t{0xF} << (bit & ~uint32_t{3}));
+        }
+    }
+#endif
+
+    // Remaining bytes
+    for (; i < text.size(); ++i) {
+        if (data[i] == ' ') {
+            if (count == capacity) {
+                return count;
+            }
+            positions[count++] = static_cast<uint32_t>(i);
+        }
+    }
+    return count;
+#else
+    return findBlanksScalar(text, positions, capacity);
+#endif
+}
+
+/*! \brief Call callback for every blank-separated, non-empty token of text
+ *
+ *  The text is scanned for blanks only once.
+ */
+template<typename Callback>
+inline void forEachToken(std::string_view text, Callback&& callback)
+{
+    constexpr std::size_t capacity = 32;
+    uint32_t blanks[capacity];
+
+    std::size_t tokenStart = 0;
+    std::size_t offset = 0;
+    while (true) {
+        std::size_t const count = findBlanks(text.substr(offset), blanks, capacity);
+        for (std::size_t i = 0; i < count; ++i) {
+            std::size_t const blankIndex = offset + blanks[i];
+            if (blankIndex > tokenStart) {
+                callback(text.substr(tokenStart, blankIndex - tokenStart));
+            }
+            tokenStart = blankIndex + 1;
+        }
+        if (count < capacity) {
+            break;
+        }
+        // More blanks than fit into the array: continue after the last one
+        offset = tokenStart;
+    }
+    if (tokenStart < text.size()) {
+        callback(text.substr(tokenStart));
+    }
+}
+
+/*! \brief Classify an item of the OGN part, dispatching on its first and last byte
+ *
+ *  Prefixes "id", "t", "h" and "b" take precedence over the suffixes "fpm",
+ *  "rot", "dB", "e" and "kHz", which in turn take precedence over the
+ *  prefixes "FL", "A?:", "Sq", "gps:" and "!W".
+ *
+ *  \param token Non-empty token
+ */
+inline TokenKind classifyToken(std::string_view token)
+{
+    auto const endsWith = [token](std::string_view suffix) {
+        return token.size() >= suffix.size() && token.substr(token.size() - suffix.size()) == suffix;
+    };
+
+    switch (token.front()) {
+    case 'i':
+        if (token.size() >= 2 && token[1] == 'd') {
+            return TokenKind::AircraftID;
+        }
+        break;
+    case 't':
+        return TokenKind::Temperature;
+    case 'h':
+        return TokenKind::Humidity;
+    case 'b':
+        return TokenKind::Pressure;
+    default:
+        break;
+    }
+
+    switch (token.back()) {
+    case 'm':
+        if (endsWith("fpm")) {
+            return TokenKind::VerticalSpeed;
+        }
+        break;
+    case 't':
+        if (endsWith("rot")) {
+            return TokenKind::RotationRate;
+        }
+        break;
+    case 'B':
+        if (endsWith("dB")) {
+            return TokenKind::SignalStrength;
+        }
+        break;
+    case 'e':
+        return TokenKind::ErrorCount;
+    case 'z':
+        if (endsWith("kHz")) {
+            return TokenKind::FrequencyOffset;
+        }
+        break;
+    default:
+        break;
+    }
+
+    switch (token.front()) {
+    case 'F':
+        if (token.size() >= 2 && token[1] == 'L') {
+            return TokenKind::FlightLevel;
+        }
+        break;
+    case 'A':
+        if (token.size() > 2 && token[2] == ':') {
+            return TokenKind::FlightNumber;
+        }
+        break;
+    case 'S':
+        if (token.size() >= 2 && token[1] == 'q') {
+            return TokenKind::Squawk;
+        }
+        break;
+    case 'g':
+        if (token.substr(0, 4) == "gps:") {
+            return TokenKind::GpsInfo;
+        }
+        break;
+    case '!':
+        if (token.size() >= 4 && token[1] == 'W') {
+            return TokenKind::Enhancement;
+        }
+        break;
+    default:
+        break;
+    }
+    return TokenKind::Other;
+}
+
+} // namespace Ogn::Tokenizer
@@ -0,0 +1,188 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "OgnTrafficRecord.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// File header: magic and format version
+constexpr char FileHeader[8] = {'O', 'G', 'N', 'R', 'E', 'C', '\0', '\1'};
+
+// Round to integer and clamp to the range of T
+template<typename T>
+T packValue(double value)
+{
+    if (std::isnan(value)) {
+        return 0;
+    }
+    double const rounded = std::round(value);
+    double const clamped = std::clamp(rounded,
+                                      static_cast<double>(std::numeric_limits<T>::min()),
+                                      static_cast<double>(std::numeric_limits<T>::max()));
+    return static_cast<T>(clamped);
+}
+
+} // namespace
+
+namespace Ogn {
+
+uint32_t OgnTrafficRecord::decodeTimestamp(std::string_view timestamp)
+{
+    if (timestamp.size() != 6) {
+        return InvalidTimestamp;
+    }
+    uint32_t value = 0;
+    auto const result = std::from_chars(timestamp.data(), timestamp.data() + timestamp.size(), value);
+    if (result.ec != std::errc{} || result.ptr != timestamp.data() + timestamp.size()) {
+        return InvalidTimestamp;
+    }
+    uint32_t const hours = value / 10000;
+    uint32_t const minutes = (value / 100) % 100;
+    uint32_t const seconds = value % 100;
+    if (hours > 23 || minutes > 59 || seconds > 59) {
+        return InvalidTimestamp;
+    }
+    return hours * 3600 + minutes * 60 + seconds;
+}
+
+bool OgnTrafficRecord::fromMessage(const OgnMessageData& message, OgnTrafficRecord& record)
+{
+    if (message.type != OgnMessageType::TRAFFIC_REPORT) {
+        return false;
+    }
+    if (std::isnan(message.latitude) || std::isnan(message.longitude)) {
+        return false;
+    }
+
+    OgnTrafficRecord result;
+
+    if (message.addressValue != OgnMessageData::InvalidAddress) {
+        result.address = message.addressValue;
+    }
+    result.latitude = packValue<int32_t>(message.latitude * 1e6);
+    result.longitude = packValue<int32_t>(message.longitude * 1e6);
+    if (!std::isnan(message.altitude)) {
+        result.altitude = packValue<int32_t>(message.altitude * 10.0);
+    }
+    result.timestamp = decodeTimestamp(message.timestamp);
+    result.course = packValue<uint16_t>(message.course * 10.0);
+    result.speed = packValue<uint16_t>(message.speed * 10.0);
+    result.climbRate = packValue<int16_t>(message.verticalSpeed * 100.0);
+    result.addressType = static_cast<uint8_t>(message.addressType);
+    result.aircraftType = static_cast<uint8_t>(message.aircraftType);
+    if (message.stealthMode) {
+        result.flags |= StealthMode;
+    }
+    if (message.noTrackingFlag) {
+        result.flags |= NoTracking;
+    }
+
+    record = result;
+    return true;
+}
+
+bool OgnTrafficRecordWriter::open(const std::string& fileName)
+{
+    close();
+
+    m_file = std::fopen(fileName.c_str(), "a+b");
+    if (m_file == nullptr) {
+        return false;
+    }
+
+    // Write header to new files, check header of existing files
+    std::fseek(m_file, 0, SEEK_END);
+    if (std::ftell(m_file) == 0) {
+        if (std::fwrite(FileHeader, sizeof(FileHeader), 1, m_file) != 1) {
+            close();
+            return false;
+        }
+        return true;
+    }
+    char header[sizeof(FileHeader)];
+    std::rewind(m_file);
+    if (std::fread(header, sizeof(header), 1, m_file) != 1 || std::memcmp(header, FileHeader, sizeof(header)) != 0) {
+        close();
+        return false;
+    }
+    // Switching from reading to writing requires a positioning call
+    std::fseek(m_file, 0, SEEK_END);
+    return true;
+}
+
+bool OgnTrafficRecordWriter::write(const OgnTrafficRecord* records, std::size_t count)
+{
+    if (m_file == nullptr) {
+        return false;
+    }
+    return std::fwrite(records, sizeof(OgnTrafficRecord), count, m_file) == count;
+}
+
+bool OgnTrafficRecordWriter::flush()
+{
+    return (m_file != nullptr) && (std::fflush(m_file) == 0);
+}
+
+void OgnTrafficRecordWriter::close()
+{
+    if (m_file != nullptr) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+bool OgnTrafficRecordReader::open(const std::string& fileName)
+{
+    close();
+
+    m_file = std::fopen(fileName.c_str(), "rb");
+    if (m_file == nullptr) {
+        return false;
+    }
+    char header[sizeof(FileHeader)];
+    if (std::fread(header, sizeof(header), 1, m_file) != 1 || std::memcmp(header, FileHeader, sizeof(header)) != 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+std::size_t OgnTrafficRecordReader::read(OgnTrafficRecord* records, std::size_t count)
+{
+    if (m_file == nullptr) {
+        return 0;
+    }
+    return std::fread(records, sizeof(OgnTrafficRecord), count, m_file);
+}
+
+void OgnTrafficRecordReader::close()
+{
+    if (m_file != nullptr) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+} // namespace Ogn
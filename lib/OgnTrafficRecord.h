@@ -0,0 +1,155 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "OgnParser.h"
+
+namespace Ogn {
+
+/*! \brief Compact binary representation of a traffic report
+ *
+ *  This fixed-size record holds the numeric content of a traffic report,
+ *  as produced by OgnParser::parseAprsisMessage. It is meant for archives
+ *  and for passing traffic between processes. Two records fit into one
+ *  cache line.
+ *
+ *  Values that are unknown are stored as the respective "invalid" constant.
+ */
+struct OgnTrafficRecord
+{
+    static constexpr int32_t InvalidCoordinate = std::numeric_limits<int32_t>::min();
+    static constexpr int32_t InvalidAltitude = std::numeric_limits<int32_t>::min();
+    static constexpr uint32_t InvalidTimestamp = std::numeric_limits<uint32_t>::max();
+
+    // Bits of the member flags
+    static constexpr uint8_t StealthMode = 0x01;
+    static constexpr uint8_t NoTracking = 0x02;
+
+    uint32_t address = 0;          // 24-bit address, e.g. 0x4D21C2
+    int32_t latitude = InvalidCoordinate;  // micro-degrees (WGS84)
+    int32_t longitude = InvalidCoordinate; // micro-degrees (WGS84)
+    int32_t altitude = InvalidAltitude;    // decimeters (MSL)
+    uint32_t timestamp = InvalidTimestamp; // seconds of day (UTC), decoded from "hhmmss"
+    uint16_t course = 0;           // tenths of a degree
+    uint16_t speed = 0;            // tenths of a knot
+    int16_t climbRate = 0;         // cm/s
+    uint8_t addressType = 0;       // OgnAddressType
+    uint8_t aircraftType = 0;      // OgnAircraftType
+    uint8_t flags = 0;             // StealthMode, NoTracking
+    uint8_t reserved[3] = {};      // always zero
+
+    /*! \brief Convert a parsed traffic report
+     *
+     *  \param message Parsed message
+     *  \param record Record that receives the data
+     *  \return False if the message is not a traffic report with valid position.
+     *  In that case, record is left unchanged.
+     */
+    static bool fromMessage(const OgnMessageData& message, OgnTrafficRecord& record);
+
+    //! Seconds of day of a timestamp "hhmmss", or InvalidTimestamp
+    static uint32_t decodeTimestamp(std::string_view timestamp);
+
+    [[nodiscard]] double latitudeDegrees() const { return latitude == InvalidCoordinate ? std::numeric_limits<double>::quiet_NaN() : latitude * 1e-6; }
+    [[nodiscard]] double longitudeDegrees() const { return longitude == InvalidCoordinate ? std::numeric_limits<double>::quiet_NaN() : longitude * 1e-6; }
+    [[nodiscard]] double altitudeMeters() const { return altitude == InvalidAltitude ? std::numeric_limits<double>::quiet_NaN() : altitude * 0.1; }
+    [[nodiscard]] double courseDegrees() const { return course * 0.1; }
+    [[nodiscard]] double speedKnots() const { return speed * 0.1; }
+    [[nodiscard]] double verticalSpeed() const { return climbRate * 0.01; } // m/s
+    [[nodiscard]] bool stealthMode() const { return (flags & StealthMode) != 0; }
+    [[nodiscard]] bool noTrackingFlag() const { return (flags & NoTracking) != 0; }
+};
+
+static_assert(sizeof(OgnTrafficRecord) == 32, "OgnTrafficRecord must have a fixed size of 32 bytes");
+static_assert(std::is_trivially_copyable_v<OgnTrafficRecord>, "OgnTrafficRecord must be trivially copyable");
+
+/*! \brief Append-only writer for files of OgnTrafficRecord
+ *
+ *  A file starts with an 8-byte header that identifies the format, followed
+ *  by the records in native byte order (little endian on all supported
+ *  platforms). Opening an existing file appends to it.
+ */
+class OgnTrafficRecordWriter
+{
+public:
+    OgnTrafficRecordWriter() = default;
+    OgnTrafficRecordWriter(const OgnTrafficRecordWriter&) = delete;
+    OgnTrafficRecordWriter& operator=(const OgnTrafficRecordWriter&) = delete;
+    ~OgnTrafficRecordWriter() { close(); }
+
+    /*! \brief Open file for appending, creating it if necessary
+     *
+     *  \return False if the file cannot be opened or is not a record file
+     */
+    bool open(const std::string& fileName);
+
+    /*! \brief Append records
+     *
+     *  \return False on write error
+     */
+    bool write(const OgnTrafficRecord* records, std::size_t count);
+    bool write(const OgnTrafficRecord& record) { return write(&record, 1); }
+
+    // Flush buffered records to the file
+    bool flush();
+
+    void close();
+
+private:
+    std::FILE* m_file = nullptr;
+};
+
+/*! \brief Sequential reader for files written by OgnTrafficRecordWriter */
+class OgnTrafficRecordReader
+{
+public:
+    OgnTrafficRecordReader() = default;
+    OgnTrafficRecordReader(const OgnTrafficRecordReader&) = delete;
+    OgnTrafficRecordReader& operator=(const OgnTrafficRecordReader&) = delete;
+    ~OgnTrafficRecordReader() { close(); }
+
+    /*! \brief Open file for reading
+     *
+     *  \return False if the file cannot be opened or is not a record file
+     */
+    bool open(const std::string& fileName);
+
+    /*! \brief Read up to count records
+     *
+     *  \return Number of records read, 0 at end of file or on error
+     */
+    std::size_t read(OgnTrafficRecord* records, std::size_t count);
+
+    void close();
+
+private:
+    std::FILE* m_file = nullptr;
+};
+
+} // namespace Ogn
@@ -0,0 +1,414 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "OgnTrafficTable.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr std::size_t InitialSlotCount = 64;
+
+constexpr double EarthRadiusKm = 6371.0088;
+constexpr double DegreesToRadians = 3.14159265358979323846 / 180.0;
+
+// Finalizer of MurmurHash3, spreads the bits of the key over the whole word
+uint32_t mix(uint32_t key)
+{
+    key ^= key >> 16;
+    key *= 0x85EBCA6BU;
+    key ^= key >> 13;
+    key *= 0xC2B2AE35U;
+    key ^= key >> 16;
+    return key;
+}
+
+} // namespace
+
+namespace Ogn {
+
+OgnTrafficTable::OgnTrafficTable(double timeout, double cellSize)
+    : m_slots(InitialSlotCount)
+    , m_timeoutTicks(static_cast<int64_t>(std::ceil(std::clamp(timeout, 0.0, 86400.0))))
+    , m_spatialIndex(cellSize)
+{
+    // Aircraft that are still current span timeout+1 ticks
+    m_wheelHeads.assign(static_cast<std::size_t>(m_timeoutTicks) + 2, None);
+}
+
+bool OgnTrafficTable::keyOf(const OgnMessageData& message, uint32_t& key)
+{
+    if (message.type != OgnMessageType::TRAFFIC_REPORT) {
+        return false;
+    }
+    if (message.addressValue == OgnMessageData::InvalidAddress) {
+        return false;
+    }
+    key = makeKey(message.addressType, message.addressValue);
+    return true;
+}
+
+bool OgnTrafficTable::update(const OgnMessageData& message, double now)
+{
+    OgnTrafficTarget target;
+    if (!keyOf(message, target.key)) {
+        return false;
+    }
+    if (std::isnan(message.latitude) || std::isnan(message.longitude)) {
+        return false;
+    }
+    target.latitude = message.latitude;
+    target.longitude = message.longitude;
+    target.altitude = message.altitude;
+    target.course = message.course;
+    target.speed = message.speed;
+    target.verticalSpeed = message.verticalSpeed;
+    target.turnRate = message.turnRate;
+    target.aircraftType = message.aircraftType;
+    update(target, now);
+    return true;
+}
+
+std::size_t OgnTrafficTable::update(const OgnTrafficTarget& target, double now)
+{
+    std::size_t slot = slotOf(target.key);
+    std::size_t index = m_slots[slot].index;
+    if (index == None) {
+        // Keep the load factor at or below 1/2
+        if (2 * (m_keys.size() + 1) > m_slots.size()) {
+            rehash(2 * m_slots.size());
+            slot = slotOf(target.key);
+        }
+        index = m_keys.size();
+        m_slots[slot] = {target.key, static_cast<uint32_t>(index)};
+        m_keys.push_back(target.key);
+        m_latitude.push_back(target.latitude);
+        m_longitude.push_back(target.longitude);
+        m_altitude.push_back(target.altitude);
+        m_course.push_back(target.course);
+        m_speed.push_back(target.speed);
+        m_verticalSpeed.push_back(target.verticalSpeed);
+        m_turnRate.push_back(target.turnRate);
+        m_lastSeen.push_back(now);
+        m_aircraftType.push_back(target.aircraftType);
+        m_wheelTick.push_back(0);
+        m_wheelPrevious.push_back(None);
+        m_wheelNext.push_back(None);
+        m_spatialIndex.append(target.latitude, target.longitude);
+    } else {
+        m_latitude[index] = target.latitude;
+        m_longitude[index] = target.longitude;
+        m_altitude[index] = target.altitude;
+        m_course[index] = target.course;
+        m_speed[index] = target.speed;
+        m_verticalSpeed[index] = target.verticalSpeed;
+        m_turnRate[index] = target.turnRate;
+        m_lastSeen[index] = now;
+        m_aircraftType[index] = target.aircraftType;
+        m_spatialIndex.update(index, target.latitude, target.longitude);
+        unlink(index);
+    }
+
+    // Aircraft reported with a time that has already been expired go into
+    // the oldest slot that has not
+    auto const tick = std::max(static_cast<int64_t>(std::floor(now)), m_nextExpiryTick);
+    link(index, tick);
+    return index;
+}
+
+void OgnTrafficTable::expire(double now)
+{
+    // All aircraft with a tick up to limit are stale
+    int64_t const limit = static_cast<int64_t>(std::floor(now)) - m_timeoutTicks - 1;
+    if (limit < m_nextExpiryTick) {
+        return;
+    }
+
+    auto const expireBucket = [this, limit](std::size_t bucket) {
+        uint32_t index = m_wheelHeads[bucket];
+        while (index != None) {
+            uint32_t next = m_wheelNext[index];
+            if (m_wheelTick[index] <= limit) {
+                // The last aircraft moves into the place of the removed one
+                auto const last = static_cast<uint32_t>(m_keys.size() - 1);
+                removeIndex(index);
+                if (next == last) {
+                    next = index;
+                }
+            }
+            index = next;
+        }
+    };
+
+    auto const bucketCount = static_cast<int64_t>(m_wheelHeads.size());
+    if (m_nextExpiryTick == std::numeric_limits<int64_t>::min() || limit - m_nextExpiryTick >= bucketCount - 1) {
+        for (std::size_t bucket = 0; bucket < m_wheelHeads.size(); ++bucket) {
+            expireBucket(bucket);
+        }
+    } else {
+        for (int64_t tick = m_nextExpiryTick; tick <= limit; ++tick) {
+            expireBucket(bucketOf(tick));
+        }
+    }
+    m_nextExpiryTick = limit + 1;
+}
+
+bool OgnTrafficTable::remove(uint32_t key)
+{
+    std::size_t const index = find(key);
+    if (index == npos) {
+        return false;
+    }
+    removeIndex(index);
+    return true;
+}
+
+void OgnTrafficTable::clear()
+{
+    m_slots.assign(InitialSlotCount, Slot{});
+    m_keys.clear();
+    m_latitude.clear();
+    m_longitude.clear();
+    m_altitude.clear();
+    m_course.clear();
+    m_speed.clear();
+    m_verticalSpeed.clear();
+    m_turnRate.clear();
+    m_lastSeen.clear();
+    m_aircraftType.clear();
+    m_wheelTick.clear();
+    m_wheelPrevious.clear();
+    m_wheelNext.clear();
+    std::fill(m_wheelHeads.begin(), m_wheelHeads.end(), None);
+    m_spatialIndex.clear();
+}
+
+void OgnTrafficTable::findInBox(double south, double west, double north, double east, std::vector<std::size_t>& indices) const
+{
+    indices.clear();
+    bool const crossesAntimeridian = west > east;
+    m_spatialIndex.forEachCandidate(south, west, north, east, [&](std::size_t index) {
+        double const latitude = m_latitude[index];
+        double const longitude = m_longitude[index];
+        if (latitude < south || latitude > north) {
+            return;
+        }
+        bool const inside = crossesAntimeridian ? (longitude >= west || longitude <= east)
+                                                : (longitude >= west && longitude <= east);
+        if (inside) {
+            indices.push_back(index);
+        }
+    });
+}
+
+void OgnTrafficTable::findInRadius(double latitude, double longitude, double radiusKm, std::vector<std::size_t>& indices) const
+{
+    indices.clear();
+    if (std::isnan(latitude) || std::isnan(longitude) || !(radiusKm >= 0.0)) {
+        return;
+    }
+
+    // Bounding box of the circle, all longitudes if it contains a pole
+    double const radiusDegrees = radiusKm / (EarthRadiusKm * DegreesToRadians);
+    double const south = latitude - radiusDegrees;
+    double const north = latitude + radiusDegrees;
+    double west = -180.0;
+    double east = 180.0;
+    if (south > -90.0 && north < 90.0) {
+        double const ratio = std::sin(radiusDegrees * DegreesToRadians) / std::cos(latitude * DegreesToRadians);
+        if (ratio < 1.0) {
+            double const deltaLongitude = std::asin(ratio) / DegreesToRadians;
+            west = longitude - deltaLongitude;
+            east = longitude + deltaLongitude;
+        }
+    }
+
+    // Haversine distance
+    double const centerLatitude = latitude * DegreesToRadians;
+    double const cosCenterLatitude = std::cos(centerLatitude);
+    double const sinHalfAngle = std::sin(std::min(radiusKm / EarthRadiusKm, 3.14159265358979323846) / 2.0);
+    double const limit = sinHalfAngle * sinHalfAngle;
+    m_spatialIndex.forEachCandidate(std::max(south, -90.0), west, std::min(north, 90.0), east, [&](std::size_t index) {
+        double const otherLatitude = m_latitude[index] * DegreesToRadians;
+        double const sinLatitude = std::sin((otherLatitude - centerLatitude) / 2.0);
+        double const sinLongitude = std::sin((m_longitude[index] - longitude) * DegreesToRadians / 2.0);
+        double const h = sinLatitude * sinLatitude + cosCenterLatitude * std::cos(otherLatitude) * sinLongitude * sinLongitude;
+        if (h <= limit) {
+            indices.push_back(index);
+        }
+    });
+}
+
+std::size_t OgnTrafficTable::find(uint32_t key) const
+{
+    uint32_t const index = m_slots[slotOf(key)].index;
+    return index == None ? npos : index;
+}
+
+OgnTrafficTarget OgnTrafficTable::target(std::size_t index) const
+{
+    OgnTrafficTarget result;
+    result.key = m_keys[index];
+    result.latitude = m_latitude[index];
+    result.longitude = m_longitude[index];
+    result.altitude = m_altitude[index];
+    result.course = m_course[index];
+    result.speed = m_speed[index];
+    result.verticalSpeed = m_verticalSpeed[index];
+    result.turnRate = m_turnRate[index];
+    result.lastSeen = m_lastSeen[index];
+    result.aircraftType = m_aircraftType[index];
+    return result;
+}
+
+std::size_t OgnTrafficTable::homeSlot(uint32_t key) const
+{
+    return mix(key) & (m_slots.size() - 1);
+}
+
+// Slot that holds key, or the empty slot where it would be inserted
+std::size_t OgnTrafficTable::slotOf(uint32_t key) const
+{
+    std::size_t const mask = m_slots.size() - 1;
+    std::size_t slot = homeSlot(key);
+    while (m_slots[slot].index != None && m_slots[slot].key != key) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void OgnTrafficTable::rehash(std::size_t slotCount)
+{
+    m_slots.assign(slotCount, Slot{});
+    for (std::size_t index = 0; index < m_keys.size(); ++index) {
+        m_slots[slotOf(m_keys[index])] = {m_keys[index], static_cast<uint32_t>(index)};
+    }
+}
+
+// Backward-shift deletion: move following entries of the probe sequence
+// into the gap, so that no tombstones are needed
+void OgnTrafficTable::eraseSlot(std::size_t slot)
+{
+    std::size_t const mask = m_slots.size() - 1;
+    std::size_t gap = slot;
+    std::size_t current = slot;
+    while (true) {
+        current = (current + 1) & mask;
+        if (m_slots[current].index == None) {
+            break;
+        }
+        // The entry may move into the gap if its home is not in (gap, current]
+        std::size_t const home = homeSlot(m_slots[current].key);
+        bool const homeBetween = (gap <= current) ? (gap < home && home <= current)
+                                                  : (gap < home || home <= current);
+        if (!homeBetween) {
+            m_slots[gap] = m_slots[current];
+            gap = current;
+        }
+    }
+    m_slots[gap] = Slot{};
+}
+
+void OgnTrafficTable::removeIndex(std::size_t index)
+{
+    unlink(index);
+    m_spatialIndex.remove(index);
+    eraseSlot(slotOf(m_keys[index]));
+
+    // Move the last aircraft into the free place
+    std::size_t const last = m_keys.size() - 1;
+    if (index != last) {
+        m_keys[index] = m_keys[last];
+        m_latitude[index] = m_latitude[last];
+        m_longitude[index] = m_longitude[last];
+        m_altitude[index] = m_altitude[last];
+        m_course[index] = m_course[last];
+        m_speed[index] = m_speed[last];
+        m_verticalSpeed[index] = m_verticalSpeed[last];
+        m_turnRate[index] = m_turnRate[last];
+        m_lastSeen[index] = m_lastSeen[last];
+        m_aircraftType[index] = m_aircraftType[last];
+        m_slots[slotOf(m_keys[index])].index = static_cast<uint32_t>(index);
+
+        // Take over the place in the timing wheel, keeping the order of the list
+        uint32_t const previous = m_wheelPrevious[last];
+        uint32_t const next = m_wheelNext[last];
+        m_wheelTick[index] = m_wheelTick[last];
+        m_wheelPrevious[index] = previous;
+        m_wheelNext[index] = next;
+        if (previous != None) {
+            m_wheelNext[previous] = static_cast<uint32_t>(index);
+        } else {
+            m_wheelHeads[bucketOf(m_wheelTick[index])] = static_cast<uint32_t>(index);
+        }
+        if (next != None) {
+            m_wheelPrevious[next] = static_cast<uint32_t>(index);
+        }
+    }
+
+    m_keys.pop_back();
+    m_latitude.pop_back();
+    m_longitude.pop_back();
+    m_altitude.pop_back();
+    m_course.pop_back();
+    m_speed.pop_back();
+    m_verticalSpeed.pop_back();
+    m_turnRate.pop_back();
+    m_lastSeen.pop_back();
+    m_aircraftType.pop_back();
+    m_wheelTick.pop_back();
+    m_wheelPrevious.pop_back();
+    m_wheelNext.pop_back();
+}
+
+std::size_t OgnTrafficTable::bucketOf(int64_t tick) const
+{
+    auto const bucketCount = static_cast<int64_t>(m_wheelHeads.size());
+    return static_cast<std::size_t>(((tick % bucketCount) + bucketCount) % bucketCount);
+}
+
+void OgnTrafficTable::link(std::size_t index, int64_t tick)
+{
+    std::size_t const bucket = bucketOf(tick);
+    m_wheelTick[index] = tick;
+    m_wheelPrevious[index] = None;
+    m_wheelNext[index] = m_wheelHeads[bucket];
+    if (m_wheelHeads[bucket] != None) {
+        m_wheelPrevious[m_wheelHeads[bucket]] = static_cast<uint32_t>(index);
+    }
+    m_wheelHeads[bucket] = static_cast<uint32_t>(index);
+}
+
+void OgnTrafficTable::unlink(std::size_t index)
+{
+    uint32_t const previous = m_wheelPrevious[index];
+    uint32_t const next = m_wheelNext[index];
+    if (previous != None) {
+        m_wheelNext[previous] = next;
+    } else {
+        m_wheelHeads[bucketOf(m_wheelTick[index])] = next;
+    }
+    if (next != None) {
+        m_wheelPrevious[next] = previous;
+    }
+}
+
+} // namespace Ogn
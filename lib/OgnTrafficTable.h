@@ -0,0 +1,210 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "OgnParser.h"
+#include "OgnSpatialIndex.h"
+
+namespace Ogn {
+
+/*! \brief State of one aircraft in an OgnTrafficTable */
+struct OgnTrafficTarget
+{
+    uint32_t key = 0;                // see OgnTrafficTable::makeKey
+    double latitude = std::numeric_limits<double>::quiet_NaN();  // degrees (WGS84)
+    double longitude = std::numeric_limits<double>::quiet_NaN(); // degrees (WGS84)
+    double altitude = std::numeric_limits<double>::quiet_NaN();  // meters (MSL)
+    double course = 0.0;             // degrees
+    double speed = 0.0;              // knots
+    double verticalSpeed = 0.0;      // m/s
+    double turnRate = 0.0;           // degrees per second, positive clockwise
+    double lastSeen = 0.0;           // seconds, as passed to OgnTrafficTable::update
+    OgnAircraftType aircraftType = OgnAircraftType::unknown;
+
+    [[nodiscard]] uint32_t address() const { return key & 0xFFFFFF; }
+    [[nodiscard]] OgnAddressType addressType() const { return static_cast<OgnAddressType>(key >> 24); }
+};
+
+/*! \brief Current traffic picture, built from parsed traffic reports
+ *
+ *  The table holds the latest state of every aircraft, keyed by address
+ *  type and 24-bit address. Lookup uses an open-addressing hash table with
+ *  linear probing. Aircraft data is stored as structure of arrays, so that
+ *  iterating over one quantity of all aircraft touches contiguous memory.
+ *  Indices are dense, from 0 to size()-1, but change when aircraft are
+ *  removed.
+ *
+ *  Aircraft that have not been seen for longer than the timeout are removed
+ *  by expire(). A timing wheel with one-second slots keeps the cost of
+ *  expire() proportional to the number of stale aircraft. Aircraft are
+ *  removed between timeout and timeout plus one second after they were
+ *  last seen.
+ *
+ *  A grid index over the positions answers radius and bounding-box queries.
+ *
+ *  Times are seconds on an arbitrary, monotonic clock chosen by the caller.
+ *  Times passed to update() and expire() must not decrease.
+ *
+ *  The table is not thread-safe.
+ */
+class OgnTrafficTable
+{
+public:
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    /*! \brief Create empty table
+     *
+     *  \param timeout Aircraft not seen for this many seconds are removed by expire()
+     *  \param cellSize Size of the cells of the spatial index in degrees,
+     *  at least OgnSpatialIndex::MinimumCellSize
+     */
+    explicit OgnTrafficTable(double timeout = 60.0, double cellSize = 0.5);
+
+    //! Key of an aircraft: address type in the upper 8 bits, 24-bit address in the lower bits
+    static constexpr uint32_t makeKey(OgnAddressType addressType, uint32_t address)
+    {
+        return (static_cast<uint32_t>(addressType) << 24) | (address & 0xFFFFFF);
+    }
+
+    /*! \brief Key of the aircraft of a parsed traffic report
+     *
+     *  \return False if the message is not a traffic report with valid address
+     */
+    static bool keyOf(const OgnMessageData& message, uint32_t& key);
+
+    /*! \brief Insert or update aircraft from a parsed message
+     *
+     *  \param message Parsed message
+     *  \param now Current time in seconds
+     *  \return False if the message is not a traffic report with valid address and position
+     */
+    bool update(const OgnMessageData& message, double now);
+
+    /*! \brief Insert or update aircraft
+     *
+     *  The member lastSeen of target is ignored and set to now.
+     *
+     *  \return Index of the aircraft
+     */
+    std::size_t update(const OgnTrafficTarget& target, double now);
+
+    //! Remove aircraft that have not been seen for longer than the timeout
+    void expire(double now);
+
+    //! Remove aircraft, returns false if not present
+    bool remove(uint32_t key);
+
+    void clear();
+
+    //! Index of the aircraft with the given key, or npos
+    [[nodiscard]] std::size_t find(uint32_t key) const;
+
+    //! Number of aircraft
+    [[nodiscard]] std::size_t size() const { return m_keys.size(); }
+    [[nodiscard]] bool empty() const { return m_keys.empty(); }
+
+    //! State of the aircraft at index, 0 <= index < size()
+    [[nodiscard]] OgnTrafficTarget target(std::size_t index) const;
+
+    /*! \brief Aircraft within a bounding box
+     *
+     *  If west > east, the box crosses the antimeridian. Aircraft on the
+     *  boundary are included.
+     *
+     *  \param indices Receives the indices of the aircraft, in no particular order
+     */
+    void findInBox(double south, double west, double north, double east, std::vector<std::size_t>& indices) const;
+
+    /*! \brief Aircraft within a distance of a point
+     *
+     *  Distances are great-circle distances on a sphere with the mean
+     *  radius of the earth.
+     *
+     *  \param indices Receives the indices of the aircraft, in no particular order
+     */
+    void findInRadius(double latitude, double longitude, double radiusKm, std::vector<std::size_t>& indices) const;
+
+    // Column access, each array has size() elements
+    [[nodiscard]] const uint32_t* keys() const { return m_keys.data(); }
+    [[nodiscard]] const double* latitudes() const { return m_latitude.data(); }
+    [[nodiscard]] const double* longitudes() const { return m_longitude.data(); }
+    [[nodiscard]] const double* altitudes() const { return m_altitude.data(); }
+    [[nodiscard]] const double* courses() const { return m_course.data(); }
+    [[nodiscard]] const double* speeds() const { return m_speed.data(); }
+    [[nodiscard]] const double* verticalSpeeds() const { return m_verticalSpeed.data(); }
+    [[nodiscard]] const double* turnRates() const { return m_turnRate.data(); }
+    [[nodiscard]] const double* lastSeen() const { return m_lastSeen.data(); }
+    [[nodiscard]] const OgnAircraftType* aircraftTypes() const { return m_aircraftType.data(); }
+
+private:
+    static constexpr uint32_t None = std::numeric_limits<uint32_t>::max();
+
+    // Slot of the hash table. Keys are stored in the slot, so that probing
+    // does not touch the columns.
+    struct Slot
+    {
+        uint32_t key = 0;
+        uint32_t index = None; // index into the columns, None if the slot is empty
+    };
+
+    [[nodiscard]] std::size_t homeSlot(uint32_t key) const;
+    [[nodiscard]] std::size_t slotOf(uint32_t key) const;
+    void rehash(std::size_t slotCount);
+    void eraseSlot(std::size_t slot);
+    void removeIndex(std::size_t index);
+
+    // Timing wheel
+    [[nodiscard]] std::size_t bucketOf(int64_t tick) const;
+    void link(std::size_t index, int64_t tick);
+    void unlink(std::size_t index);
+
+    // Hash table, size is a power of two
+    std::vector<Slot> m_slots;
+
+    // Columns
+    std::vector<uint32_t> m_keys;
+    std::vector<double> m_latitude;
+    std::vector<double> m_longitude;
+    std::vector<double> m_altitude;
+    std::vector<double> m_course;
+    std::vector<double> m_speed;
+    std::vector<double> m_verticalSpeed;
+    std::vector<double> m_turnRate;
+    std::vector<double> m_lastSeen;
+    std::vector<OgnAircraftType> m_aircraftType;
+
+    // Timing wheel: one doubly linked list of indices per second
+    std::vector<int64_t> m_wheelTick;
+    std::vector<uint32_t> m_wheelPrevious;
+    std::vector<uint32_t> m_wheelNext;
+    std::vector<uint32_t> m_wheelHeads;
+    int64_t m_timeoutTicks;
+
+    OgnSpatialIndex m_spatialIndex;
+    int64_t m_nextExpiryTick = std::numeric_limits<int64_t>::min(); // oldest tick not yet expired
+};
+
+} // namespace Ogn
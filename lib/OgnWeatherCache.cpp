@@ -0,0 +1,223 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "OgnWeatherCache.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double DegreesToRadians = 3.14159265358979323846 / 180.0;
+
+// Value of a weather quantity, or NaN if the report does not contain it
+double weatherValue(const Ogn::OgnMessageData& message, uint8_t field, double value)
+{
+    return (message.weatherFields & field) != 0 ? value : std::numeric_limits<double>::quiet_NaN();
+}
+
+} // namespace
+
+namespace Ogn {
+
+OgnWeatherCache::OgnWeatherCache(std::vector<double> windows, std::size_t bucketsPerWindow)
+    : m_bucketsPerWindow(std::max<std::size_t>(bucketsPerWindow, 1))
+{
+    m_windows.reserve(windows.size());
+    for (double const length : windows) {
+        double const clamped = std::max(length, 1.0);
+        m_windows.push_back({clamped, clamped / static_cast<double>(m_bucketsPerWindow)});
+    }
+}
+
+bool OgnWeatherCache::update(const OgnMessageData& message, double now)
+{
+    if (message.type != OgnMessageType::WEATHER || message.sourceId.empty()) {
+        return false;
+    }
+
+    std::size_t index = find(message.sourceId);
+    if (index == npos) {
+        index = m_stations.size();
+        m_stations.push_back({std::string(message.sourceId), {}, {}});
+        m_index.emplace(message.sourceId, index);
+        m_buckets.resize(m_buckets.size() + m_windows.size() * m_bucketsPerWindow);
+    } else {
+        if (!message.timestamp.empty() && message.timestamp == m_stations[index].timestamp) {
+            return false;
+        }
+        // Times must not decrease
+        now = std::max(now, m_stations[index].latest.time);
+    }
+
+    Station& station = m_stations[index];
+    station.timestamp.assign(message.timestamp.data(), message.timestamp.size());
+
+    OgnWeatherReading& reading = station.latest;
+    reading.time = now;
+    reading.latitude = message.latitude;
+    reading.longitude = message.longitude;
+    reading.windDirection = weatherValue(message, OgnMessageData::HasWindDirection, message.wind_direction);
+    reading.windSpeed = weatherValue(message, OgnMessageData::HasWindSpeed, message.wind_speed);
+    reading.windGustSpeed = weatherValue(message, OgnMessageData::HasWindGustSpeed, message.wind_gust_speed);
+    // Fahrenheit, negative values in two's complement
+    double const fahrenheit = static_cast<int32_t>(message.temperature);
+    reading.temperature = weatherValue(message, OgnMessageData::HasTemperature, (fahrenheit - 32.0) * 5.0 / 9.0);
+    reading.humidity = weatherValue(message, OgnMessageData::HasHumidity, message.humidity);
+    reading.pressure = weatherValue(message, OgnMessageData::HasPressure, message.pressure > 0.0 ? message.pressure : std::numeric_limits<double>::quiet_NaN());
+
+    double const values[QuantityCount] = {reading.windSpeed, reading.windGustSpeed, reading.temperature, reading.humidity, reading.pressure};
+    // Reports without direction or speed do not contribute to the mean wind
+    double const direction = reading.windDirection * DegreesToRadians;
+    bool const hasWind = !std::isnan(direction) && !std::isnan(reading.windSpeed);
+    double const windX = hasWind ? reading.windSpeed * std::sin(direction) : 0.0;
+    double const windY = hasWind ? reading.windSpeed * std::cos(direction) : 0.0;
+
+    for (std::size_t window = 0; window < m_windows.size(); ++window) {
+        int64_t const number = bucketNumber(window, now);
+        auto const count = static_cast<int64_t>(m_bucketsPerWindow);
+        Bucket& bucket = buckets(index, window)[static_cast<std::size_t>(((number % count) + count) % count)];
+        if (bucket.number != number) {
+            // Bucket is reused for a new interval
+            bucket = Bucket();
+            bucket.number = number;
+        }
+        for (std::size_t quantity = 0; quantity < QuantityCount; ++quantity) {
+            double const value = values[quantity];
+            if (std::isnan(value)) {
+                continue;
+            }
+            if (bucket.count[quantity] == 0) {
+                bucket.minimum[quantity] = value;
+                bucket.maximum[quantity] = value;
+            } else {
+                bucket.minimum[quantity] = std::min(bucket.minimum[quantity], value);
+                bucket.maximum[quantity] = std::max(bucket.maximum[quantity], value);
+            }
+            bucket.count[quantity]++;
+            bucket.sum[quantity] += value;
+        }
+        bucket.windX += windX;
+        bucket.windY += windY;
+    }
+    return true;
+}
+
+void OgnWeatherCache::expire(double now, double timeout)
+{
+    std::size_t index = 0;
+    while (index < m_stations.size()) {
+        if (now - m_stations[index].latest.time <= timeout) {
+            ++index;
+            continue;
+        }
+
+        // Move the last station into the gap
+        std::size_t const last = m_stations.size() - 1;
+        std::size_t const bucketCount = m_windows.size() * m_bucketsPerWindow;
+        m_index.erase(m_stations[index].name);
+        if (index != last) {
+            m_stations[index] = std::move(m_stations[last]);
+            std::copy_n(m_buckets.begin() + static_cast<std::ptrdiff_t>(last * bucketCount), bucketCount,
+                        m_buckets.begin() + static_cast<std::ptrdiff_t>(index * bucketCount));
+            m_index.find(m_stations[index].name)->second = index;
+        }
+        m_stations.pop_back();
+        m_buckets.resize(last * bucketCount);
+    }
+}
+
+void OgnWeatherCache::clear()
+{
+    m_index.clear();
+    m_stations.clear();
+    m_buckets.clear();
+}
+
+std::size_t OgnWeatherCache::find(std::string_view station) const
+{
+    auto const iterator = m_index.find(station);
+    return iterator == m_index.end() ? npos : iterator->second;
+}
+
+OgnWeatherStatistics OgnWeatherCache::statistics(std::size_t index, OgnWeatherQuantity quantity, std::size_t window, double now) const
+{
+    OgnWeatherStatistics result;
+    auto const q = static_cast<std::size_t>(quantity);
+    int64_t const newest = bucketNumber(window, now);
+    auto const oldest = newest - static_cast<int64_t>(m_bucketsPerWindow) + 1;
+    double sum = 0.0;
+    const Bucket* const begin = buckets(index, window);
+    for (const Bucket* bucket = begin; bucket != begin + m_bucketsPerWindow; ++bucket) {
+        if (bucket->number < oldest || bucket->number > newest || bucket->count[q] == 0) {
+            continue;
+        }
+        if (result.count == 0) {
+            result.minimum = bucket->minimum[q];
+            result.maximum = bucket->maximum[q];
+        } else {
+            result.minimum = std::min(result.minimum, bucket->minimum[q]);
+            result.maximum = std::max(result.maximum, bucket->maximum[q]);
+        }
+        result.count += bucket->count[q];
+        sum += bucket->sum[q];
+    }
+    if (result.count > 0) {
+        result.mean = sum / static_cast<double>(result.count);
+    }
+    return result;
+}
+
+double OgnWeatherCache::meanWindDirection(std::size_t index, std::size_t window, double now) const
+{
+    int64_t const newest = bucketNumber(window, now);
+    auto const oldest = newest - static_cast<int64_t>(m_bucketsPerWindow) + 1;
+    double windX = 0.0;
+    double windY = 0.0;
+    const Bucket* const begin = buckets(index, window);
+    for (const Bucket* bucket = begin; bucket != begin + m_bucketsPerWindow; ++bucket) {
+        if (bucket->number >= oldest && bucket->number <= newest) {
+            windX += bucket->windX;
+            windY += bucket->windY;
+        }
+    }
+    if (std::hypot(windX, windY) < 1e-9) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    double const direction = std::atan2(windX, windY) / DegreesToRadians;
+    return direction < 0.0 ? direction + 360.0 : direction;
+}
+
+int64_t OgnWeatherCache::bucketNumber(std::size_t window, double time) const
+{
+    return static_cast<int64_t>(std::floor(time / m_windows[window].bucketWidth));
+}
+
+OgnWeatherCache::Bucket* OgnWeatherCache::buckets(std::size_t index, std::size_t window)
+{
+    return m_buckets.data() + (index * m_windows.size() + window) * m_bucketsPerWindow;
+}
+
+const OgnWeatherCache::Bucket* OgnWeatherCache::buckets(std::size_t index, std::size_t window) const
+{
+    return m_buckets.data() + (index * m_windows.size() + window) * m_bucketsPerWindow;
+}
+
+} // namespace Ogn
@@ -0,0 +1,191 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "OgnParser.h"
+
+namespace Ogn {
+
+//! Quantities kept by OgnWeatherCache, as decoded by OgnParser
+enum class OgnWeatherQuantity
+{
+    WindSpeed,
+    WindGustSpeed,
+    Temperature,
+    Humidity,
+    Pressure,
+};
+
+/*! \brief Latest report of a weather station
+ *
+ *  Quantities that the report does not contain are NaN.
+ */
+struct OgnWeatherReading
+{
+    double time = 0.0;               // seconds, as passed to OgnWeatherCache::update
+    double latitude = std::numeric_limits<double>::quiet_NaN();      // degrees (WGS84)
+    double longitude = std::numeric_limits<double>::quiet_NaN();     // degrees (WGS84)
+    double windDirection = std::numeric_limits<double>::quiet_NaN(); // degrees
+    double windSpeed = std::numeric_limits<double>::quiet_NaN();     // m/s, as OgnMessageData::wind_speed
+    double windGustSpeed = std::numeric_limits<double>::quiet_NaN(); // m/s, as OgnMessageData::wind_gust_speed
+    double temperature = std::numeric_limits<double>::quiet_NaN();   // degree Celsius, converted from Fahrenheit
+    double humidity = std::numeric_limits<double>::quiet_NaN();      // percent
+    double pressure = std::numeric_limits<double>::quiet_NaN();      // hPa
+};
+
+/*! \brief Statistics of one quantity over a window */
+struct OgnWeatherStatistics
+{
+    std::size_t count = 0;
+    double mean = std::numeric_limits<double>::quiet_NaN();
+    double minimum = std::numeric_limits<double>::quiet_NaN();
+    double maximum = std::numeric_limits<double>::quiet_NaN();
+};
+
+/*! \brief Latest reading and rolling statistics of weather stations
+ *
+ *  The cache is fed with parsed weather reports and keeps, for every
+ *  station, the latest reading plus mean, minimum and maximum of each
+ *  quantity over a few rolling time windows. Reports are not retained.
+ *
+ *  Every window is divided into a fixed number of buckets, which hold
+ *  count, sum, minimum and maximum of the reports that fall into them. An
+ *  update touches one bucket per window, a query combines the buckets of
+ *  one window. The window therefore advances in steps of one bucket, and
+ *  covers between (buckets-1)/buckets and all of its nominal length.
+ *
+ *  Stations are keyed by their source ID, such as "FNT08075C". Weather
+ *  stations are typically received via several receivers. A report that
+ *  repeats the timestamp of the latest report of its station is ignored.
+ *
+ *  Times are seconds on an arbitrary, monotonic clock chosen by the caller.
+ *
+ *  The cache is not thread-safe.
+ */
+class OgnWeatherCache
+{
+public:
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    /*! \brief Create empty cache
+     *
+     *  \param windows Lengths of the rolling windows in seconds
+     *  \param bucketsPerWindow Resolution of the windows
+     */
+    explicit OgnWeatherCache(std::vector<double> windows = {600.0, 3600.0}, std::size_t bucketsPerWindow = 20);
+
+    /*! \brief Add a weather report
+     *
+     *  \param message Parsed message
+     *  \param now Current time in seconds
+     *  \return False if the message is not a weather report, or repeats
+     *  the latest report of its station
+     */
+    bool update(const OgnMessageData& message, double now);
+
+    /*! \brief Remove stations without reports for longer than timeout seconds
+     *
+     *  Takes time proportional to the number of stations.
+     */
+    void expire(double now, double timeout);
+
+    void clear();
+
+    //! Index of the station, or npos. Indices change when stations are removed.
+    [[nodiscard]] std::size_t find(std::string_view station) const;
+
+    //! Number of stations
+    [[nodiscard]] std::size_t size() const { return m_stations.size(); }
+    [[nodiscard]] bool empty() const { return m_stations.empty(); }
+
+    //! Source ID of the station at index, 0 <= index < size()
+    [[nodiscard]] const std::string& station(std::size_t index) const { return m_stations[index].name; }
+
+    //! Latest reading of the station at index
+    [[nodiscard]] const OgnWeatherReading& latest(std::size_t index) const { return m_stations[index].latest; }
+
+    //! Number of windows, and their lengths in seconds
+    [[nodiscard]] std::size_t windowCount() const { return m_windows.size(); }
+    [[nodiscard]] double window(std::size_t window) const { return m_windows[window].length; }
+
+    /*! \brief Statistics of a quantity over the given window, ending now
+     *
+     *  Reports count only for the quantities they contain.
+     */
+    [[nodiscard]] OgnWeatherStatistics statistics(std::size_t index, OgnWeatherQuantity quantity, std::size_t window, double now) const;
+
+    /*! \brief Direction of the mean wind vector over the given window
+     *
+     *  \return Direction in degrees 0..360, or NaN if there are no reports
+     *  with wind direction and speed, or the mean wind is calm
+     */
+    [[nodiscard]] double meanWindDirection(std::size_t index, std::size_t window, double now) const;
+
+private:
+    static constexpr std::size_t QuantityCount = static_cast<std::size_t>(OgnWeatherQuantity::Pressure) + 1;
+
+    struct Bucket
+    {
+        int64_t number = std::numeric_limits<int64_t>::min(); // floor(time / bucket width)
+        uint32_t count[QuantityCount] = {};
+        double sum[QuantityCount] = {};
+        double minimum[QuantityCount] = {};
+        double maximum[QuantityCount] = {};
+        double windX = 0.0; // sums of the wind vector components
+        double windY = 0.0;
+    };
+
+    struct Window
+    {
+        double length;
+        double bucketWidth;
+    };
+
+    [[nodiscard]] int64_t bucketNumber(std::size_t window, double time) const;
+    [[nodiscard]] Bucket* buckets(std::size_t index, std::size_t window);
+    [[nodiscard]] const Bucket* buckets(std::size_t index, std::size_t window) const;
+
+    struct Station
+    {
+        std::string name;
+        std::string timestamp; // of the latest report, "hhmmss"
+        OgnWeatherReading latest;
+    };
+
+    std::vector<Window> m_windows;
+    std::size_t m_bucketsPerWindow;
+
+    std::map<std::string, std::size_t, std::less<>> m_index;
+    std::vector<Station> m_stations;
+    // Buckets of all stations and windows, station by station
+    std::vector<Bucket> m_buckets;
+};
+
+} // namespace Ogn
@@ -2,7 +2,24 @@
  *   Unit tests for OgnParser - Qt-free version                           *
  ***************************************************************************/
 
+#include "OgnColumnBatch.h"
+#include "OgnDuplicateFilter.h"
+#include "OgnExtrapolator.h"
+#include "OgnLatencyHistogram.h"
 #include "OgnParser.h"
+#include "OgnPreFilter.h"
+#include "OgnProximity.h"
+#include "OgnReceiverTable.h"
+#include "OgnTokenizer.h"
+#include "OgnTrafficRecord.h"
+#include "OgnTrafficTable.h"
+#include "OgnWeatherCache.h"
+#include "OutputFormatter.h"
+#include "SpscQueue.h"
+#if defined(ENROUTE_OGN_ALLOC_CHECK)
+#include "AllocationCounter.h"
+#endif
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -10,9 +27,19 @@
 #include <cmath>
 #include <locale>
 #include <cassert>
+#include <cstdio>
 #include <cstring>
+#include <charconv>
 #include <ctime>
 #include <functional>
+#include <map>
+#include <random>
+#include <set>
+#include <thread>
+
+#if defined(__APPLE__) || defined(__ANDROID__)
+#include <xlocale.h>
+#endif
 
 using namespace Ogn;
 
@@ -62,10 +89,92 @@ std::string getCurrentUtcTimeString() {
     return buffer;
 }
 
+// Read all lines of the recorded APRS-IS stream tests/received_data.txt
+std::vector<std::string> readReceivedData() {
+    std::vector<std::string> lines;
+    std::ifstream file(OGN_TEST_DATA_DIR "/received_data.txt");
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+// Compare doubles, treating NaN as equal to NaN
+bool sameDouble(double a, double b) {
+    return (std::isnan(a) && std::isnan(b)) || (a == b);
+}
+
+// Compare all parsed fields of two messages
+bool sameMessageData(const OgnMessageData& a, const OgnMessageData& b) {
+    return a.type == b.type
+        && a.sourceId == b.sourceId
+        && a.timestamp == b.timestamp
+        && sameDouble(a.latitude, b.latitude)
+        && sameDouble(a.longitude, b.longitude)
+        && sameDouble(a.altitude, b.altitude)
+        && a.symbol == b.symbol
+        && sameDouble(a.course, b.course)
+        && sameDouble(a.speed, b.speed)
+        && a.aircraftID == b.aircraftID
+        && a.aircraftIDValue == b.aircraftIDValue
+        && sameDouble(a.verticalSpeed, b.verticalSpeed)
+        && a.rotationRate == b.rotationRate
+        && sameDouble(a.turnRate, b.turnRate)
+        && a.signalStrength == b.signalStrength
+        && a.errorCount == b.errorCount
+        && a.frequencyOffset == b.frequencyOffset
+        && a.squawk == b.squawk
+        && a.flightlevel == b.flightlevel
+        && a.flightnumber == b.flightnumber
+        && a.gpsInfo == b.gpsInfo
+        && a.aircraftType == b.aircraftType
+        && a.addressType == b.addressType
+        && a.address == b.address
+        && a.addressValue == b.addressValue
+        && a.stealthMode == b.stealthMode
+        && a.noTrackingFlag == b.noTrackingFlag
+        && a.wind_direction == b.wind_direction
+        && a.wind_speed == b.wind_speed
+        && a.wind_gust_speed == b.wind_gust_speed
+        && a.temperature == b.temperature
+        && a.humidity == b.humidity
+        && sameDouble(a.pressure, b.pressure)
+        && a.weatherFields == b.weatherFields;
+}
+
+// Reference implementation of the coordinate decoder, as used before the
+// fixed-point decoder: parse degrees and minutes as floating point numbers.
+double referenceDecodeCoordinate(std::string_view nmea, std::size_t degreeDigits, char enhancement) {
+    double degrees = 0.0;
+    double minutes = 0.0;
+    std::string_view const minutesStr = nmea.substr(degreeDigits);
+#if defined(__ANDROID__) || defined(__APPLE__)
+    static const locale_t c_locale = newlocale(LC_ALL_MASK, "C", static_cast<locale_t>(nullptr));
+    const std::string degreesBuffer(nmea.substr(0, degreeDigits));
+    const std::string minutesBuffer(minutesStr);
+    degrees = strtod_l(degreesBuffer.c_str(), nullptr, c_locale);
+    minutes = strtod_l(minutesBuffer.c_str(), nullptr, c_locale);
+#else
+    std::from_chars(nmea.data(), nmea.data() + degreeDigits, degrees);
+    std::from_chars(minutesStr.data(), minutesStr.data() + minutesStr.size(), minutes);
+#endif
+    double coordinate = degrees + (minutes / 60.0);
+    if (enhancement >= '0' && enhancement <= '9') {
+        coordinate += static_cast<double>(enhancement - '0') * 0.001 / 60;
+    }
+    return coordinate;
+}
+
 // Forward declarations
 bool testFormatLoginString();
 bool testFormatFilterCommand();
 bool testFormatPositionReport();
+bool testFormatPositionReport_symbols();
+bool testFormatPositionReport_buffers();
 bool testParseAprsisMessage_validTrafficReport1();
 bool testParseAprsisMessage_validTrafficReport2();
 bool testParseAprsisMessage_validTrafficReport3();
@@ -75,6 +184,30 @@ bool testParseAprsisMessage_commentMessage();
 bool testParseAprsisMessage_receiverStatusMessage();
 bool testParseAprsisMessage_weatherReport();
 bool testParseAprsisMessage_multipleMessages();
+bool testParseAprsisBatch();
+bool testParseAprsisMessage_messageView();
+bool testParseAprsisMessage_fieldMask();
+bool testPreFilter();
+#if defined(ENROUTE_OGN_ALLOC_CHECK)
+bool testParseAprsisMessage_noAllocations();
+#endif
+bool testTokenizer();
+bool testTrafficRecord();
+bool testColumnBatch();
+bool testTrafficTable();
+bool testDuplicateFilter();
+bool testWeatherCache();
+bool testReceiverTable();
+bool testTrafficTable_spatialQueries();
+bool testExtrapolator();
+bool testProximityMonitor();
+bool testLatencyHistogram();
+bool testSpscQueue();
+bool testFormatMessages();
+bool testDecodeCoordinates_exhaustive();
+bool testDecodeCoordinates_invalid();
+bool testParseAprsisMessage_multiThreaded();
+bool testFormatPositionReport_multiThreaded();
 bool testPerformanceOfParseAprsisMessage();
 
 // Test registry
@@ -87,6 +220,8 @@ const Test tests[] = {
     {"testFormatLoginString", testFormatLoginString},
     {"testFormatFilterCommand", testFormatFilterCommand},
     {"testFormatPositionReport", testFormatPositionReport},
+    {"testFormatPositionReport_symbols", testFormatPositionReport_symbols},
+    {"testFormatPositionReport_buffers", testFormatPositionReport_buffers},
     {"testParseAprsisMessage_validTrafficReport1", testParseAprsisMessage_validTrafficReport1},
     {"testParseAprsisMessage_validTrafficReport2", testParseAprsisMessage_validTrafficReport2},
     {"testParseAprsisMessage_validTrafficReport3", testParseAprsisMessage_validTrafficReport3},
@@ -96,6 +231,30 @@ const Test tests[] = {
     {"testParseAprsisMessage_receiverStatusMessage", testParseAprsisMessage_receiverStatusMessage},
     {"testParseAprsisMessage_weatherReport", testParseAprsisMessage_weatherReport},
     {"testParseAprsisMessage_multipleMessages", testParseAprsisMessage_multipleMessages},
+    {"testParseAprsisBatch", testParseAprsisBatch},
+    {"testParseAprsisMessage_messageView", testParseAprsisMessage_messageView},
+    {"testParseAprsisMessage_fieldMask", testParseAprsisMessage_fieldMask},
+    {"testPreFilter", testPreFilter},
+#if defined(ENROUTE_OGN_ALLOC_CHECK)
+    {"testParseAprsisMessage_noAllocations", testParseAprsisMessage_noAllocations},
+#endif
+    {"testTokenizer", testTokenizer},
+    {"testTrafficRecord", testTrafficRecord},
+    {"testColumnBatch", testColumnBatch},
+    {"testTrafficTable", testTrafficTable},
+    {"testDuplicateFilter", testDuplicateFilter},
+    {"testWeatherCache", testWeatherCache},
+    {"testReceiverTable", testReceiverTable},
+    {"testTrafficTable_spatialQueries", testTrafficTable_spatialQueries},
+    {"testExtrapolator", testExtrapolator},
+    {"testProximityMonitor", testProximityMonitor},
+    {"testLatencyHistogram", testLatencyHistogram},
+    {"testSpscQueue", testSpscQueue},
+    {"testFormatMessages", testFormatMessages},
+    {"testDecodeCoordinates_exhaustive", testDecodeCoordinates_exhaustive},
+    {"testDecodeCoordinates_invalid", testDecodeCoordinates_invalid},
+    {"testParseAprsisMessage_multiThreaded", testParseAprsisMessage_multiThreaded},
+    {"testFormatPositionReport_multiThreaded", testFormatPositionReport_multiThreaded},
     {"testPerformanceOfParseAprsisMessage", testPerformanceOfParseAprsisMessage},
 };
 
@@ -150,6 +309,100 @@ bool testFormatPositionReport() {
     return true;
 }
 
+bool testFormatPositionReport_symbols() {
+    // Position report and the symbol that the parser decodes from it
+    struct Expectation {
+        OgnAircraftType aircraftType;
+        char table;
+        char code;
+        OgnSymbol symbol;
+    };
+    const Expectation expectations[] = {
+        {OgnAircraftType::unknown,        '/',  'z',  OgnSymbol::UNKNOWN},
+        {OgnAircraftType::Glider,         '/',  '\'', OgnSymbol::GLIDER},
+        {OgnAircraftType::Copter,         '/',  'X',  OgnSymbol::HELICOPTER},
+        {OgnAircraftType::Paraglider,     '/',  'g',  OgnSymbol::PARACHUTE},
+        {OgnAircraftType::Aircraft,       '\\', '^',  OgnSymbol::AIRCRAFT},
+        {OgnAircraftType::Jet,            '/',  '^',  OgnSymbol::JET},
+        {OgnAircraftType::Balloon,        '/',  'O',  OgnSymbol::BALLOON},
+        {OgnAircraftType::StaticObstacle, '\\', 'n',  OgnSymbol::STATIC_OBJECT},
+        {OgnAircraftType::TowPlane,       '\\', '^',  OgnSymbol::AIRCRAFT},
+        {OgnAircraftType::Drone,          '\\', '^',  OgnSymbol::AIRCRAFT},
+    };
+
+    for (const auto& expectation : expectations) {
+        const std::string positionReport = OgnParser::formatPositionReport(
+            "ENR12345", 51.1886666667, -1.034, 185.0136, 86.0, 7.0, expectation.aircraftType);
+        // "ENR12345>APRS,TCPIP*: /hhmmssh5111.32N/00102.04W'086/007/A=000607\n"
+        ASSERT_EQ(positionReport[38], expectation.table);
+        ASSERT_EQ(positionReport[48], expectation.code);
+
+        // The report has a blank after the colon and ends with a newline, which the parser does not expect
+        OgnMessage message;
+        message.sentence = positionReport.substr(0, 21) + positionReport.substr(22, positionReport.size() - 23);
+        OgnParser::parseAprsisMessage(message);
+        ASSERT_EQ(static_cast<int>(message.type), static_cast<int>(OgnMessageType::TRAFFIC_REPORT));
+        ASSERT_EQ(static_cast<int>(message.symbol), static_cast<int>(expectation.symbol));
+    }
+
+    // Symbols outside the table, including overlays and non-ASCII codes
+    OgnMessage message;
+    message.sentence = "LFNW>APRS,TCPIP*,qAC,GLIDERN5:/183804h4254.53NI00203.90E&/A=001000";
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_EQ(static_cast<int>(message.symbol), static_cast<int>(OgnSymbol::UNKNOWN));
+    message.reset();
+    message.sentence = "LFNW>APRS,TCPIP*,qAC,GLIDERN5:/183804h4254.53N/00203.90E\xE9/A=001000";
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_EQ(static_cast<int>(message.symbol), static_cast<int>(OgnSymbol::UNKNOWN));
+    return true;
+}
+
+bool testFormatPositionReport_buffers() {
+    // Login string into a char buffer, and appended to a std::string
+    char buffer[256];
+    const std::string login = "user ENR12345 pass 379 vers Enroute 1.99 filter r/-48.0000/7.8512/99 t/o\n";
+    std::size_t size = OgnParser::formatLoginString(buffer, sizeof(buffer), "ENR12345", -48.0, 7.85123456, 99, "Enroute", "1.99");
+    ASSERT_EQ(std::string(buffer, size), login);
+    ASSERT_EQ(OgnParser::formatLoginString(buffer, login.size() - 1, "ENR12345", -48.0, 7.85123456, 99, "Enroute", "1.99"), 0u);
+    ASSERT_EQ(OgnParser::formatLoginString(buffer, login.size(), "ENR12345", -48.0, 7.85123456, 99, "Enroute", "1.99"), login.size());
+    std::string out = "prefix ";
+    OgnParser::formatLoginString(out, "ENR12345", -48.0, 7.85123456, 99, "Enroute", "1.99");
+    ASSERT_EQ(out, "prefix " + login);
+
+    // Filter command, rounded to four decimals
+    size = OgnParser::formatFilterCommand(buffer, sizeof(buffer), -0.00001, 179.99995, 5);
+    ASSERT_EQ(std::string(buffer, size), "# filter r/-0.0000/180.0000/5 t/o\n");
+    out.clear();
+    OgnParser::formatFilterCommand(out, -48.0, 7.85123456, 99);
+    ASSERT_EQ(out, "# filter r/-48.0000/7.8512/99 t/o\n");
+
+    // Position report. The timestamp is skipped, as a second may pass between the calls.
+    const std::string report = OgnParser::formatPositionReport("ENR12345", 51.1886666667, -1.034, 185.0136, 86.0, 7.0, OgnAircraftType::Glider);
+    size = OgnParser::formatPositionReport(buffer, sizeof(buffer), "ENR12345", 51.1886666667, -1.034, 185.0136, 86.0, 7.0, OgnAircraftType::Glider);
+    ASSERT_EQ(size, report.size());
+    ASSERT_EQ(std::string(buffer, 23), report.substr(0, 23));
+    ASSERT_EQ(std::string(buffer + 29, size - 29), report.substr(29));
+    ASSERT_EQ(OgnParser::formatPositionReport(buffer, 20, "ENR12345", 51.1886666667, -1.034, 185.0136, 86.0, 7.0, OgnAircraftType::Glider), 0u);
+
+    // Minutes that round to 60 carry over into the degrees
+    size = OgnParser::formatPositionReport(buffer, sizeof(buffer), "ENR12345", 47.9999999, -10.9999999, 0.0, 0.0, 0.0, OgnAircraftType::Glider);
+    ASSERT_EQ(std::string(buffer + 30, 18), "4800.00N/01100.00W");
+
+#if defined(ENROUTE_OGN_ALLOC_CHECK)
+    // No allocations into a char buffer, or into a std::string with sufficient capacity
+    out.clear();
+    out.reserve(1024);
+    const std::size_t before = AllocationCounter::allocations();
+    OgnParser::formatPositionReport(buffer, sizeof(buffer), "ENR12345", 51.1886666667, -1.034, 185.0136, 86.0, 7.0, OgnAircraftType::Glider);
+    OgnParser::formatLoginString(buffer, sizeof(buffer), "ENR12345", -48.0, 7.85123456, 99, "Enroute", "1.99");
+    OgnParser::formatPositionReport(out, "ENR12345", 51.1886666667, -1.034, 185.0136, 86.0, 7.0, OgnAircraftType::Glider);
+    OgnParser::formatLoginString(out, "ENR12345", -48.0, 7.85123456, 99, "Enroute", "1.99");
+    OgnParser::formatFilterCommand(out, -48.0, 7.85123456, 99);
+    ASSERT_EQ(AllocationCounter::allocations() - before, 0u);
+#endif
+    return true;
+}
+
 bool testParseAprsisMessage_validTrafficReport1() {
     std::string sentence = "FLRDDE626>APRS,qAS,EGHL:/074548h5111.32N/00102.04W'086/007/A=000607 id0ADDE626 -019fpm +0.0rot 5.5dB 3e -4.3kHz";
     OgnMessage message;
@@ -167,14 +420,26 @@ bool testParseAprsisMessage_validTrafficReport1() {
     ASSERT_EQ(std::string(message.aircraftID), std::string("0ADDE626"));
     ASSERT_DOUBLE_EQ(message.verticalSpeed, -0.09652);
     ASSERT_EQ(std::string(message.rotationRate), std::string("+0.0rot"));
+    ASSERT_DOUBLE_EQ(message.turnRate, 0.0);
     ASSERT_EQ(std::string(message.signalStrength), std::string("5.5dB"));
     ASSERT_EQ(std::string(message.errorCount), std::string("3e"));
     ASSERT_EQ(std::string(message.frequencyOffset), std::string("-4.3kHz"));
     ASSERT_EQ(static_cast<int>(message.aircraftType), static_cast<int>(Ogn::OgnAircraftType::TowPlane));
     ASSERT_EQ(static_cast<int>(message.addressType), static_cast<int>(OgnAddressType::FLARM));
     ASSERT_EQ(std::string(message.address), std::string("DDE626"));
+    ASSERT_EQ(message.aircraftIDValue, 0x0ADDE626u);
+    ASSERT_EQ(message.addressValue, 0xDDE626u);
     ASSERT_EQ(message.stealthMode, false);
     ASSERT_EQ(message.noTrackingFlag, false);
+
+    // Aircraft IDs with other than eight hex digits give no address
+    for (const char* id : {"id0ADDE6", "id0ADDXYZW"}) {
+        OgnMessage invalid;
+        invalid.sentence = std::string("FLRDDE626>APRS,qAS,EGHL:/074548h5111.32N/00102.04W'086/007/A=000607 ") + id + " -019fpm";
+        OgnParser::parseAprsisMessage(invalid);
+        ASSERT_TRUE(invalid.address.empty());
+        ASSERT_EQ(invalid.addressValue, OgnMessageData::InvalidAddress);
+    }
     return true;
 }
 
@@ -193,6 +458,9 @@ bool testParseAprsisMessage_validTrafficReport2() {
     ASSERT_DOUBLE_EQ(message.course, 124.0);
     ASSERT_DOUBLE_EQ(message.speed, 460.0);
     ASSERT_EQ(std::string(message.aircraftID), std::string("254D21C2"));
+    ASSERT_EQ(message.aircraftIDValue, 0x254D21C2u);
+    ASSERT_EQ(message.addressValue, 0x4D21C2u);
+    ASSERT_EQ(static_cast<int>(message.addressType), static_cast<int>(OgnAddressType::ICAO));
     return true;
 }
 
@@ -230,6 +498,53 @@ bool testParseAprsisMessage_receiverStatusMessage() {
 
     ASSERT_EQ(message.sentence, sentence);
     ASSERT_EQ(static_cast<int>(message.type), static_cast<int>(OgnMessageType::STATUS));
+    ASSERT_EQ(message.sourceId, "FLRDDE626");
+    ASSERT_EQ(message.destination, "APRS");
+    ASSERT_EQ(message.receiver, "EGHL");
+    ASSERT_TRUE(message.version.empty());
+    ASSERT_TRUE(std::isnan(message.cpuLoad));
+
+    // Status beacon of a receiver
+    sentence = "EDQG>OGNSDR,TCPIP*,qAC,GLIDERN5:>222247h v0.3.2.arm64 CPU:0.9 RAM:278.4/951.4MB NTP:0.6ms/-2.0ppm +54.2C EGM96:+48m 0/0Acfts[1h] RF:+0+0.0ppm/+5.69dB/-2.8dB@10km[1536]/-4.7dB@10km[2/3]";
+    message.reset();
+    message.sentence = sentence;
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_EQ(static_cast<int>(message.type), static_cast<int>(OgnMessageType::STATUS));
+    ASSERT_EQ(message.sourceId, "EDQG");
+    ASSERT_EQ(message.destination, "OGNSDR");
+    ASSERT_TRUE(message.receiver.empty());
+    ASSERT_EQ(message.timestamp, "222247");
+    ASSERT_EQ(message.version, "0.3.2");
+    ASSERT_EQ(message.platform, "arm64");
+    ASSERT_DOUBLE_EQ(message.cpuLoad, 0.9);
+    ASSERT_DOUBLE_EQ(message.ramFree, 278.4);
+    ASSERT_DOUBLE_EQ(message.ramTotal, 951.4);
+    ASSERT_DOUBLE_EQ(message.ntpOffset, 0.6);
+    ASSERT_DOUBLE_EQ(message.ntpCorrection, -2.0);
+    ASSERT_DOUBLE_EQ(message.cpuTemperature, 54.2);
+
+    // Platform names may contain dashes, other receivers report no version number
+    sentence = "reg4>OGNSDR,TCPIP*,qAC,GLIDERN1:>222249h v0.3.2.RPI-GPU CPU:1.0 RAM:693.2/968.1MB NTP:0.0ms/-2.5ppm +60.7C";
+    message.reset();
+    message.sentence = sentence;
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_EQ(message.version, "0.3.2");
+    ASSERT_EQ(message.platform, "RPI-GPU");
+    sentence = "testbach>OGNSXR,TCPIP*,qAC,GIGA01:>222248h vMB145-ESP32-SX1276-OGNbase 0/min 0/0Acfts[1h] ";
+    message.reset();
+    message.sentence = sentence;
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_EQ(message.timestamp, "222248");
+    ASSERT_TRUE(message.version.empty());
+    ASSERT_TRUE(std::isnan(message.ramTotal));
+
+    // Without OgnField::ReceiverStatus
+    message.reset();
+    message.sentence = "EDQG>OGNSDR,TCPIP*,qAC,GLIDERN5:>222247h v0.3.2.arm64 CPU:0.9 RAM:278.4/951.4MB";
+    OgnParser::parseAprsisMessage(message, OgnField::All & ~OgnField::ReceiverStatus);
+    ASSERT_EQ(message.timestamp, "222247");
+    ASSERT_TRUE(message.version.empty());
+    ASSERT_TRUE(std::isnan(message.cpuLoad));
     return true;
 }
 
@@ -247,6 +562,18 @@ bool testParseAprsisMessage_weatherReport() {
     ASSERT_TRUE(std::isnan(message.altitude));
     ASSERT_EQ(message.wind_direction, 292u);
     ASSERT_EQ(message.wind_speed, 5u);
+    ASSERT_EQ(message.temperature, 30u);
+    ASSERT_EQ(message.humidity, 1u);
+    ASSERT_EQ(static_cast<int>(message.weatherFields), 0x3F);
+
+    // Below zero Fahrenheit; no gust, humidity and pressure
+    message.reset();
+    message.sentence = "FNT08075C>OGNFNT,qAS,Hoernle2:/222245h4803.92N/00800.93E_292/005t-05 5.2dB";
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_EQ(static_cast<int>(message.type), static_cast<int>(OgnMessageType::WEATHER));
+    ASSERT_EQ(static_cast<int32_t>(message.temperature), -5);
+    ASSERT_EQ(static_cast<int>(message.weatherFields),
+              OgnMessageData::HasWindDirection | OgnMessageData::HasWindSpeed | OgnMessageData::HasTemperature);
     return true;
 }
 
@@ -267,6 +594,82 @@ bool testParseAprsisMessage_multipleMessages() {
     return true;
 }
 
+bool testParseAprsisBatch() {
+    const std::string chunk =
+        "FLRDDE626>APRS,qAS,EGHL:/074548h5111.32N/00102.04W'086/007/A=000607 id0ADDE626 -019fpm +0.0rot 5.5dB 3e -4.3kHz\r\n"
+        "# aprsc 2.0.14-g28c5a6a 29 Jun 2014 07:46:15 GMT GLIDERN1 37.187.40.234:14580\n"
+        "\r\n"
+        "FNT08075C>OGNFNT,qAS,Hoernle2:/222245h4803.92N/00800.93E_292/005g010t030h01b65526 5.2dB\n"
+        "LFNW>APRS,TCPIP*,qAC,GLIDERN5:>183804h v0.2.6.ARM CPU:0.7 RAM:505.3/889.7MB";
+
+    // Pre-fill the vector to check that it is cleared
+    std::vector<OgnMessageView> messages(7);
+    const std::size_t count = OgnParser::parseAprsisBatch(chunk, messages);
+
+    ASSERT_EQ(count, 4u);
+    ASSERT_EQ(messages.size(), 4u);
+    ASSERT_EQ(static_cast<int>(messages[0].type), static_cast<int>(OgnMessageType::TRAFFIC_REPORT));
+    ASSERT_EQ(static_cast<int>(messages[1].type), static_cast<int>(OgnMessageType::COMMENT));
+    ASSERT_EQ(static_cast<int>(messages[2].type), static_cast<int>(OgnMessageType::WEATHER));
+    ASSERT_EQ(static_cast<int>(messages[3].type), static_cast<int>(OgnMessageType::STATUS));
+
+    // Fields must point into the chunk
+    const OgnMessageView& traffic = messages[0];
+    ASSERT_EQ(traffic.sentence, "FLRDDE626>APRS,qAS,EGHL:/074548h5111.32N/00102.04W'086/007/A=000607 id0ADDE626 -019fpm +0.0rot 5.5dB 3e -4.3kHz");
+    ASSERT_TRUE(traffic.sentence.data() == chunk.data());
+    ASSERT_EQ(traffic.sourceId, "FLRDDE626");
+    ASSERT_EQ(traffic.frequencyOffset, "-4.3kHz");
+    ASSERT_TRUE(traffic.address.data() >= chunk.data());
+    ASSERT_TRUE(traffic.address.data() + traffic.address.size() <= chunk.data() + chunk.size());
+    ASSERT_DOUBLE_EQ(traffic.latitude, +51.1886666667);
+    ASSERT_DOUBLE_EQ(traffic.longitude, -1.034);
+    ASSERT_EQ(messages[2].wind_direction, 292u);
+
+    // Results must agree with parsing line by line
+    OgnMessage single;
+    single.sentence = "FNT08075C>OGNFNT,qAS,Hoernle2:/222245h4803.92N/00800.93E_292/005g010t030h01b65526 5.2dB";
+    OgnParser::parseAprsisMessage(single);
+    ASSERT_EQ(single.sourceId, messages[2].sourceId);
+    ASSERT_DOUBLE_EQ(single.latitude, messages[2].latitude);
+    ASSERT_DOUBLE_EQ(single.pressure, messages[2].pressure);
+
+    // Empty chunk
+    ASSERT_EQ(OgnParser::parseAprsisBatch(std::string_view(), messages), 0u);
+    ASSERT_TRUE(messages.empty());
+    return true;
+}
+
+bool testParseAprsisMessage_messageView() {
+    const std::string sentence = "ICA4D21C2>OGADSB,qAS,HLST:/001140h4741.90N/01104.20E^124/460/A=034868 !W91! id254D21C2 +128fpm FL350.00 A3:AXY547M Sq2244";
+    OgnMessageView view;
+    view.sentence = sentence;
+    OgnParser::parseAprsisMessage(view);
+
+    // Copies refer to the same buffer and need no fix-up
+    const OgnMessageView copy = view;
+    ASSERT_EQ(static_cast<int>(copy.type), static_cast<int>(OgnMessageType::TRAFFIC_REPORT));
+    ASSERT_TRUE(copy.sentence.data() == sentence.data());
+    ASSERT_EQ(copy.address, "4D21C2");
+    ASSERT_EQ(copy.flightnumber, "AXY547M");
+    ASSERT_DOUBLE_EQ(copy.altitude, 10627.7664);
+
+    // Parsing an owning message gives the same result, and view() exposes it without copying the sentence
+    OgnMessage message;
+    message.sentence = sentence;
+    OgnParser::parseAprsisMessage(message);
+    const OgnMessageView messageView = message.view();
+    ASSERT_TRUE(messageView.sentence.data() == message.sentence.data());
+    ASSERT_EQ(messageView.address, copy.address);
+    ASSERT_EQ(messageView.squawk, copy.squawk);
+    ASSERT_DOUBLE_EQ(messageView.latitude, copy.latitude);
+    ASSERT_DOUBLE_EQ(messageView.longitude, copy.longitude);
+
+    view.reset();
+    ASSERT_TRUE(view.sentence.empty());
+    ASSERT_EQ(static_cast<int>(view.type), static_cast<int>(OgnMessageType::UNKNOWN));
+    return true;
+}
+
 bool testParseAprsisMessage_validTrafficReport3() {
     std::string sentence = "ICA4D21C2>OGADSB,qAS,HLST:/001140h4741.90N/01104.20E^/A=034868 !W91! id254D21C2 +128fpm FL350.00 A3:AXY547M Sq2244";
     OgnMessage message;
@@ -318,6 +721,1518 @@ bool testParseAprsisMessage_Docu() {
     return true;
 }
 
+#if defined(ENROUTE_OGN_ALLOC_CHECK)
+bool testParseAprsisMessage_noAllocations() {
+    // Parsing traffic, weather and status sentences must not allocate
+    const std::vector<std::string> lines = readReceivedData();
+    ASSERT_GE(lines.size(), 100u);
+
+    int checked = 0;
+    OgnMessage message;
+    for (const auto& line : lines) {
+        message.reset();
+        message.sentence = line;
+
+        OgnMessageView view;
+        view.sentence = line;
+        const std::size_t before = AllocationCounter::allocations();
+        OgnParser::parseAprsisMessage(message);
+        OgnParser::parseAprsisMessage(view);
+        const std::size_t allocations = AllocationCounter::allocations() - before;
+
+        if (message.type == OgnMessageType::TRAFFIC_REPORT ||
+            message.type == OgnMessageType::WEATHER ||
+            message.type == OgnMessageType::STATUS) {
+            if (allocations != 0) {
+                std::cerr << "Allocation while parsing: " << line << std::endl;
+            }
+            ASSERT_EQ(allocations, 0u);
+            checked++;
+        }
+    }
+    ASSERT_GE(checked, 100);
+
+    // Batch parsing into a vector with sufficient capacity
+    std::string chunk;
+    for (const auto& line : lines) {
+        chunk += line;
+        chunk += '\n';
+    }
+    std::vector<OgnMessageView> messages;
+    messages.reserve(lines.size());
+    const std::size_t before = AllocationCounter::allocations();
+    const std::size_t count = OgnParser::parseAprsisBatch(chunk, messages);
+    ASSERT_EQ(AllocationCounter::allocations() - before, 0u);
+    ASSERT_EQ(count, lines.size());
+    return true;
+}
+#endif
+
+bool testParseAprsisMessage_fieldMask() {
+    const std::string traffic = "FLRDDE626>APRS,qAS,EGHL:/074548h5111.32N/00102.04W'086/007/A=000607 id0ADDE626 -019fpm +0.0rot 5.5dB 3e -4.3kHz";
+    const std::string weather = "FNT08075C>OGNFNT,qAS,Hoernle2:/222245h4803.92N/00800.93E_292/005g010t030h01b65526 5.2dB";
+    const std::string status = "LFNW>APRS,TCPIP*,qAC,GLIDERN5:>183804h v0.2.6.ARM CPU:0.7 RAM:505.3/889.7MB";
+    const std::string comment = "# aprsc 2.0.14-g28c5a6a 29 Jun 2014 07:46:15 GMT GLIDERN1 37.187.40.234:14580";
+
+    // Selected fields only
+    const uint32_t positionOnly = OgnField::TrafficReports | OgnField::Timestamp | OgnField::Position |
+                                  OgnField::Altitude | OgnField::AircraftID;
+    OgnMessage message;
+    message.sentence = traffic;
+    OgnParser::parseAprsisMessage(message, positionOnly);
+    ASSERT_EQ(static_cast<int>(message.type), static_cast<int>(OgnMessageType::TRAFFIC_REPORT));
+    ASSERT_EQ(message.sourceId, "FLRDDE626");
+    ASSERT_EQ(message.timestamp, "074548");
+    ASSERT_DOUBLE_EQ(message.latitude, 51.1886666667);
+    ASSERT_DOUBLE_EQ(message.longitude, -1.034);
+    ASSERT_DOUBLE_EQ(message.altitude, 607 * 0.3048);
+    ASSERT_EQ(message.address, "DDE626");
+    ASSERT_TRUE(message.addressType == OgnAddressType::FLARM);
+    ASSERT_DOUBLE_EQ(message.course, 0.0);
+    ASSERT_DOUBLE_EQ(message.speed, 0.0);
+    ASSERT_DOUBLE_EQ(message.verticalSpeed, 0.0);
+    ASSERT_TRUE(message.rotationRate.empty());
+    ASSERT_TRUE(message.signalStrength.empty());
+    ASSERT_TRUE(message.frequencyOffset.empty());
+
+    // Without OGN part
+    message.reset();
+    message.sentence = traffic;
+    OgnParser::parseAprsisMessage(message, OgnField::TrafficReports | OgnField::Altitude | OgnField::CourseSpeed);
+    ASSERT_EQ(static_cast<int>(message.type), static_cast<int>(OgnMessageType::TRAFFIC_REPORT));
+    ASSERT_TRUE(std::isnan(message.latitude));
+    ASSERT_TRUE(message.aircraftID.empty());
+    ASSERT_DOUBLE_EQ(message.course, 86.0);
+    ASSERT_DOUBLE_EQ(message.speed, 7.0);
+    ASSERT_DOUBLE_EQ(message.altitude, 607 * 0.3048);
+
+    // Message types that are not selected stay unknown
+    for (const std::string* sentence : {&weather, &status, &comment}) {
+        message.reset();
+        message.sentence = *sentence;
+        OgnParser::parseAprsisMessage(message, OgnField::TrafficReports | OgnField::AllFields);
+        ASSERT_EQ(static_cast<int>(message.type), static_cast<int>(OgnMessageType::UNKNOWN));
+    }
+    message.reset();
+    message.sentence = traffic;
+    OgnParser::parseAprsisMessage(message, OgnField::WeatherReports | OgnField::AllFields);
+    ASSERT_EQ(static_cast<int>(message.type), static_cast<int>(OgnMessageType::UNKNOWN));
+    message.reset();
+    message.sentence = weather;
+    OgnParser::parseAprsisMessage(message, OgnField::WeatherReports | OgnField::Weather);
+    ASSERT_EQ(static_cast<int>(message.type), static_cast<int>(OgnMessageType::WEATHER));
+    ASSERT_EQ(message.wind_direction, 292u);
+    ASSERT_EQ(message.humidity, 1u);
+    ASSERT_TRUE(std::isnan(message.latitude));
+
+    // Selected fields agree with a full parse
+    for (const auto& line : readReceivedData()) {
+        OgnMessage full;
+        full.sentence = line;
+        OgnParser::parseAprsisMessage(full);
+
+        OgnMessage all;
+        all.sentence = line;
+        OgnParser::parseAprsisMessage(all, OgnField::All);
+        ASSERT_TRUE(sameMessageData(all, full));
+
+        OgnMessageView partial;
+        partial.sentence = line;
+        OgnParser::parseAprsisMessage(partial, positionOnly);
+        if (full.type == OgnMessageType::TRAFFIC_REPORT) {
+            ASSERT_EQ(static_cast<int>(partial.type), static_cast<int>(full.type));
+            ASSERT_TRUE(sameDouble(partial.latitude, full.latitude));
+            ASSERT_TRUE(sameDouble(partial.longitude, full.longitude));
+            ASSERT_TRUE(sameDouble(partial.altitude, full.altitude));
+            ASSERT_EQ(partial.timestamp, full.timestamp);
+            ASSERT_EQ(partial.address, full.address);
+            ASSERT_TRUE(partial.flightlevel.empty());
+        } else {
+            ASSERT_EQ(static_cast<int>(partial.type), static_cast<int>(OgnMessageType::UNKNOWN));
+        }
+    }
+    return true;
+}
+
+bool testPreFilter() {
+    const std::string chunk =
+        "FLRDDE626>APRS,qAS,EGHL:/074548h5111.32N/00102.04W'086/007/A=000607 id0ADDE626 -019fpm +0.0rot 5.5dB 3e -4.3kHz\n"
+        "ICA4D21C2>OGADSB,qAS,SpainAVX:/001140h4741.90N/01104.20E^/A=034868 !W91! id254D21C2 +128fpm FL350.00 A3:AXY547M Sq2244\n"
+        "FNT08075C>OGNFNT,qAS,Hoernle2:/222245h4803.92N/00800.93E_292/005g010t030h01b65526 5.2dB\n"
+        "LFNW>APRS,TCPIP*,qAC,GLIDERN5:>183804h v0.2.6.ARM CPU:0.7 RAM:505.3/889.7MB\n"
+        "FLRDDE627>APRS,qAS,EGHL:/074548h4800.00N/00800.00E'086/007/A=000607 id8ADDE627 -019fpm\n"
+        "OGN123456>APRS,qAS,EGHL:/074548h4800.00N/00800.00E'086/007/A=000607 id4B123456 -019fpm\n";
+    std::vector<OgnMessageView> messages;
+    const auto sourceIds = [&messages]() {
+        std::string result;
+        for (const auto& message : messages) {
+            result += std::string(message.sourceId) + " ";
+        }
+        return result;
+    };
+
+    // Default filter accepts everything
+    OgnPreFilter filter;
+    ASSERT_EQ(OgnParser::parseAprsisBatch(chunk, messages, filter), 6u);
+    ASSERT_EQ(sourceIds(), "FLRDDE626 ICA4D21C2 FNT08075C LFNW FLRDDE627 OGN123456 ");
+    ASSERT_DOUBLE_EQ(messages[1].latitude, 47.6984833333);
+
+    // Bounding box: status messages pass
+    filter.setBoundingBox(45.0, 5.0, 50.0, 15.0);
+    OgnParser::parseAprsisBatch(chunk, messages, filter);
+    ASSERT_EQ(sourceIds(), "ICA4D21C2 FNT08075C LFNW FLRDDE627 OGN123456 ");
+    filter.setBoundingBox(-90.0, 10.0, 90.0, -1.0); // crosses the antimeridian
+    OgnParser::parseAprsisBatch(chunk, messages, filter);
+    ASSERT_EQ(sourceIds(), "FLRDDE626 ICA4D21C2 LFNW ");
+    filter.clearBoundingBox();
+
+    // Flags
+    filter.setRejectStealth(true);
+    filter.setRejectNoTracking(true);
+    OgnParser::parseAprsisBatch(chunk, messages, filter);
+    ASSERT_EQ(sourceIds(), "FLRDDE626 ICA4D21C2 FNT08075C LFNW ");
+    filter.setRejectStealth(false);
+    filter.setRejectNoTracking(false);
+
+    // Address types: the weather report has no "id" item
+    filter.setAddressTypes(OgnPreFilter::addressTypeBit(OgnAddressType::FLARM));
+    OgnParser::parseAprsisBatch(chunk, messages, filter);
+    ASSERT_EQ(sourceIds(), "FLRDDE626 LFNW FLRDDE627 ");
+    filter.setAddressTypes(OgnPreFilter::addressTypeBit(OgnAddressType::ICAO) | OgnPreFilter::addressTypeBit(OgnAddressType::UNKNOWN));
+    OgnParser::parseAprsisBatch(chunk, messages, filter);
+    ASSERT_EQ(sourceIds(), "ICA4D21C2 FNT08075C LFNW ");
+    filter.setAddressTypes(OgnPreFilter::AllAddressTypes);
+
+    // Allowed and denied addresses
+    filter.setAllowedAddresses({0x123456, 0xDDE626});
+    OgnParser::parseAprsisBatch(chunk, messages, filter);
+    ASSERT_EQ(sourceIds(), "FLRDDE626 LFNW OGN123456 ");
+    filter.setDeniedAddresses({0xDDE626});
+    OgnParser::parseAprsisBatch(chunk, messages, filter);
+    ASSERT_EQ(sourceIds(), "LFNW OGN123456 ");
+    filter.setAllowedAddresses({});
+    OgnParser::parseAprsisBatch(chunk, messages, filter);
+    ASSERT_EQ(sourceIds(), "ICA4D21C2 FNT08075C LFNW FLRDDE627 OGN123456 ");
+
+    // Single messages: rejected reports are left UNKNOWN, accepted ones parse as usual
+    OgnMessage rejected;
+    rejected.sentence = "FLRDDE626>APRS,qAS,EGHL:/074548h5111.32N/00102.04W'086/007/A=000607 id0ADDE626 -019fpm +0.0rot 5.5dB 3e -4.3kHz";
+    OgnParser::parseAprsisMessage(rejected, filter);
+    ASSERT_EQ(static_cast<int>(rejected.type), static_cast<int>(OgnMessageType::UNKNOWN));
+    ASSERT_TRUE(rejected.sourceId.empty());
+    OgnMessage accepted;
+    accepted.sentence = "FNT08075C>OGNFNT,qAS,Hoernle2:/222245h4803.92N/00800.93E_292/005g010t030h01b65526 5.2dB";
+    OgnParser::parseAprsisMessage(accepted, filter, OgnField::WeatherReports | OgnField::Weather);
+    ASSERT_EQ(static_cast<int>(accepted.type), static_cast<int>(OgnMessageType::WEATHER));
+    ASSERT_EQ(accepted.wind_direction, 292u);
+    ASSERT_TRUE(std::isnan(accepted.latitude));
+
+    // Truncated bodies never pass a bounding box
+    filter.setBoundingBox(-90.0, -180.0, 90.0, 180.0);
+    OgnMessage truncated;
+    truncated.sentence = "FLRDDE626>APRS,qAS,EGHL:/074548h5111.32N/0010";
+    OgnParser::parseAprsisMessage(truncated, filter);
+    ASSERT_EQ(static_cast<int>(truncated.type), static_cast<int>(OgnMessageType::UNKNOWN));
+    return true;
+}
+
+bool testTokenizer() {
+    // The vectorized blank search must agree with the scalar one
+    std::vector<std::string> lines = readReceivedData();
+    lines.push_back(std::string(100, ' '));
+    lines.push_back("a b  c   d    e     f      g       h        i         j          k           l            m             n");
+    for (const auto& line : lines) {
+        std::vector<uint32_t> blanks(line.size() + 1);
+        std::vector<uint32_t> scalarBlanks(line.size() + 1);
+        const std::size_t count = Tokenizer::findBlanks(line, blanks.data(), blanks.size());
+        const std::size_t scalarCount = Tokenizer::findBlanksScalar(line, scalarBlanks.data(), scalarBlanks.size());
+        ASSERT_EQ(count, scalarCount);
+        for (std::size_t i = 0; i < count; ++i) {
+            ASSERT_EQ(blanks[i], scalarBlanks[i]);
+        }
+
+        // Capacity is respected
+        if (count > 3) {
+            ASSERT_EQ(Tokenizer::findBlanks(line, blanks.data(), 3), 3u);
+        }
+    }
+
+    // Tokens, including more blanks than forEachToken handles in one go
+    std::string text = " id0ADDE626  -019fpm";
+    for (int i = 0; i < 50; ++i) {
+        text += " " + std::to_string(i) + "e";
+    }
+    std::vector<std::string_view> tokens;
+    Tokenizer::forEachToken(text, [&tokens](std::string_view token) { tokens.push_back(token); });
+    ASSERT_EQ(tokens.size(), 52u);
+    ASSERT_EQ(tokens[0], "id0ADDE626");
+    ASSERT_EQ(tokens[1], "-019fpm");
+    ASSERT_EQ(tokens[51], "49e");
+
+    // Classification
+    using Tokenizer::TokenKind;
+    ASSERT_TRUE(Tokenizer::classifyToken("id0ADDE626") == TokenKind::AircraftID);
+    ASSERT_TRUE(Tokenizer::classifyToken("-019fpm") == TokenKind::VerticalSpeed);
+    ASSERT_TRUE(Tokenizer::classifyToken("+0.0rot") == TokenKind::RotationRate);
+    ASSERT_TRUE(Tokenizer::classifyToken("5.5dB") == TokenKind::SignalStrength);
+    ASSERT_TRUE(Tokenizer::classifyToken("3e") == TokenKind::ErrorCount);
+    ASSERT_TRUE(Tokenizer::classifyToken("-4.3kHz") == TokenKind::FrequencyOffset);
+    ASSERT_TRUE(Tokenizer::classifyToken("FL350.00") == TokenKind::FlightLevel);
+    ASSERT_TRUE(Tokenizer::classifyToken("A3:AXY547M") == TokenKind::FlightNumber);
+    ASSERT_TRUE(Tokenizer::classifyToken("Sq2244") == TokenKind::Squawk);
+    ASSERT_TRUE(Tokenizer::classifyToken("gps:3x5") == TokenKind::GpsInfo);
+    ASSERT_TRUE(Tokenizer::classifyToken("gps3x5") == TokenKind::Other);
+    ASSERT_TRUE(Tokenizer::classifyToken("!W91!") == TokenKind::Enhancement);
+    ASSERT_TRUE(Tokenizer::classifyToken("t030") == TokenKind::Temperature);
+    ASSERT_TRUE(Tokenizer::classifyToken("h01") == TokenKind::Humidity);
+    ASSERT_TRUE(Tokenizer::classifyToken("b65526") == TokenKind::Pressure);
+    ASSERT_TRUE(Tokenizer::classifyToken("A3:Dale") == TokenKind::ErrorCount); // suffix takes precedence
+    ASSERT_TRUE(Tokenizer::classifyToken("i") == TokenKind::Other);
+    return true;
+}
+
+bool testTrafficRecord() {
+    OgnMessage message;
+    message.sentence = "ICA4D21C2>OGADSB,qAS,HLST:/001140h4741.90N/01104.20E^124/460/A=034868 !W91! id254D21C2 +128fpm FL350.00 A3:AXY547M Sq2244";
+    OgnParser::parseAprsisMessage(message);
+
+    OgnTrafficRecord record;
+    ASSERT_TRUE(OgnTrafficRecord::fromMessage(message, record));
+    ASSERT_EQ(record.address, 0x4D21C2u);
+    ASSERT_EQ(static_cast<int>(record.addressType), static_cast<int>(OgnAddressType::ICAO));
+    ASSERT_EQ(static_cast<int>(record.aircraftType), static_cast<int>(OgnAircraftType::Jet));
+    ASSERT_EQ(record.timestamp, 700u); // 00:11:40
+    ASSERT_LE(std::abs(record.latitudeDegrees() - message.latitude), 1e-6);
+    ASSERT_LE(std::abs(record.longitudeDegrees() - message.longitude), 1e-6);
+    ASSERT_LE(std::abs(record.altitudeMeters() - message.altitude), 0.1);
+    ASSERT_DOUBLE_EQ(record.courseDegrees(), 124.0);
+    ASSERT_DOUBLE_EQ(record.speedKnots(), 460.0);
+    ASSERT_LE(std::abs(record.verticalSpeed() - message.verticalSpeed), 0.01);
+    ASSERT_EQ(record.stealthMode(), false);
+    ASSERT_EQ(record.noTrackingFlag(), false);
+
+    // Messages other than traffic reports are rejected
+    OgnMessage weather;
+    weather.sentence = "FNT08075C>OGNFNT,qAS,Hoernle2:/222245h4803.92N/00800.93E_292/005g010t030h01b65526 5.2dB";
+    OgnParser::parseAprsisMessage(weather);
+    OgnTrafficRecord unchanged;
+    ASSERT_TRUE(!OgnTrafficRecord::fromMessage(weather, unchanged));
+    ASSERT_EQ(unchanged.address, 0u);
+
+    // Write, append and read back
+    const std::string fileName = "testTrafficRecord.ognrec";
+    std::remove(fileName.c_str());
+    {
+        OgnTrafficRecordWriter writer;
+        ASSERT_TRUE(writer.open(fileName));
+        ASSERT_TRUE(writer.write(record));
+    }
+    {
+        OgnTrafficRecordWriter writer;
+        ASSERT_TRUE(writer.open(fileName));
+        OgnTrafficRecord second = record;
+        second.address = 0xDDE626;
+        ASSERT_TRUE(writer.write(second));
+    }
+    OgnTrafficRecord readBack[4];
+    OgnTrafficRecordReader reader;
+    ASSERT_TRUE(reader.open(fileName));
+    ASSERT_EQ(reader.read(readBack, 4), 2u);
+    ASSERT_EQ(std::memcmp(&readBack[0], &record, sizeof(record)), 0);
+    ASSERT_EQ(readBack[1].address, 0xDDE626u);
+    ASSERT_EQ(readBack[1].latitude, record.latitude);
+    reader.close();
+    std::remove(fileName.c_str());
+
+    // Files with a foreign header are rejected
+    {
+        std::ofstream foreign(fileName);
+        foreign << "not a record file";
+    }
+    ASSERT_TRUE(!reader.open(fileName));
+    OgnTrafficRecordWriter writer;
+    ASSERT_TRUE(!writer.open(fileName));
+    std::remove(fileName.c_str());
+    return true;
+}
+
+bool testColumnBatch() {
+    // Columns hold the values of the parsed messages
+    OgnColumnBatch batch;
+    OgnMessage message;
+    std::vector<std::string> lines = readReceivedData();
+    // Messages refer to their sentence, which must not move
+    std::vector<OgnMessage> reports;
+    reports.reserve(lines.size());
+    for (const auto& line : lines) {
+        OgnMessage& report = reports.emplace_back();
+        report.sentence = line;
+        OgnParser::parseAprsisMessage(report);
+        bool const isReport = report.type == OgnMessageType::TRAFFIC_REPORT && !std::isnan(report.latitude);
+        ASSERT_EQ(batch.append(report), isReport);
+        if (!isReport) {
+            reports.pop_back();
+        }
+    }
+    ASSERT_EQ(batch.size(), reports.size());
+    ASSERT_TRUE(batch.size() > 100);
+    ASSERT_TRUE(batch.sourceIds().size() < batch.size());
+    bool hasFlightNumber = false;
+    for (std::size_t row = 0; row < batch.size(); ++row) {
+        const OgnMessage& report = reports[row];
+        ASSERT_EQ(batch.sourceIds()[batch.sourceId()[row]], report.sourceId);
+        if (report.flightnumber.empty()) {
+            ASSERT_EQ(batch.flightNumber()[row], OgnColumnBatch::NoString);
+        } else {
+            ASSERT_EQ(batch.flightNumbers()[batch.flightNumber()[row]], report.flightnumber);
+            hasFlightNumber = true;
+        }
+        ASSERT_DOUBLE_EQ(batch.latitude()[row], report.latitude);
+        ASSERT_DOUBLE_EQ(batch.longitude()[row], report.longitude);
+        ASSERT_EQ(std::isnan(batch.altitude()[row]), std::isnan(report.altitude));
+        ASSERT_DOUBLE_EQ(batch.speed()[row], report.speed);
+        ASSERT_DOUBLE_EQ(batch.course()[row], report.course);
+        ASSERT_DOUBLE_EQ(batch.climbRate()[row], report.verticalSpeed);
+        ASSERT_EQ(batch.aircraftType()[row], static_cast<uint8_t>(report.aircraftType));
+        ASSERT_EQ(batch.time()[row], OgnTrafficRecord::decodeTimestamp(report.timestamp));
+    }
+    ASSERT_TRUE(hasFlightNumber);
+
+    message.reset();
+    message.sentence = "FLRDDE626>APRS,qAS,EGHL:/074548h5111.32N/00102.04W'086/007/A=000607 id0ADDE626 -019fpm +0.0rot 5.5dB 3e -4.3kHz";
+    OgnParser::parseAprsisMessage(message);
+    OgnColumnBatch single;
+    ASSERT_TRUE(single.append(message));
+    ASSERT_EQ(single.address()[0], 0xDDE626u);
+    ASSERT_EQ(single.time()[0], 7u * 3600 + 45 * 60 + 48);
+    ASSERT_DOUBLE_EQ(single.climbRate()[0], -0.09652);
+
+    // Round trip through a file, two blocks
+    const std::string fileName = "testColumnBatch.ogncol";
+    std::remove(fileName.c_str());
+    {
+        OgnColumnFileWriter writer;
+        ASSERT_TRUE(writer.open(fileName));
+        ASSERT_TRUE(writer.write(batch));
+        ASSERT_TRUE(writer.write(OgnColumnBatch()));
+        writer.close();
+        ASSERT_TRUE(writer.open(fileName));
+        ASSERT_TRUE(writer.write(single));
+    }
+    {
+        OgnColumnFileReader reader;
+        ASSERT_TRUE(reader.open(fileName));
+        OgnColumnBatch read;
+        ASSERT_TRUE(reader.read(read));
+        ASSERT_TRUE(read.address() == batch.address());
+        ASSERT_TRUE(read.time() == batch.time());
+        ASSERT_TRUE(read.latitude() == batch.latitude());
+        ASSERT_TRUE(read.aircraftType() == batch.aircraftType());
+        ASSERT_TRUE(read.sourceId() == batch.sourceId());
+        ASSERT_TRUE(read.flightNumber() == batch.flightNumber());
+        ASSERT_TRUE(read.sourceIds() == batch.sourceIds());
+        ASSERT_TRUE(read.flightNumbers() == batch.flightNumbers());
+        for (std::size_t row = 0; row < batch.size(); ++row) {
+            ASSERT_EQ(std::isnan(read.altitude()[row]), std::isnan(batch.altitude()[row]));
+        }
+        // Read batches can be appended to, reusing the dictionary
+        std::size_t const sourceIdCount = read.sourceIds().size();
+        message.reset();
+        message.sentence = reports[0].sentence;
+        OgnParser::parseAprsisMessage(message);
+        ASSERT_TRUE(read.append(message));
+        ASSERT_EQ(read.size(), batch.size() + 1);
+        ASSERT_EQ(read.sourceIds().size(), sourceIdCount);
+        ASSERT_EQ(read.sourceIds()[read.sourceId().back()], reports[0].sourceId);
+
+        ASSERT_TRUE(reader.read(read));
+        ASSERT_EQ(read.size(), 1u);
+        ASSERT_EQ(read.sourceIds()[0], "FLRDDE626");
+        ASSERT_TRUE(!reader.read(read));
+        ASSERT_TRUE(read.empty());
+    }
+
+    // Every block, column and dictionary starts at a multiple of 8 bytes
+    {
+        std::ifstream file(fileName, std::ios::binary);
+        const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        const auto readUInt32 = [&data](std::size_t offset) {
+            uint32_t value = 0;
+            std::memcpy(&value, data.data() + offset, sizeof(value));
+            return value;
+        };
+        const auto padded = [](std::size_t size) { return (size + 7) / 8 * 8; };
+        const std::size_t columnSizes[] = {4, 4, 8, 8, 8, 8, 8, 8, 1, 4, 4};
+        // Empty batches are not written
+        const std::size_t expectedRows[] = {batch.size(), 1};
+        std::size_t offset = 8;
+        for (const std::size_t rows : expectedRows) {
+            ASSERT_EQ(offset % 8, 0u);
+            ASSERT_LE(offset + 8, data.size());
+            ASSERT_EQ(readUInt32(offset), rows);
+            ASSERT_EQ(readUInt32(offset + 4), 11u);
+            offset += 8;
+            // The address column is first
+            if (rows > 0) {
+                ASSERT_EQ(readUInt32(offset), rows == 1 ? single.address()[0] : batch.address()[0]);
+            }
+            for (const std::size_t size : columnSizes) {
+                ASSERT_EQ(offset % 8, 0u);
+                offset += padded(rows * size);
+            }
+            for (int dictionary = 0; dictionary < 2; ++dictionary) {
+                ASSERT_EQ(offset % 8, 0u);
+                ASSERT_LE(offset + 4, data.size());
+                const uint32_t count = readUInt32(offset);
+                std::size_t size = 4;
+                for (uint32_t entry = 0; entry < count; ++entry) {
+                    ASSERT_LE(offset + size + 1, data.size());
+                    size += 1 + static_cast<uint8_t>(data[offset + size]);
+                }
+                offset += padded(size);
+            }
+        }
+        ASSERT_EQ(offset, data.size());
+    }
+    std::remove(fileName.c_str());
+
+    // Files with a foreign header are rejected
+    {
+        std::ofstream foreign(fileName);
+        foreign << "not a column file";
+    }
+    OgnColumnFileReader reader;
+    ASSERT_TRUE(!reader.open(fileName));
+    OgnColumnFileWriter writer;
+    ASSERT_TRUE(!writer.open(fileName));
+    std::remove(fileName.c_str());
+
+    batch.clear();
+    ASSERT_TRUE(batch.empty());
+    ASSERT_TRUE(batch.sourceIds().empty());
+    return true;
+}
+
+bool testTrafficTable() {
+    // Fill from sample data
+    OgnTrafficTable table(60.0);
+    std::set<uint32_t> keys;
+    double now = 1000.0;
+    for (const auto& line : readReceivedData()) {
+        OgnMessage message;
+        message.sentence = line;
+        OgnParser::parseAprsisMessage(message);
+        const bool accepted = table.update(message, now);
+        ASSERT_EQ(accepted, message.type == OgnMessageType::TRAFFIC_REPORT && !message.address.empty());
+        if (accepted) {
+            keys.insert(OgnTrafficTable::makeKey(message.addressType, static_cast<uint32_t>(std::stoul(std::string(message.address), nullptr, 16))));
+        }
+        now += 0.1;
+    }
+    ASSERT_EQ(table.size(), keys.size());
+    ASSERT_GE(table.size(), 10u);
+
+    // Lookup
+    OgnMessage message;
+    message.sentence = "ICA4D21C2>OGADSB,qAS,HLST:/001140h4741.90N/01104.20E^124/460/A=034868 !W91! id254D21C2 +128fpm FL350.00 A3:AXY547M Sq2244";
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_TRUE(table.update(message, now));
+    const std::size_t index = table.find(OgnTrafficTable::makeKey(OgnAddressType::ICAO, 0x4D21C2));
+    ASSERT_NE(index, OgnTrafficTable::npos);
+    const OgnTrafficTarget target = table.target(index);
+    ASSERT_EQ(target.address(), 0x4D21C2u);
+    ASSERT_TRUE(target.addressType() == OgnAddressType::ICAO);
+    ASSERT_DOUBLE_EQ(target.latitude, message.latitude);
+    ASSERT_DOUBLE_EQ(target.longitude, message.longitude);
+    ASSERT_DOUBLE_EQ(target.course, 124.0);
+    ASSERT_DOUBLE_EQ(target.lastSeen, now);
+    ASSERT_TRUE(target.aircraftType == OgnAircraftType::Jet);
+    ASSERT_EQ(table.find(OgnTrafficTable::makeKey(OgnAddressType::FLARM, 0x4D21C2)), OgnTrafficTable::npos);
+
+    // Only the updated aircraft survives the timeout
+    table.expire(now + 30.0);
+    ASSERT_GE(table.size(), 2u);
+    ASSERT_TRUE(table.update(message, now + 60.0));
+    table.expire(now + 62.0);
+    ASSERT_EQ(table.size(), 1u);
+    ASSERT_EQ(table.keys()[0], OgnTrafficTable::makeKey(OgnAddressType::ICAO, 0x4D21C2));
+    table.expire(now + 200.0);
+    ASSERT_TRUE(table.empty());
+
+    // Random operations, compared against a simple reference
+    OgnTrafficTable randomTable(10.0);
+    std::map<uint32_t, double> reference; // key -> last seen
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<uint32_t> keyDistribution(0, 3000);
+    std::uniform_int_distribution<int> operationDistribution(0, 99);
+    now = -5.5;
+    for (int i = 0; i < 50000; ++i) {
+        const uint32_t key = OgnTrafficTable::makeKey(OgnAddressType::FLARM, keyDistribution(generator) * 4099);
+        const int operation = operationDistribution(generator);
+        if (operation < 80) {
+            OgnTrafficTarget update;
+            update.key = key;
+            update.latitude = static_cast<double>(key % 90);
+            update.longitude = now;
+            randomTable.update(update, now);
+            reference[key] = now;
+        } else if (operation < 90) {
+            ASSERT_EQ(randomTable.remove(key), reference.erase(key) == 1);
+        } else if (operation < 99) {
+            now += 0.13;
+        } else {
+            now += 2.0;
+            randomTable.expire(now);
+            const double limit = std::floor(now) - 10.0 - 1.0;
+            for (auto it = reference.begin(); it != reference.end();) {
+                it = (std::floor(it->second) <= limit) ? reference.erase(it) : std::next(it);
+            }
+        }
+
+        if (i % 1000 == 0) {
+            ASSERT_EQ(randomTable.size(), reference.size());
+            for (const auto& [referenceKey, lastSeen] : reference) {
+                const std::size_t found = randomTable.find(referenceKey);
+                ASSERT_NE(found, OgnTrafficTable::npos);
+                ASSERT_EQ(randomTable.keys()[found], referenceKey);
+                ASSERT_DOUBLE_EQ(randomTable.lastSeen()[found], lastSeen);
+                ASSERT_DOUBLE_EQ(randomTable.longitudes()[found], lastSeen);
+            }
+        }
+    }
+
+    randomTable.clear();
+    ASSERT_TRUE(randomTable.empty());
+    ASSERT_EQ(randomTable.find(OgnTrafficTable::makeKey(OgnAddressType::FLARM, 4099)), OgnTrafficTable::npos);
+    return true;
+}
+
+bool testTrafficTable_spatialQueries() {
+    // Random traffic, including around the antimeridian and the poles
+    OgnTrafficTable table(60.0);
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> latitudeDistribution(-90.0, 90.0);
+    std::uniform_real_distribution<double> longitudeDistribution(-180.0, 180.0);
+    std::uniform_real_distribution<double> offsetDistribution(-3.0, 3.0);
+    for (uint32_t i = 0; i < 6000; ++i) {
+        OgnTrafficTarget target;
+        target.key = OgnTrafficTable::makeKey(OgnAddressType::FLARM, i);
+        if (i % 3 == 0) {
+            // Dense cluster in the Alps
+            target.latitude = 46.5 + offsetDistribution(generator);
+            target.longitude = 10.0 + offsetDistribution(generator);
+        } else if (i % 3 == 1) {
+            target.latitude = std::clamp(latitudeDistribution(generator), -89.9, 89.9);
+            target.longitude = (i % 2 == 0) ? 179.9 : -179.9;
+        } else {
+            target.latitude = latitudeDistribution(generator);
+            target.longitude = longitudeDistribution(generator);
+        }
+        table.update(target, 0.0);
+    }
+    // Move some aircraft and remove others, to exercise index maintenance
+    for (uint32_t i = 0; i < 6000; i += 7) {
+        OgnTrafficTarget target = table.target(table.find(OgnTrafficTable::makeKey(OgnAddressType::FLARM, i)));
+        target.latitude = -target.latitude;
+        table.update(target, 1.0);
+    }
+    for (uint32_t i = 0; i < 6000; i += 11) {
+        table.remove(OgnTrafficTable::makeKey(OgnAddressType::FLARM, i));
+    }
+
+    const auto distanceKm = [](double lat1, double lon1, double lat2, double lon2) {
+        const double toRadians = 3.14159265358979323846 / 180.0;
+        const double sinLatitude = std::sin((lat2 - lat1) * toRadians / 2.0);
+        const double sinLongitude = std::sin((lon2 - lon1) * toRadians / 2.0);
+        const double h = sinLatitude * sinLatitude + std::cos(lat1 * toRadians) * std::cos(lat2 * toRadians) * sinLongitude * sinLongitude;
+        return 2.0 * 6371.0088 * std::asin(std::min(1.0, std::sqrt(h)));
+    };
+
+    struct Circle { double latitude; double longitude; double radiusKm; };
+    const Circle circles[] = {
+        {46.5, 10.0, 50.0}, {46.5, 10.0, 500.0}, {0.0, 179.5, 300.0}, {10.0, -179.8, 80.0},
+        {89.5, 0.0, 200.0}, {-89.0, 45.0, 400.0}, {30.0, 30.0, 0.0}, {0.0, 0.0, 30000.0},
+    };
+    std::vector<std::size_t> indices;
+    for (const auto& circle : circles) {
+        table.findInRadius(circle.latitude, circle.longitude, circle.radiusKm, indices);
+        std::set<std::size_t> found(indices.begin(), indices.end());
+        ASSERT_EQ(found.size(), indices.size());
+        for (std::size_t index = 0; index < table.size(); ++index) {
+            const double distance = distanceKm(circle.latitude, circle.longitude, table.latitudes()[index], table.longitudes()[index]);
+            // Ignore aircraft right at the boundary
+            if (std::abs(distance - circle.radiusKm) < 1e-6) {
+                continue;
+            }
+            ASSERT_EQ(found.count(index) == 1, distance < circle.radiusKm);
+        }
+    }
+
+    struct Box { double south; double west; double north; double east; };
+    const Box boxes[] = {
+        {45.0, 8.0, 48.0, 12.0}, {-10.0, 170.0, 60.0, -170.0}, {-90.0, -180.0, 90.0, 180.0}, {80.0, 100.0, 90.0, 179.95}, {50.0, 0.0, 40.0, 10.0},
+    };
+    for (const auto& box : boxes) {
+        table.findInBox(box.south, box.west, box.north, box.east, indices);
+        std::set<std::size_t> found(indices.begin(), indices.end());
+        ASSERT_EQ(found.size(), indices.size());
+        for (std::size_t index = 0; index < table.size(); ++index) {
+            const double latitude = table.latitudes()[index];
+            const double longitude = table.longitudes()[index];
+            const bool inLongitude = (box.west <= box.east) ? (longitude >= box.west && longitude <= box.east)
+                                                           : (longitude >= box.west || longitude <= box.east);
+            ASSERT_EQ(found.count(index) == 1, latitude >= box.south && latitude <= box.north && inLongitude);
+        }
+    }
+
+    // Expired aircraft are no longer found
+    table.expire(100.0);
+    ASSERT_TRUE(table.empty());
+    table.findInBox(-90.0, -180.0, 90.0, 180.0, indices);
+    ASSERT_TRUE(indices.empty());
+
+    // Tiny cells would make the grid huge
+    ASSERT_DOUBLE_EQ(OgnSpatialIndex(0.001).cellSize(), OgnSpatialIndex::MinimumCellSize);
+    ASSERT_DOUBLE_EQ(OgnSpatialIndex(std::numeric_limits<double>::quiet_NaN()).cellSize(), 0.5);
+    OgnTrafficTable fineTable(60.0, 0.001);
+    OgnTrafficTarget target;
+    target.key = OgnTrafficTable::makeKey(OgnAddressType::FLARM, 1);
+    target.latitude = 46.5;
+    target.longitude = 10.0;
+    fineTable.update(target, 0.0);
+    fineTable.findInRadius(46.5, 10.0, 1.0, indices);
+    ASSERT_EQ(indices.size(), 1u);
+    return true;
+}
+
+bool testExtrapolator() {
+    constexpr double pi = 3.14159265358979323846;
+    constexpr double metersToDegrees = 180.0 / (pi * 6371008.8);
+    constexpr double metersPerSecond = 100.0 * 1852.0 / 3600.0; // 100 knots
+
+    OgnTrafficTable table(60.0);
+    OgnTrafficTarget target;
+    target.speed = 100.0;
+
+    // Straight north, climbing
+    target.key = 1;
+    target.latitude = 50.0;
+    target.longitude = 8.0;
+    target.altitude = 1000.0;
+    target.verticalSpeed = 2.0;
+    table.update(target, 0.0);
+    // Straight east, at the antimeridian, altitude unknown
+    target.key = 2;
+    target.latitude = 60.0;
+    target.longitude = 179.999;
+    target.altitude = std::numeric_limits<double>::quiet_NaN();
+    target.course = 90.0;
+    target.verticalSpeed = 0.0;
+    table.update(target, 0.0);
+    // Right turn, one "rot"
+    target.key = 3;
+    target.latitude = 0.0;
+    target.longitude = 0.0;
+    target.course = 359.0;
+    target.turnRate = 1.5;
+    table.update(target, 0.0);
+
+    OgnExtrapolator extrapolator(20.0);
+    extrapolator.predict(table, 10.0);
+    ASSERT_EQ(extrapolator.size(), 3u);
+    const double distance = metersPerSecond * 10.0;
+    std::size_t index = table.find(1);
+    ASSERT_DOUBLE_EQ(extrapolator.latitudes()[index], 50.0 + distance * metersToDegrees);
+    ASSERT_DOUBLE_EQ(extrapolator.longitudes()[index], 8.0);
+    ASSERT_DOUBLE_EQ(extrapolator.altitudes()[index], 1020.0);
+    ASSERT_DOUBLE_EQ(extrapolator.courses()[index], 0.0);
+    index = table.find(2);
+    ASSERT_DOUBLE_EQ(extrapolator.latitudes()[index], 60.0);
+    ASSERT_DOUBLE_EQ(extrapolator.longitudes()[index], 179.999 + 2.0 * distance * metersToDegrees - 360.0);
+    ASSERT_TRUE(std::isnan(extrapolator.altitudes()[index]));
+    index = table.find(3);
+    const double radius = metersPerSecond / (1.5 * pi / 180.0);
+    const double course = 359.0 * pi / 180.0;
+    const double angle = 15.0 * pi / 180.0;
+    ASSERT_DOUBLE_EQ(extrapolator.latitudes()[index], radius * (std::sin(course + angle) - std::sin(course)) * metersToDegrees);
+    ASSERT_DOUBLE_EQ(extrapolator.longitudes()[index], radius * (std::cos(course) - std::cos(course + angle)) * metersToDegrees);
+    ASSERT_DOUBLE_EQ(extrapolator.courses()[index], 14.0);
+
+    // Beyond the horizon, aircraft stay where they are at the horizon
+    extrapolator.predict(table, 20.0);
+    std::vector<double> latitudes(extrapolator.latitudes(), extrapolator.latitudes() + extrapolator.size());
+    extrapolator.predict(table, 100.0);
+    for (std::size_t i = 0; i < extrapolator.size(); ++i) {
+        ASSERT_DOUBLE_EQ(extrapolator.latitudes()[i], latitudes[i]);
+    }
+    // Aircraft reported after the requested time stay at their last position
+    extrapolator.predict(table, -5.0);
+    for (std::size_t i = 0; i < extrapolator.size(); ++i) {
+        ASSERT_DOUBLE_EQ(extrapolator.latitudes()[i], table.latitudes()[i]);
+        ASSERT_DOUBLE_EQ(extrapolator.longitudes()[i], table.longitudes()[i]);
+    }
+
+    // Random aircraft, compared with the standard library
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    table.clear();
+    for (uint32_t key = 0; key < 1000; ++key) {
+        target.key = key;
+        target.latitude = -80.0 + 160.0 * uniform(generator);
+        target.longitude = -180.0 + 360.0 * uniform(generator);
+        target.altitude = 10000.0 * uniform(generator);
+        target.course = 360.0 * uniform(generator);
+        target.speed = 500.0 * uniform(generator);
+        target.verticalSpeed = -5.0 + 10.0 * uniform(generator);
+        target.turnRate = (key % 4 == 0) ? 0.0 : -6.0 + 12.0 * uniform(generator);
+        table.update(target, 30.0 * uniform(generator));
+    }
+    extrapolator.predict(table, 35.0);
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        const double dt = std::min(std::max(35.0 - table.lastSeen()[i], 0.0), 20.0);
+        const double v = table.speeds()[i] * 1852.0 / 3600.0;
+        const double c = table.courses()[i] * pi / 180.0;
+        const double omega = table.turnRates()[i] * pi / 180.0;
+        double north = v * dt * std::cos(c);
+        double east = v * dt * std::sin(c);
+        if (omega != 0.0) {
+            north = v / omega * (std::sin(c + omega * dt) - std::sin(c));
+            east = v / omega * (std::cos(c) - std::cos(c + omega * dt));
+        }
+        const double latitude = table.latitudes()[i] + north * metersToDegrees;
+        double longitude = table.longitudes()[i] + east * metersToDegrees / std::cos(table.latitudes()[i] * pi / 180.0);
+        longitude = std::remainder(longitude, 360.0);
+        ASSERT_DOUBLE_EQ(extrapolator.latitudes()[i], latitude);
+        ASSERT_TRUE(std::abs(std::remainder(extrapolator.longitudes()[i] - longitude, 360.0)) < 1e-7);
+        ASSERT_DOUBLE_EQ(extrapolator.altitudes()[i], table.altitudes()[i] + table.verticalSpeeds()[i] * dt);
+        const double courseDifference = std::remainder(extrapolator.courses()[i] - (table.courses()[i] + table.turnRates()[i] * dt), 360.0);
+        ASSERT_TRUE(std::abs(courseDifference) < 1e-9);
+        ASSERT_GE(extrapolator.courses()[i], 0.0);
+        ASSERT_TRUE(extrapolator.courses()[i] < 360.0);
+        ASSERT_TRUE(extrapolator.longitudes()[i] >= -180.0 && extrapolator.longitudes()[i] < 180.0);
+    }
+
+    // Turn rate decoded by the parser
+    OgnMessage message;
+    message.sentence = "FLRDDE626>APRS,qAS,EGHL:/074557h5111.32N/00102.01W'086/006/A=000607 id0ADDE626 +020fpm -0.7rot 5.8dB 4e -4.3kHz";
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_DOUBLE_EQ(message.turnRate, -1.05);
+    ASSERT_TRUE(table.update(message, 40.0));
+    ASSERT_DOUBLE_EQ(table.target(table.find(OgnTrafficTable::makeKey(OgnAddressType::FLARM, 0xDDE626))).turnRate, -1.05);
+    return true;
+}
+
+bool testLatencyHistogram() {
+    OgnLatencyHistogram histogram;
+    ASSERT_EQ(histogram.count(), 0u);
+    ASSERT_EQ(histogram.valueAtPercentile(50.0), 0u);
+    ASSERT_EQ(histogram.minimum(), 0u);
+
+    // Small values are exact
+    for (uint64_t value = 1; value <= 100; ++value) {
+        histogram.record(value);
+    }
+    ASSERT_EQ(histogram.count(), 100u);
+    ASSERT_EQ(histogram.minimum(), 1u);
+    ASSERT_EQ(histogram.maximum(), 100u);
+    ASSERT_DOUBLE_EQ(histogram.mean(), 50.5);
+    ASSERT_EQ(histogram.valueAtPercentile(0.0), 1u);
+    ASSERT_EQ(histogram.valueAtPercentile(50.0), 50u);
+    ASSERT_EQ(histogram.valueAtPercentile(99.0), 99u);
+    ASSERT_EQ(histogram.valueAtPercentile(100.0), 100u);
+
+    // Large values within the relative precision, weighted counts
+    histogram.reset();
+    histogram.record(1000, 90);
+    histogram.record(1000000, 9);
+    histogram.record(123456789);
+    ASSERT_EQ(histogram.count(), 100u);
+    const auto withinPrecision = [](uint64_t reported, uint64_t value) {
+        return reported >= value && static_cast<double>(reported - value) <= value / 64.0;
+    };
+    ASSERT_TRUE(withinPrecision(histogram.valueAtPercentile(50.0), 1000));
+    ASSERT_TRUE(withinPrecision(histogram.valueAtPercentile(90.0), 1000));
+    ASSERT_TRUE(withinPrecision(histogram.valueAtPercentile(91.0), 1000000));
+    ASSERT_EQ(histogram.valueAtPercentile(100.0), 123456789u);
+
+    // Every value maps into a bucket whose highest value is close above it
+    OgnLatencyHistogram single;
+    for (uint64_t value = 1; value < OgnLatencyHistogram::HighestValue; value = value * 3 + 1) {
+        single.reset();
+        single.record(value);
+        single.record(OgnLatencyHistogram::HighestValue);
+        ASSERT_TRUE(withinPrecision(single.valueAtPercentile(50.0), value));
+    }
+
+    // Clamping and merging
+    OgnLatencyHistogram other;
+    other.record(uint64_t{1} << 50);
+    other.record(7, 0);
+    ASSERT_EQ(other.count(), 1u);
+    ASSERT_EQ(other.maximum(), OgnLatencyHistogram::HighestValue);
+    histogram.merge(other);
+    ASSERT_EQ(histogram.count(), 101u);
+    ASSERT_EQ(histogram.minimum(), 1000u);
+    ASSERT_EQ(histogram.valueAtPercentile(100.0), OgnLatencyHistogram::HighestValue);
+    return true;
+}
+
+bool testProximityMonitor() {
+    constexpr double metersToDegrees = 180.0 / (3.14159265358979323846 * 6371008.8);
+    constexpr double metersPerSecond = 100.0 * 1852.0 / 3600.0; // 100 knots
+
+    OgnOwnship ownship;
+    ownship.latitude = 50.0;
+    ownship.longitude = 8.0;
+    ownship.altitude = 1000.0;
+    ownship.course = 0.0;
+    ownship.speed = 100.0;
+
+    OgnTrafficTable table(60.0);
+    OgnTrafficTarget target;
+    // Head-on, 1.5 km ahead, 50 m above
+    target.key = 1;
+    target.latitude = 50.0 + 1500.0 * metersToDegrees;
+    target.longitude = 8.0;
+    target.altitude = 1050.0;
+    target.course = 180.0;
+    target.speed = 100.0;
+    table.update(target, 0.0);
+    // Same, but far above
+    target.key = 2;
+    target.altitude = 2000.0;
+    table.update(target, 0.0);
+    // 1 km east, flying away, altitude unknown
+    target.key = 3;
+    target.latitude = 50.0;
+    target.longitude = 8.0 + 1000.0 * metersToDegrees / std::cos(50.0 * 3.14159265358979323846 / 180.0);
+    target.altitude = std::numeric_limits<double>::quiet_NaN();
+    target.course = 90.0;
+    target.speed = 200.0;
+    table.update(target, 0.0);
+    // Far away
+    target.key = 4;
+    target.latitude = 51.0;
+    target.altitude = 1000.0;
+    table.update(target, 0.0);
+
+    OgnProximityMonitor monitor(2000.0, 300.0, 20.0);
+    monitor.setOwnship(table, ownship, 0.0);
+    ASSERT_EQ(monitor.alerts().size(), 2u);
+    for (const auto& alert : monitor.alerts()) {
+        if (alert.key == 1) {
+            ASSERT_TRUE(alert.level == OgnAlarmLevel::Low);
+            ASSERT_DOUBLE_EQ(alert.timeToClosestApproach, 1500.0 / (2.0 * metersPerSecond));
+            ASSERT_TRUE(alert.closestDistance < 0.01);
+            ASSERT_TRUE(std::abs(alert.distance - 1500.0) < 0.01);
+            ASSERT_TRUE(std::abs(alert.bearing) < 1e-6);
+            ASSERT_DOUBLE_EQ(alert.verticalSeparation, 50.0);
+        } else {
+            ASSERT_EQ(alert.key, 3u);
+            ASSERT_TRUE(alert.level == OgnAlarmLevel::Urgent);
+            ASSERT_DOUBLE_EQ(alert.timeToClosestApproach, 0.0);
+            ASSERT_TRUE(std::abs(alert.distance - 1000.0) < 0.1);
+            ASSERT_TRUE(std::abs(alert.bearing - 90.0) < 0.01);
+            ASSERT_TRUE(std::isnan(alert.verticalSeparation));
+        }
+    }
+    ASSERT_EQ(monitor.mostUrgent()->key, 3u);
+
+    // Incremental updates: aircraft 2 descends into the volume, aircraft 1 disappears
+    target = table.target(table.find(2));
+    target.altitude = 1100.0;
+    table.update(target, 1.0);
+    ASSERT_TRUE(monitor.update(table, 2, 1.0));
+    ASSERT_EQ(monitor.alerts().size(), 3u);
+    ASSERT_TRUE(table.remove(1));
+    ASSERT_TRUE(!monitor.update(table, 1, 1.0));
+    ASSERT_EQ(monitor.alerts().size(), 2u);
+
+    // Both aircraft have moved on: aircraft 3 is out of range after 10 seconds
+    ASSERT_TRUE(!monitor.update(table, 3, 10.0));
+    ASSERT_EQ(monitor.alerts().size(), 1u);
+    ASSERT_EQ(monitor.alerts()[0].key, 2u);
+    // ... while aircraft 2 is closer: it flew for 9 seconds, the own aircraft for 10
+    ASSERT_TRUE(monitor.update(table, 2, 10.0));
+    ASSERT_TRUE(std::abs(monitor.alerts()[0].distance - (1500.0 - 19.0 * metersPerSecond)) < 0.1);
+    ASSERT_TRUE(monitor.alerts()[0].level == OgnAlarmLevel::Urgent);
+
+    // Parsed traffic report, 900 m ahead of the own aircraft and flying alongside
+    OgnMessage message;
+    message.sentence = "FLRDDE626>APRS,qAS,EGHL:/000010h5000.76N/00800.00E'000/100/A=003280 id0ADDE626 +000fpm +0.0rot";
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_TRUE(table.update(message, 10.0));
+    ASSERT_TRUE(monitor.update(table, message, 10.0));
+    ASSERT_EQ(monitor.alerts().size(), 2u);
+
+    // Expired aircraft lose their alerts, with the next update or expire()
+    table.expire(65.0);
+    ASSERT_EQ(table.size(), 1u);
+    ASSERT_EQ(monitor.alerts().size(), 2u);
+    ASSERT_TRUE(monitor.update(table, message, 65.0));
+    ASSERT_EQ(monitor.alerts().size(), 1u);
+    ASSERT_TRUE(monitor.alerts()[0].key != 2u);
+    table.expire(100.0);
+    ASSERT_TRUE(table.empty());
+    monitor.expire(table);
+    ASSERT_TRUE(monitor.alerts().empty());
+    ASSERT_TRUE(monitor.mostUrgent() == nullptr);
+
+    // Invalid own position
+    monitor.setOwnship(table, OgnOwnship(), 10.0);
+    ASSERT_TRUE(monitor.alerts().empty());
+    ASSERT_TRUE(monitor.mostUrgent() == nullptr);
+    ASSERT_TRUE(!monitor.update(table, 2, 10.0));
+    return true;
+}
+
+bool testDuplicateFilter() {
+    // The same packet, relayed by two receivers
+    const char* const sentences[] = {
+        "FLRDDE626>APRS,qAS,EGHL:/074548h5111.32N/00102.04W'086/007/A=000607 id0ADDE626 -019fpm +0.0rot 5.5dB 3e -4.3kHz",
+        "FLRDDE626>APRS,qAS,EGHN:/074548h5111.32N/00102.04W'086/007/A=000607 id0ADDE626 -019fpm +0.0rot 8.5dB 0e -4.1kHz",
+        "FLRDDE626>APRS,qAS,EGHL:/074549h5111.32N/00102.04W'086/007/A=000607 id0ADDE626 -019fpm +0.0rot 5.5dB 3e -4.3kHz",
+        "FLRDDE626>APRS,qAS,EGHL:/074549h5111.33N/00102.04W'086/007/A=000607 id0ADDE626 -019fpm +0.0rot 5.5dB 3e -4.3kHz",
+        "FLRDDE627>APRS,qAS,EGHL:/074549h5111.33N/00102.04W'086/007/A=000607 id0ADDE627 -019fpm +0.0rot 5.5dB 3e -4.3kHz",
+        "LFNW>APRS,TCPIP*,qAC,GLIDERN5:>183804h v0.2.6.ARM CPU:0.7 RAM:505.3/889.7MB",
+        "LFNW>APRS,TCPIP*,qAC,GLIDERN5:>183804h v0.2.6.ARM CPU:0.7 RAM:505.3/889.7MB",
+    };
+    const bool expected[] = {false, true, false, false, false, false, false};
+
+    OgnDuplicateFilter filter(16);
+    for (std::size_t i = 0; i < std::size(sentences); ++i) {
+        OgnMessage message;
+        message.sentence = sentences[i];
+        OgnParser::parseAprsisMessage(message);
+        ASSERT_EQ(filter.isDuplicate(message), expected[i]);
+    }
+    ASSERT_EQ(filter.duplicateCount(), 1u);
+
+    // Sample data: every sentence repeated
+    OgnDuplicateFilter sampleFilter;
+    std::size_t trafficReports = 0;
+    for (const auto& line : readReceivedData()) {
+        OgnMessage message;
+        message.sentence = line;
+        OgnParser::parseAprsisMessage(message);
+        if (message.type == OgnMessageType::TRAFFIC_REPORT) {
+            trafficReports++;
+        }
+        sampleFilter.isDuplicate(message);
+        ASSERT_EQ(sampleFilter.isDuplicate(message), message.type == OgnMessageType::TRAFFIC_REPORT);
+    }
+    ASSERT_GE(sampleFilter.duplicateCount(), trafficReports);
+
+    // Old fingerprints are forgotten once the capacity is exhausted
+    OgnMessage first;
+    first.sentence = sentences[0];
+    OgnParser::parseAprsisMessage(first);
+    filter.clear();
+    ASSERT_EQ(filter.duplicateCount(), 0u);
+    ASSERT_TRUE(!filter.isDuplicate(first));
+    for (int i = 0; i < 1000; ++i) {
+        OgnMessageData other = first;
+        other.latitude += i * 0.001 + 0.001;
+        filter.isDuplicate(other);
+    }
+    ASSERT_TRUE(!filter.isDuplicate(first));
+    return true;
+}
+
+bool testWeatherCache() {
+    // Latest reading; the same report via another receiver is ignored
+    OgnWeatherCache cache({60.0}, 6);
+    OgnMessage message;
+    message.sentence = "FNTBDC3B1>OGNFNT,qAS,Hochries:/222247h4744.90N/01215.02E_302/018g018t032h99b10214 2.9dB";
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_TRUE(cache.update(message, 100.0));
+    message.reset();
+    message.sentence = "FNTBDC3B1>OGNFNT,qAS,Prutting1:/222247h4744.90N/01215.02E_302/018g018t032h99b10214 0.9dB";
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_TRUE(!cache.update(message, 101.0));
+    ASSERT_EQ(cache.size(), 1u);
+    std::size_t const index = cache.find("FNTBDC3B1");
+    ASSERT_EQ(index, 0u);
+    ASSERT_EQ(cache.station(index), "FNTBDC3B1");
+    ASSERT_EQ(cache.find("FNT08075C"), OgnWeatherCache::npos);
+    const OgnWeatherReading& latest = cache.latest(index);
+    ASSERT_DOUBLE_EQ(latest.time, 100.0);
+    ASSERT_DOUBLE_EQ(latest.windDirection, 302.0);
+    ASSERT_DOUBLE_EQ(latest.windSpeed, 18.0);
+    ASSERT_DOUBLE_EQ(latest.windGustSpeed, 18.0);
+    ASSERT_DOUBLE_EQ(latest.temperature, 0.0); // 32 F
+    ASSERT_DOUBLE_EQ(latest.humidity, 99.0);
+    ASSERT_DOUBLE_EQ(latest.pressure, 1021.4);
+
+    // Below zero; unreported quantities are not counted as zero
+    message.reset();
+    message.sentence = "FNTBDC3B1>OGNFNT,qAS,Hochries:/222347h4744.90N/01215.02E_302/018t-04 2.9dB";
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_TRUE(cache.update(message, 101.0));
+    ASSERT_DOUBLE_EQ(latest.temperature, -20.0); // -4 F
+    ASSERT_TRUE(std::isnan(latest.windGustSpeed));
+    ASSERT_TRUE(std::isnan(latest.humidity));
+    ASSERT_TRUE(std::isnan(latest.pressure));
+    const OgnWeatherStatistics temperatures = cache.statistics(index, OgnWeatherQuantity::Temperature, 0, 101.0);
+    ASSERT_EQ(temperatures.count, 2u);
+    ASSERT_DOUBLE_EQ(temperatures.mean, -10.0);
+    ASSERT_DOUBLE_EQ(temperatures.minimum, -20.0);
+    ASSERT_DOUBLE_EQ(temperatures.maximum, 0.0);
+    const OgnWeatherStatistics humidities = cache.statistics(index, OgnWeatherQuantity::Humidity, 0, 101.0);
+    ASSERT_EQ(humidities.count, 1u);
+    ASSERT_DOUBLE_EQ(humidities.minimum, 99.0);
+    ASSERT_EQ(cache.statistics(index, OgnWeatherQuantity::WindGustSpeed, 0, 101.0).count, 1u);
+    ASSERT_EQ(cache.statistics(index, OgnWeatherQuantity::WindSpeed, 0, 101.0).count, 2u);
+
+    // Other messages are ignored
+    message.reset();
+    message.sentence = "FLRDDE626>APRS,qAS,EGHL:/074548h5111.32N/00102.04W'086/007/A=000607 id0ADDE626 -019fpm +0.0rot 5.5dB 3e -4.3kHz";
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_TRUE(!cache.update(message, 102.0));
+
+    // Mean wind direction is the direction of the mean wind vector, across north
+    OgnMessageData report;
+    report.type = OgnMessageType::WEATHER;
+    report.sourceId = "FNTTEST01";
+    report.wind_speed = 10;
+    report.wind_direction = 350;
+    report.weatherFields = OgnMessageData::HasWindDirection | OgnMessageData::HasWindSpeed;
+    report.timestamp = "000001";
+    cache.update(report, 110.0);
+    report.wind_direction = 10;
+    report.timestamp = "000002";
+    cache.update(report, 111.0);
+    std::size_t const test = cache.find("FNTTEST01");
+    double const direction = cache.meanWindDirection(test, 0, 111.0);
+    ASSERT_TRUE(direction < 1e-6 || direction > 360.0 - 1e-6);
+    ASSERT_TRUE(std::isnan(cache.statistics(test, OgnWeatherQuantity::Pressure, 0, 111.0).mean));
+    ASSERT_EQ(cache.statistics(test, OgnWeatherQuantity::WindSpeed, 0, 111.0).count, 2u);
+    ASSERT_EQ(cache.statistics(test, OgnWeatherQuantity::WindSpeed, 0, 200.0).count, 0u);
+    ASSERT_TRUE(std::isnan(cache.meanWindDirection(test, 0, 200.0)));
+
+    // Expiry moves the last station into the gap
+    cache.expire(170.0, 60.0);
+    ASSERT_EQ(cache.size(), 1u);
+    ASSERT_EQ(cache.find("FNTBDC3B1"), OgnWeatherCache::npos);
+    ASSERT_EQ(cache.find("FNTTEST01"), 0u);
+    ASSERT_EQ(cache.statistics(0, OgnWeatherQuantity::WindSpeed, 0, 111.0).count, 2u);
+    cache.clear();
+    ASSERT_TRUE(cache.empty());
+
+    // Rolling statistics agree with a brute-force computation over the
+    // buckets that the window covers
+    const double windows[] = {60.0, 600.0};
+    const std::size_t buckets = 12;
+    OgnWeatherCache rolling({windows[0], windows[1]}, buckets);
+    std::vector<std::pair<double, double>> samples; // time, temperature
+    std::mt19937 random(7);
+    std::uniform_real_distribution<double> step(0.0, 7.0);
+    std::uniform_int_distribution<uint32_t> value(0, 40);
+    double now = -1000.0;
+    std::string timestamps[2] = {"a", "b"}; // alternate, so that no report repeats the previous one
+    for (int i = 0; i < 3000; ++i) {
+        now += step(random);
+        report.sourceId = "FNTTEST02";
+        report.timestamp = timestamps[i % 2];
+        report.temperature = value(random);
+        report.weatherFields = OgnMessageData::HasTemperature;
+        ASSERT_TRUE(rolling.update(report, now));
+        samples.emplace_back(now, (report.temperature - 32.0) * 5.0 / 9.0);
+
+        if (i % 37 != 0) {
+            continue;
+        }
+        double const queryTime = now + step(random);
+        for (std::size_t window = 0; window < 2; ++window) {
+            double const width = windows[window] / buckets;
+            auto const oldest = static_cast<int64_t>(std::floor(queryTime / width)) - static_cast<int64_t>(buckets) + 1;
+            std::size_t count = 0;
+            double sum = 0.0;
+            double minimum = 1e9;
+            double maximum = -1e9;
+            for (const auto& sample : samples) {
+                if (static_cast<int64_t>(std::floor(sample.first / width)) >= oldest) {
+                    count++;
+                    sum += sample.second;
+                    minimum = std::min(minimum, sample.second);
+                    maximum = std::max(maximum, sample.second);
+                }
+            }
+            const OgnWeatherStatistics statistics = rolling.statistics(0, OgnWeatherQuantity::Temperature, window, queryTime);
+            ASSERT_EQ(statistics.count, count);
+            ASSERT_TRUE(count == 0 || std::abs(statistics.mean - sum / static_cast<double>(count)) < 1e-9);
+            ASSERT_TRUE(count == 0 || (statistics.minimum == minimum && statistics.maximum == maximum));
+        }
+    }
+
+    // Sample data: one entry per station
+    OgnWeatherCache sampleCache;
+    std::set<std::string> stations;
+    double time = 0.0;
+    for (const auto& line : readReceivedData()) {
+        message.reset();
+        message.sentence = line;
+        OgnParser::parseAprsisMessage(message);
+        if (message.type == OgnMessageType::WEATHER) {
+            stations.insert(std::string(message.sourceId));
+        }
+        sampleCache.update(message, time);
+        time += 0.1;
+    }
+    ASSERT_TRUE(!stations.empty());
+    ASSERT_EQ(sampleCache.size(), stations.size());
+    for (const auto& station : stations) {
+        std::size_t const stationIndex = sampleCache.find(station);
+        ASSERT_TRUE(stationIndex != OgnWeatherCache::npos);
+        ASSERT_TRUE(sampleCache.statistics(stationIndex, OgnWeatherQuantity::WindSpeed, 0, time).count > 0);
+    }
+    return true;
+}
+
+bool testReceiverTable() {
+    OgnReceiverTable table;
+    OgnMessage message;
+
+    // Position and status beacons of a receiver
+    message.sentence = "EDQG>OGNSDR,TCPIP*,qAC,GLIDERN5:/222247h4938.88NI00957.96E&/A=000984";
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_TRUE(table.update(message, 100.0));
+    message.reset();
+    message.sentence = "EDQG>OGNSDR,TCPIP*,qAC,GLIDERN5:>222247h v0.3.2.arm64 CPU:0.9 RAM:278.4/951.4MB NTP:0.6ms/-2.0ppm +54.2C";
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_TRUE(table.update(message, 101.0));
+    ASSERT_EQ(table.size(), 1u);
+    std::size_t index = table.find("EDQG");
+    ASSERT_EQ(index, 0u);
+    ASSERT_EQ(table.receiver(index).version, "0.3.2");
+    ASSERT_EQ(table.receiver(index).platform, "arm64");
+    ASSERT_DOUBLE_EQ(table.receiver(index).cpuLoad, 0.9);
+    ASSERT_DOUBLE_EQ(table.receiver(index).latitude, 49.648);
+    ASSERT_DOUBLE_EQ(table.receiver(index).lastPosition, 100.0);
+    ASSERT_DOUBLE_EQ(table.receiver(index).lastStatus, 101.0);
+    ASSERT_TRUE(std::isnan(table.receiver(index).lastRelay));
+
+    // Traffic report relayed by the receiver, then the same report via another receiver
+    message.reset();
+    message.sentence = "ICA3D17F2>OGFLR,qAS,EDQG:/222248h4948.88N\\00957.96E^000/000/A=003000 !W00! id053D17F2 +000fpm +0.0rot";
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_EQ(message.receiver, "EDQG");
+    ASSERT_EQ(message.destination, "OGFLR");
+    ASSERT_TRUE(table.update(message, 102.0));
+    message.reset();
+    message.sentence = "ICA3D17F2>OGFLR,qAS,EDXY:/222248h4948.88N\\00957.96E^000/000/A=003000 !W00! id053D17F2 +000fpm +0.0rot";
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_TRUE(table.update(message, 102.0, true));
+    ASSERT_EQ(table.size(), 2u);
+    const OgnReceiver& relay = table.receiver(table.find("EDQG"));
+    ASSERT_EQ(relay.relayedReports, 1u);
+    ASSERT_EQ(relay.uniqueReports, 1u);
+    ASSERT_DOUBLE_EQ(relay.lastRelay, 102.0);
+    // Ten minutes of latitude
+    ASSERT_TRUE(std::fabs(relay.maximumRangeKm - 18.53) < 0.01);
+    const OgnReceiver& other = table.receiver(table.find("EDXY"));
+    ASSERT_EQ(other.relayedReports, 1u);
+    ASSERT_EQ(other.uniqueReports, 0u);
+    ASSERT_DOUBLE_EQ(other.maximumRangeKm, 0.0);
+
+    // Other messages are ignored
+    message.reset();
+    message.sentence = "# aprsc 2.1.19-g730c5c0";
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_TRUE(!table.update(message, 103.0));
+
+    // Positions of stations that are no receivers are ignored
+    message.reset();
+    message.sentence = "FNT1142BB>OGNFNT,TCPIP*,qAC,GLIDERN3:/222248h4800.00NI01100.00E&/A=001000";
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_TRUE(message.type == OgnMessageType::TRAFFIC_REPORT);
+    ASSERT_TRUE(message.receiver.empty());
+    ASSERT_TRUE(!table.update(message, 103.0));
+    message.reset();
+    message.sentence = "DVS12345>OGNDVS,TCPIP*,qAC,GLIDERN2:/222248h4800.00N/01100.00E'000/000/A=001000";
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_TRUE(message.receiver.empty());
+    ASSERT_TRUE(!table.update(message, 103.0));
+    ASSERT_EQ(table.size(), 2u);
+    ASSERT_EQ(table.find("FNT1142BB"), OgnReceiverTable::npos);
+    ASSERT_EQ(table.find("DVS12345"), OgnReceiverTable::npos);
+
+    // Expiry
+    message.reset();
+    message.sentence = "EDQG>OGNSDR,TCPIP*,qAC,GLIDERN5:>222757h v0.3.2.arm64 CPU:0.7 RAM:278.4/951.4MB NTP:0.6ms/-2.0ppm +54.0C";
+    OgnParser::parseAprsisMessage(message);
+    ASSERT_TRUE(table.update(message, 150.0));
+    table.expire(200.0, 60.0);
+    ASSERT_EQ(table.size(), 1u);
+    ASSERT_EQ(table.find("EDXY"), OgnReceiverTable::npos);
+    ASSERT_EQ(table.find("EDQG"), 0u);
+    table.clear();
+    ASSERT_TRUE(table.empty());
+
+    // All receivers in the recorded data
+    for (const auto& line : readReceivedData()) {
+        message.reset();
+        message.sentence = line;
+        OgnParser::parseAprsisMessage(message);
+        table.update(message, 0.0);
+    }
+    index = table.find("reg4");
+    ASSERT_TRUE(index != OgnReceiverTable::npos);
+    ASSERT_EQ(table.receiver(index).platform, "RPI-GPU");
+    ASSERT_DOUBLE_EQ(table.receiver(index).ramTotal, 968.1);
+    return true;
+}
+
+bool testSpscQueue() {
+    // Capacity is rounded up to a power of two
+    SpscQueue<int> queue(5);
+    ASSERT_EQ(queue.capacity(), 8u);
+
+    // Empty queue
+    int value = -1;
+    ASSERT_TRUE(!queue.tryPop(value));
+    ASSERT_EQ(value, -1);
+
+    // Fill, overflow, then drain in order
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(queue.tryPush(i));
+    }
+    ASSERT_TRUE(!queue.tryPush(8));
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(queue.tryPop(value));
+        ASSERT_EQ(value, i);
+    }
+    ASSERT_TRUE(!queue.tryPop(value));
+    ASSERT_EQ(queue.statistics().pushes, 8u);
+    ASSERT_EQ(queue.statistics().maxDepth, 8u);
+    ASSERT_DOUBLE_EQ(queue.statistics().meanDepth(), 4.5);
+
+    // Indices wrap around the ring buffer
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_TRUE(queue.tryPush(i));
+        ASSERT_TRUE(queue.tryPush(i + 100));
+        ASSERT_TRUE(queue.tryPop(value));
+        ASSERT_EQ(value, i);
+        ASSERT_TRUE(queue.tryPop(value));
+        ASSERT_EQ(value, i + 100);
+    }
+    ASSERT_TRUE(!queue.tryPop(value));
+
+    // One producer and one consumer thread, order is preserved
+    constexpr int count = 100000;
+    SpscQueue<int> shared(16);
+    std::thread producer([&shared]() {
+        Backoff backoff;
+        for (int i = 0; i < count; ++i) {
+            while (!shared.tryPush(i)) {
+                backoff.pause();
+            }
+            backoff.reset();
+        }
+    });
+    int expected = 0;
+    bool ordered = true;
+    Backoff backoff;
+    while (expected < count) {
+        if (!shared.tryPop(value)) {
+            backoff.pause();
+            continue;
+        }
+        backoff.reset();
+        ordered = ordered && (value == expected);
+        ++expected;
+    }
+    producer.join();
+    ASSERT_TRUE(ordered);
+    ASSERT_TRUE(!shared.tryPop(value));
+    ASSERT_EQ(shared.statistics().pushes, static_cast<std::size_t>(count));
+    ASSERT_LE(shared.statistics().maxDepth, shared.capacity());
+    return true;
+}
+
+bool testFormatMessages() {
+    const std::string_view chunk =
+        "FLRDDE626>APRS,qAS,EGHL:/074548h5111.32N/00102.04W'086/007/A=000607 id0ADDE626 -019fpm +0.0rot 5.5dB 3e -4.3kHz\r\n"
+        "# aprsc 2.0.14-g28c5a6a 29 Jun 2014 07:46:15 GMT GLIDERN1 37.187.40.234:14580\n"
+        "ICA3D17F2>OGFLR,qAS,EDQG:/222248h4948.88N\\00957.96E^000/000/A=003000 !W00! id053D17F2 +000fpm +0.0rot\n";
+    std::vector<OgnMessageView> messages;
+    ASSERT_EQ(OgnParser::parseAprsisBatch(chunk, messages), 3u);
+
+    // Formatter names
+    OutputFormatter ogn;
+    OutputFormatter sbs1;
+    ASSERT_TRUE(outputFormatterFromName("ogn", ogn));
+    ASSERT_TRUE(outputFormatterFromName("sbs1", sbs1));
+    ASSERT_TRUE(std::holds_alternative<SBS1Formatter>(sbs1));
+    ASSERT_TRUE(!outputFormatterFromName("gdl90", sbs1));
+    ASSERT_TRUE(std::holds_alternative<SBS1Formatter>(sbs1));
+
+    // Raw sentences, appended to the content of the buffer. One offset per
+    // message and the end of the last one.
+    std::string out = "previous\n";
+    std::vector<std::size_t> offsets;
+    formatMessages(ogn, out, messages.data(), messages.size(), &offsets);
+    ASSERT_EQ(offsets.size(), messages.size() + 1);
+    ASSERT_EQ(offsets.front(), 9u);
+    ASSERT_EQ(offsets.back(), out.size());
+    for (std::size_t i = 0; i < messages.size(); ++i) {
+        ASSERT_EQ(out.substr(offsets[i], offsets[i + 1] - offsets[i]), std::string(messages[i].sentence) + "\n");
+    }
+
+    // Offsets are optional and do not change the output
+    std::string plain = "previous\n";
+    formatMessages(ogn, plain, messages.data(), messages.size());
+    ASSERT_EQ(plain, out);
+
+    // Skipped messages, here the comment in SBS-1, have an empty range
+    std::string sbs1Out;
+    std::vector<std::size_t> sbs1Offsets;
+    formatMessages(sbs1, sbs1Out, messages.data(), messages.size(), &sbs1Offsets);
+    ASSERT_EQ(sbs1Offsets.size(), messages.size() + 1);
+    ASSERT_EQ(sbs1Offsets[0], 0u);
+    ASSERT_EQ(sbs1Offsets[1], sbs1Offsets[2]);
+    ASSERT_EQ(sbs1Offsets[3], sbs1Out.size());
+    ASSERT_EQ(sbs1Out.compare(sbs1Offsets[0], 4, "MSG,"), 0);
+    ASSERT_EQ(sbs1Out[sbs1Offsets[1] - 1], '\n');
+    ASSERT_EQ(sbs1Out.compare(sbs1Offsets[2], 4, "MSG,"), 0);
+    ASSERT_EQ(sbs1Out.back(), '\n');
+
+    // Empty range
+    offsets.clear();
+    std::string empty;
+    formatMessages(ogn, empty, messages.data(), 0, &offsets);
+    ASSERT_TRUE(empty.empty());
+    ASSERT_EQ(offsets.size(), 1u);
+    ASSERT_EQ(offsets[0], 0u);
+    return true;
+}
+
+bool testDecodeCoordinates_exhaustive() {
+    // Compare the fixed-point decoder with the floating-point reference for
+    // all valid latitudes "DDMM.MM" and longitudes "DDDMM.MM", with and
+    // without precision enhancement. Results agree up to rounding.
+    const char enhancements[] = {'\0', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    const double tolerance = 1e-12;
+    double maxDifference = 0.0;
+
+    char latitude[8] = "0000.00";
+    for (int degrees = 0; degrees <= 90; ++degrees) {
+        for (int hundredths = 0; hundredths < 6000; ++hundredths) {
+            std::snprintf(latitude, sizeof(latitude), "%02d%02d.%02d", degrees, hundredths / 100, hundredths % 100);
+            for (const char enhancement : enhancements) {
+                const double expected = referenceDecodeCoordinate(latitude, 2, enhancement);
+                const double north = OgnParser::decodeLatitude(latitude, 'N', enhancement);
+                const double south = OgnParser::decodeLatitude(latitude, 'S', enhancement);
+                maxDifference = std::max(maxDifference, std::abs(north - expected));
+                ASSERT_LE(std::abs(north - expected), tolerance);
+                ASSERT_TRUE(south == -north);
+            }
+        }
+    }
+
+    char longitude[9] = "00000.00";
+    for (int degrees = 0; degrees <= 180; ++degrees) {
+        for (int hundredths = 0; hundredths < 6000; ++hundredths) {
+            std::snprintf(longitude, sizeof(longitude), "%03d%02d.%02d", degrees, hundredths / 100, hundredths % 100);
+            for (const char enhancement : enhancements) {
+                const double expected = referenceDecodeCoordinate(longitude, 3, enhancement);
+                const double east = OgnParser::decodeLongitude(longitude, 'E', enhancement);
+                const double west = OgnParser::decodeLongitude(longitude, 'W', enhancement);
+                maxDifference = std::max(maxDifference, std::abs(east - expected));
+                ASSERT_LE(std::abs(east - expected), tolerance);
+                ASSERT_TRUE(west == -east);
+            }
+        }
+    }
+
+    ASSERT_LE(maxDifference, tolerance);
+    return true;
+}
+
+bool testDecodeCoordinates_invalid() {
+    ASSERT_TRUE(std::isnan(OgnParser::decodeLatitude("5111.3", 'N', '\0')));
+    ASSERT_TRUE(std::isnan(OgnParser::decodeLatitude("511132N", 'N', '\0')));
+    ASSERT_TRUE(std::isnan(OgnParser::decodeLatitude("51x1.32", 'N', '\0')));
+    ASSERT_TRUE(std::isnan(OgnParser::decodeLatitude("5111.3 ", 'N', '\0')));
+    ASSERT_TRUE(std::isnan(OgnParser::decodeLongitude("0010204", 'E', '\0')));
+    ASSERT_TRUE(std::isnan(OgnParser::decodeLongitude("001.2.04", 'E', '\0')));
+    ASSERT_TRUE(std::isnan(OgnParser::decodeLongitude("-0102.04", 'E', '\0')));
+
+    // Invalid enhancement digits are ignored
+    ASSERT_DOUBLE_EQ(OgnParser::decodeLatitude("5111.32", 'N', 'x'), OgnParser::decodeLatitude("5111.32", 'N', '\0'));
+    ASSERT_DOUBLE_EQ(OgnParser::decodeLongitude("00102.04", 'W', '/'), -1.034);
+    return true;
+}
+
+bool testParseAprsisMessage_multiThreaded() {
+    const std::vector<std::string> lines = readReceivedData();
+    ASSERT_GE(lines.size(), 700u);
+
+    // Single-threaded reference run
+    std::vector<OgnMessageView> reference(lines.size());
+    for (std::size_t i = 0; i < lines.size(); ++i) {
+        reference[i].sentence = lines[i];
+        OgnParser::parseAprsisMessage(reference[i]);
+    }
+
+    // Parse the same data concurrently, every thread compares with the reference
+    const unsigned int threadCount = 8;
+    const int iterations = 20;
+    std::vector<int> mismatches(threadCount, 0);
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t]() {
+            OgnMessage message;
+            for (int iteration = 0; iteration < iterations; ++iteration) {
+                for (std::size_t i = 0; i < lines.size(); ++i) {
+                    message.reset();
+                    message.sentence = lines[i];
+                    OgnParser::parseAprsisMessage(message);
+                    if (!sameMessageData(message, reference[i])) {
+                        mismatches[t]++;
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (unsigned int t = 0; t < threadCount; ++t) {
+        ASSERT_EQ(mismatches[t], 0);
+    }
+    return true;
+}
+
+bool testFormatPositionReport_multiThreaded() {
+    // Threads format reports for different aircraft types at the same time.
+    // Each report must carry the symbol of its own aircraft type.
+    const OgnAircraftType aircraftTypes[] = {
+        OgnAircraftType::Glider, OgnAircraftType::Copter, OgnAircraftType::Jet, OgnAircraftType::Balloon
+    };
+    const char symbolCodes[] = {'\'', 'X', '^', 'O'};
+    std::vector<int> mismatches(std::size(aircraftTypes), 0);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < std::size(aircraftTypes); ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 2000; ++i) {
+                const std::string report = OgnParser::formatPositionReport(
+                    "ENR12345", 51.1886666667, -1.034, 185.0136, 86.0, 7.0, aircraftTypes[t]);
+                if (report.size() != 66 || report[48] != symbolCodes[t]) {
+                    mismatches[t]++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const int mismatch : mismatches) {
+        ASSERT_EQ(mismatch, 0);
+    }
+    return true;
+}
+
 bool testPerformanceOfParseAprsisMessage() {
     // Simple performance test - parse same message 10000 times
     std::string sentence = "FLRDDE626>APRS,qAS,EGHL:/074548h5111.32N/00102.04W'086/007/A=000607 id0ADDE626 -019fpm +0.0rot 5.5dB 3e -4.3kHz";
@@ -365,8 +2280,9 @@ int main() {
                 continue;
             }
             
-            // Skip performance test for non-C locales to keep test time reasonable
-            if (std::string(test.name) == "testPerformanceOfParseAprsisMessage" && 
+            // Skip performance and exhaustive tests for non-C locales to keep test time reasonable
+            const std::string testName(test.name);
+            if ((testName == "testPerformanceOfParseAprsisMessage" || testName == "testDecodeCoordinates_exhaustive") &&
                 std::string(localeName) != "C") {
                 continue;
             }